@@ -0,0 +1,140 @@
+#include "../src/mqtt.h"
+
+// 발행 페이로드 압축 마이크로벤치마크
+// 결과 하나와 배치(JSON 배열로 묶은 텔레메트리 결과)를 deflate 수준별로 압축해
+// 크기, 압축률, 압축/해제 시간을 재고, 풀어낸 내용이 원본과 같은지 확인
+// 문턱값(COMPRESS_DEFAULT_MIN_BYTES) 미만 결과는 압축하지 않고 그대로 보내는지도 확인
+
+#define BENCH_BYTES_PER_CASE (64L * 1024 * 1024)   // 경우마다 이만큼의 원본을 처리
+
+static volatile size_t g_sink;
+static const int bench_levels[] = { 1, 6 };
+static const int bench_batches[] = { 1, 8, 64, 512 };
+
+// 텔레메트리 결과 하나 (photoresistor 스트리밍과 같은 모양, 값만 조금씩 다름)
+static int bench_result(char *buf, size_t size, int seq) {
+    ResultBuilder rb;
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+    result_init(&rb);
+    result_begin(&rb, "photoresistor", "telemetry");
+    result_add_int(&rb, "value", 480 + (seq * 37) % 97);
+    result_add_int(&rb, "samples", 60 + seq % 5);
+    result_add_double(&rb, "mean", 512.25 + (seq % 13));
+    result_add_int(&rb, "min", 431 + seq % 7);
+    result_add_int(&rb, "max", 598 - seq % 11);
+    result_add_str(&rb, "reason", (seq & 3) ? "deadband" : "heartbeat");
+    result_add_str(&rb, "status", "success");
+    result_finish(&rb);
+    int len = (int)rb.len < (int)size - 1 ? (int)rb.len : (int)size - 1;
+    memcpy(buf, rb.buf, (size_t)len);
+    buf[len] = '\0';
+    return len;
+}
+
+// 배치 단계처럼 결과 count개를 JSON 배열로 묶음 (반환: 길이)
+static int bench_batch(char *buf, size_t size, int count) {
+    char one[RESULT_BUFFER_SIZE];
+    int len = 0;
+    buf[len++] = '[';
+    for (int i = 0; i < count; i++) {
+        int n = bench_result(one, sizeof(one), i);
+        if ((size_t)(len + n + 2) >= size) {
+            break;
+        }
+        if (i > 0) {
+            buf[len++] = ',';
+        }
+        memcpy(buf + len, one, (size_t)n);
+        len += n;
+    }
+    buf[len++] = ']';
+    buf[len] = '\0';
+    return len;
+}
+
+static void bench_configure(int level, int min_bytes) {
+    static MQTTConfig config;
+    memset(&config, 0, sizeof(config));
+    config.compress_level = level;
+    config.compress_min_bytes = min_bytes;
+    compress_configure(&config);
+}
+
+int main(void) {
+    size_t size = (size_t)RESULT_BUFFER_SIZE * 512 + 2;
+    char *payload = malloc(size);
+    if (!payload) {
+        return 1;
+    }
+
+    // 문턱값 미만은 압축하지 않음
+    bench_configure(COMPRESS_DEFAULT_LEVEL, COMPRESS_DEFAULT_MIN_BYTES);
+    char *compressed = NULL;
+    int small = bench_result(payload, size, 0);
+    if (small >= COMPRESS_DEFAULT_MIN_BYTES || compress_payload(payload, small, &compressed) != 0 || compressed) {
+        printf("compress_bench: %d byte result was compressed below the threshold\n", small);
+        return 1;
+    }
+
+    printf("payload          level    bytes    gzip   ratio   compress ns   MB/s   inflate ns   check\n");
+    int failures = 0;
+    for (size_t b = 0; b < sizeof(bench_batches) / sizeof(bench_batches[0]); b++) {
+        int count = bench_batches[b];
+        int len = bench_batch(payload, size, count);
+        int iterations = (int)(BENCH_BYTES_PER_CASE / len);
+        iterations = iterations > 200000 ? 200000 : iterations;
+
+        for (size_t l = 0; l < sizeof(bench_levels) / sizeof(bench_levels[0]); l++) {
+            bench_configure(bench_levels[l], 0);
+            int gz_len = compress_payload(payload, len, &compressed);
+            char *inflated = NULL;
+            int inflated_len = gz_len > 0 ? compress_inflate(compressed, gz_len, &inflated) : -1;
+            int ok = gz_len > 0 && compress_is_marked(compressed, gz_len) && inflated_len == len &&
+                     memcmp(inflated, payload, (size_t)len) == 0;
+            free(inflated);
+            failures += !ok;
+
+            uint64_t start = monotonic_time_ns();
+            for (int i = 0; i < iterations; i++) {
+                char *out = NULL;
+                g_sink += (size_t)compress_payload(payload, len, &out);
+                free(out);
+            }
+            double compress_ns = (double)(monotonic_time_ns() - start) / iterations;
+
+            start = monotonic_time_ns();
+            for (int i = 0; ok && i < iterations; i++) {
+                char *out = NULL;
+                g_sink += (size_t)compress_inflate(compressed, gz_len, &out);
+                free(out);
+            }
+            double inflate_ns = (double)(monotonic_time_ns() - start) / iterations;
+            free(compressed);
+
+            char name[32];
+            snprintf(name, sizeof(name), count == 1 ? "1 result" : "batch of %d", count);
+            printf("%-15s  %5d  %7d  %6d  %5.1fx  %12.0f  %5.0f  %11.0f   %s\n", name, bench_levels[l], len, gz_len,
+                   gz_len > 0 ? (double)len / gz_len : 0.0, compress_ns, len / compress_ns * 1000.0, inflate_ns,
+                   ok ? "ok" : "MISMATCH");
+        }
+    }
+
+    // 잘리거나 깨진 gzip은 거부
+    bench_configure(COMPRESS_DEFAULT_LEVEL, 0);
+    int len = bench_batch(payload, size, 8);
+    int gz_len = compress_payload(payload, len, &compressed);
+    char *inflated = NULL;
+    if (gz_len <= 0 || compress_inflate(compressed, gz_len - 1, &inflated) >= 0 || inflated) {
+        printf("compress_bench: truncated gzip payload was accepted\n");
+        failures++;
+    }
+    compressed[gz_len / 2] ^= 0x55;
+    if (compress_inflate(compressed, gz_len, &inflated) >= 0) {
+        printf("compress_bench: corrupted gzip payload was accepted\n");
+        free(inflated);
+        failures++;
+    }
+    free(compressed);
+    free(payload);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "../src/mqtt.h"
+
+// 디바이스 테이블 마이크로벤치마크
+// 가상 디바이스 수를 늘려 가며 디바이스당 메모리, 토픽의 device_id 조회,
+// 디바이스별 상태 토픽 생성 비용을 측정 (게이트웨이 여러 개를 하나로 합칠 때의 비용)
+
+#define BENCH_TOPICS 1024
+#define BENCH_ITERATIONS 4000000
+
+static const int bench_sizes[] = { 100, 1000, 10000, 100000 };
+static char bench_topics[BENCH_TOPICS][MAX_TOPIC_LEN];
+static ParsedTopic bench_parsed[BENCH_TOPICS];
+static volatile uint64_t g_sink;
+
+static uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+// 등록된 디바이스 위주로, 8개 중 하나는 모르는 ID
+static void make_topics(int devices) {
+    uint32_t seed = 12345;
+    int width = devices > 10000 ? 5 : 4;
+    for (int i = 0; i < BENCH_TOPICS; i++) {
+        int device = (int)(bench_rand(&seed) % (uint32_t)devices);
+        if (i % 8 == 7) {
+            snprintf(bench_topics[i], MAX_TOPIC_LEN, "control/other_%0*d/led/on", width, device);
+        } else {
+            snprintf(bench_topics[i], MAX_TOPIC_LEN, "control/sim_%0*d/led/on", width, device);
+        }
+        parse_topic_view(bench_topics[i], &bench_parsed[i]);
+    }
+}
+
+static double bench_find(void) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const ParsedTopic *parsed = &bench_parsed[i % BENCH_TOPICS];
+        VirtualDevice *device = device_table_find(parsed->topic + parsed->device_id.offset, parsed->device_id.len);
+        g_sink += device ? device->id_len : 1;
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+static double bench_status_topic(void) {
+    char topic[MAX_TOPIC_LEN];
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const ParsedTopic *parsed = &bench_parsed[i % BENCH_TOPICS];
+        g_sink += (uint64_t)status_topic_format(parsed->topic + parsed->device_id.offset,
+                                                parsed->device_id.len, "led", topic, sizeof(topic));
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+int main(void) {
+    MQTTConfig config;
+    memset(&config, 0, sizeof(config));
+    strcpy(config.device_id, DEFAULT_DEVICE_ID);
+    log_set_level(LOG_LEVEL_WARN);
+    status_topics_init(&config);
+
+    printf("devices     bytes/device   find ns/op   status_topic ns/op\n");
+    for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+        int devices = bench_sizes[s];
+        char spec[32];
+        snprintf(spec, sizeof(spec), "sim_:%d", devices);
+        if (device_table_add_range(spec) != devices || device_table_add(DEFAULT_DEVICE_ID, 1) < 0) {
+            printf("device_bench: failed to register %d devices\n", devices);
+            return 1;
+        }
+        make_topics(devices);
+
+        // 결과 확인 (등록한 ID는 찾고, 모르는 ID는 못 찾아야 함)
+        for (int i = 0; i < BENCH_TOPICS; i++) {
+            const ParsedTopic *parsed = &bench_parsed[i];
+            VirtualDevice *device = device_table_find(bench_topics[i] + parsed->device_id.offset,
+                                                      parsed->device_id.len);
+            int known = (i % 8 != 7);
+            if ((device != NULL) != known ||
+                (device && memcmp(device->id, bench_topics[i] + parsed->device_id.offset, device->id_len) != 0)) {
+                printf("device_bench: lookup mismatch on '%s'\n", bench_topics[i]);
+                return 1;
+            }
+        }
+
+        double find_ns = bench_find();
+        double topic_ns = bench_status_topic();
+        size_t bytes = device_table_memory();
+        printf("%7d   %12.1f   %10.1f   %18.1f\n", device_table_count(),
+               (double)bytes / device_table_count(), find_ns, topic_ns);
+        device_table_cleanup();
+    }
+    printf("sizeof(VirtualDevice): %zu bytes\n", sizeof(VirtualDevice));
+    return 0;
+}
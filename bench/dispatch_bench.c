@@ -0,0 +1,101 @@
+#include "../src/mqtt.h"
+
+// 명령 분배 마이크로벤치마크
+// 디바이스 종류 128개 x 명령 4개를 등록하고, 완전 해시 조회와
+// 기존 방식(디바이스 strcmp 체인 + 명령 strcmp 체인)을 같은 토픽 집합으로 비교
+
+#define BENCH_DEVICES 128
+#define BENCH_COMMANDS 4
+#define BENCH_ITERATIONS 2000000
+
+static const char *bench_command_names[BENCH_COMMANDS] = { "on", "off", "read", "calibrate" };
+static char bench_device_names[BENCH_DEVICES][32];
+static char bench_topics[BENCH_DEVICES * BENCH_COMMANDS][MAX_TOPIC_LEN];
+static volatile int g_sink;
+
+static void bench_handler(const char *command) {
+    g_sink += command[0];
+}
+
+// 비교용: 디바이스 체인 후 명령 체인 (기존 main.c/핸들러 구조)
+static device_handler_t chain_lookup(const char *device, const char *command) {
+    for (int d = 0; d < BENCH_DEVICES; d++) {
+        if (strcmp(device, bench_device_names[d]) == 0) {
+            for (int c = 0; c < BENCH_COMMANDS; c++) {
+                if (strcmp(command, bench_command_names[c]) == 0) {
+                    return bench_handler;
+                }
+            }
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static double bench_chain(int topic_count) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const char *topic = bench_topics[i % topic_count];
+        ParsedTopic parsed;
+        char device[64];
+        char command[64];
+        parse_topic_view(topic, &parsed);
+        topic_level_copy(topic, parsed.target_device, device, sizeof(device));
+        topic_level_copy(topic, parsed.command, command, sizeof(command));
+        g_sink += chain_lookup(device, command) != NULL;
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+static double bench_registry(int topic_count) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const char *topic = bench_topics[i % topic_count];
+        ParsedTopic parsed;
+        parse_topic_view(topic, &parsed);
+        g_sink += dispatch_lookup(&parsed) != NULL;
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+int main(void) {
+    int topic_count = 0;
+    for (int d = 0; d < BENCH_DEVICES; d++) {
+        snprintf(bench_device_names[d], sizeof(bench_device_names[d]), "bench_device_%03d", d);
+        for (int c = 0; c < BENCH_COMMANDS; c++) {
+            dispatch_register(bench_device_names[d], bench_command_names[c], bench_handler, 0);
+            snprintf(bench_topics[topic_count++], sizeof(bench_topics[0]), "control/raspberry_001/%.31s/%s",
+                     bench_device_names[d], bench_command_names[c]);
+        }
+    }
+
+    uint64_t build_start = monotonic_time_ns();
+    if (dispatch_build() < 0) {
+        return 1;
+    }
+    double build_us = (double)(monotonic_time_ns() - build_start) / 1000.0;
+
+    // 결과 확인 (모든 등록 키가 자기 핸들러로, 미등록 명령은 NULL)
+    for (int i = 0; i < topic_count; i++) {
+        ParsedTopic parsed;
+        parse_topic_view(bench_topics[i], &parsed);
+        const DispatchEntry *entry = dispatch_lookup(&parsed);
+        if (!entry || entry->handler != bench_handler) {
+            printf("dispatch_bench: lookup failed for '%s'\n", bench_topics[i]);
+            return 1;
+        }
+    }
+    if (dispatch_lookup_name("bench_device_000", 16, "missing", 7) != NULL) {
+        printf("dispatch_bench: unexpected hit for unregistered command\n");
+        return 1;
+    }
+
+    double chain_ns = bench_chain(topic_count);
+    double registry_ns = bench_registry(topic_count);
+
+    printf("entries=%d devices=%d build_us=%.1f\n", dispatch_entry_count(), BENCH_DEVICES, build_us);
+    printf("benchmark                    ns/op   speedup\n");
+    printf("dispatch/strcmp_chain    %10.1f   %6.2fx\n", chain_ns, 1.0);
+    printf("dispatch/perfect_hash    %10.1f   %6.2fx\n", registry_ns, chain_ns / registry_ns);
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include "../src/mqtt.h"
+
+// 결과 페이로드 인코딩 벤치마크
+// 짧은 명령 결과와 필드가 많은 stats 결과를 snprintf JSON, ResultBuilder JSON, ResultBuilder CBOR로
+// 만들어 크기와 생성 시간을 비교하고, CBOR 명령 페이로드를 JSON으로 바꾸는 비용을 잼
+// CBOR 결과를 다시 JSON으로 바꿔 모든 필드 값이 JSON 결과와 같은지도 확인
+
+#define BENCH_ITERATIONS 2000000
+
+static volatile size_t g_sink;
+
+typedef size_t (*encode_fn)(char *buf, size_t size, int seq);
+
+// 기존 방식: snprintf 한 번으로 JSON 생성
+static size_t encode_led_snprintf(char *buf, size_t size, int seq) {
+    int len = snprintf(buf, size, "{\"device\":\"%s\",\"command\":\"%s\",\"status\":\"%s\",\"timestamp\":%ld}",
+                       "led", (seq & 1) ? "on" : "off", "success", (long)time(NULL));
+    return len > 0 ? (size_t)len : 0;
+}
+
+static void build_led(ResultBuilder *rb, int seq) {
+    result_begin(rb, "led", (seq & 1) ? "on" : "off");
+    result_add_str(rb, "status", "success");
+}
+
+static size_t encode_stats_snprintf(char *buf, size_t size, int seq) {
+    int len = snprintf(buf, size,
+                       "{\"device\":\"%s\",\"command\":\"%s\",\"window_ms\":%d,\"count\":%d,\"span_ms\":%d,"
+                       "\"mean\":%.2f,\"min\":%d,\"max\":%d,\"stddev\":%.2f,\"ewma\":%.2f,\"p50\":%.2f,"
+                       "\"p90\":%.2f,\"p99\":%.2f,\"last\":%d,\"status\":\"%s\",\"timestamp\":%ld}",
+                       "photoresistor", "stats?window=60s", 60000, 600 + (seq & 63), 59900, 512.25 + (seq & 7),
+                       431, 598, 23.5, 515.75, 511.5, 541.25, 590.5, 520 + (seq & 15), "success", (long)time(NULL));
+    return len > 0 ? (size_t)len : 0;
+}
+
+static void build_stats(ResultBuilder *rb, int seq) {
+    result_begin(rb, "photoresistor", "stats?window=60s");
+    result_add_int(rb, "window_ms", 60000);
+    result_add_int(rb, "count", 600 + (seq & 63));
+    result_add_int(rb, "span_ms", 59900);
+    result_add_double(rb, "mean", 512.25 + (seq & 7));
+    result_add_int(rb, "min", 431);
+    result_add_int(rb, "max", 598);
+    result_add_double(rb, "stddev", 23.5);
+    result_add_double(rb, "ewma", 515.75);
+    result_add_double(rb, "p50", 511.5);
+    result_add_double(rb, "p90", 541.25);
+    result_add_double(rb, "p99", 590.5);
+    result_add_int(rb, "last", 520 + (seq & 15));
+    result_add_str(rb, "status", "success");
+}
+
+static size_t encode_led_json(char *buf, size_t size, int seq) {
+    ResultBuilder rb;
+    (void)buf;
+    (void)size;
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+    result_init(&rb);
+    build_led(&rb, seq);
+    result_finish(&rb);
+    return rb.len;
+}
+
+static size_t encode_led_cbor(char *buf, size_t size, int seq) {
+    ResultBuilder rb;
+    (void)buf;
+    (void)size;
+    result_set_encoding(PAYLOAD_ENCODING_CBOR);
+    result_init(&rb);
+    build_led(&rb, seq);
+    result_finish(&rb);
+    return rb.len;
+}
+
+static size_t encode_stats_json(char *buf, size_t size, int seq) {
+    ResultBuilder rb;
+    (void)buf;
+    (void)size;
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+    result_init(&rb);
+    build_stats(&rb, seq);
+    result_finish(&rb);
+    return rb.len;
+}
+
+static size_t encode_stats_cbor(char *buf, size_t size, int seq) {
+    ResultBuilder rb;
+    (void)buf;
+    (void)size;
+    result_set_encoding(PAYLOAD_ENCODING_CBOR);
+    result_init(&rb);
+    build_stats(&rb, seq);
+    result_finish(&rb);
+    return rb.len;
+}
+
+// 평균 생성 시간 (ns), bytes에 한 번 만든 크기
+static double bench_encode(encode_fn fn, size_t *bytes) {
+    char buf[RESULT_BUFFER_SIZE];
+    *bytes = fn(buf, sizeof(buf), 0);
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        g_sink += fn(buf, sizeof(buf), i);
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+// 결과 하나를 만들어 buf에 복사 (반환: 길이)
+static size_t build_result(int encoding, void (*build)(ResultBuilder *, int), char *buf) {
+    ResultBuilder rb;
+    result_set_encoding(encoding);
+    result_init(&rb);
+    build(&rb, 5);
+    result_finish(&rb);
+    memcpy(buf, rb.buf, rb.len + 1);
+    return rb.len;
+}
+
+// CBOR 결과를 JSON으로 바꿔 JSON 결과와 필드별로 비교 (timestamp는 초가 바뀔 수 있어 제외)
+static int verify_result(void (*build)(ResultBuilder *, int)) {
+    static const char *keys[] = { "device", "command", "window_ms", "count", "span_ms", "mean", "min", "max",
+                                  "stddev", "ewma", "p50", "p90", "p99", "last", "status" };
+    enum { KEY_COUNT = sizeof(keys) / sizeof(keys[0]) };
+    char json[RESULT_BUFFER_SIZE];
+    char cbor[RESULT_BUFFER_SIZE];
+    char decoded[RESULT_BUFFER_SIZE * 4];
+    size_t json_len = build_result(PAYLOAD_ENCODING_JSON, build, json);
+    size_t cbor_len = build_result(PAYLOAD_ENCODING_CBOR, build, cbor);
+    int decoded_len = cbor_to_json(cbor, (int)cbor_len, decoded, sizeof(decoded));
+    if (!cbor_is_marked(cbor, (int)cbor_len) || decoded_len < 0) {
+        return 0;
+    }
+
+    JsonField expected[KEY_COUNT];
+    JsonField actual[KEY_COUNT];
+    for (int i = 0; i < KEY_COUNT; i++) {
+        expected[i] = (JsonField){ .key = keys[i] };
+        actual[i] = (JsonField){ .key = keys[i] };
+    }
+    if (json_extract_fields(json, (int)json_len, expected, KEY_COUNT) !=
+        json_extract_fields(decoded, decoded_len, actual, KEY_COUNT)) {
+        return 0;
+    }
+    for (int i = 0; i < KEY_COUNT; i++) {
+        double a;
+        double b;
+        if (expected[i].type != actual[i].type) {
+            return 0;
+        }
+        if (expected[i].type == JSON_FIELD_STRING &&
+            (expected[i].value_len != actual[i].value_len ||
+             memcmp(expected[i].value, actual[i].value, (size_t)expected[i].value_len) != 0)) {
+            return 0;
+        }
+        if (expected[i].type == JSON_FIELD_NUMBER &&
+            (json_field_number(&expected[i], &a) != 0 || json_field_number(&actual[i], &b) != 0 || fabs(a - b) > 1e-9)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 명령 페이로드 해석: JSON 그대로 vs CBOR → JSON 변환 후 해석
+static void bench_decode(void) {
+    static const char json[] = "{\"sample_ms\":500,\"deadband\":8,\"heartbeat_ms\":30000,\"min_publish_ms\":100}";
+    // 위와 같은 내용의 CBOR (자기 기술 태그 + 맵 4개 항목)
+    static const uint8_t cbor[] = {
+        0xd9, 0xd9, 0xf7, 0xa4,
+        0x69, 's', 'a', 'm', 'p', 'l', 'e', '_', 'm', 's', 0x19, 0x01, 0xf4,
+        0x68, 'd', 'e', 'a', 'd', 'b', 'a', 'n', 'd', 0x08,
+        0x6c, 'h', 'e', 'a', 'r', 't', 'b', 'e', 'a', 't', '_', 'm', 's', 0x19, 0x75, 0x30,
+        0x6e, 'm', 'i', 'n', '_', 'p', 'u', 'b', 'l', 'i', 's', 'h', '_', 'm', 's', 0x18, 0x64,
+    };
+    char decoded[MAX_STRING_LEN];
+    if (cbor_to_json(cbor, (int)sizeof(cbor), decoded, sizeof(decoded)) < 0 || strcmp(decoded, json) != 0) {
+        printf("encoding_bench: CBOR command decoded to '%s'\n", decoded);
+        exit(1);
+    }
+
+    JsonField fields[4] = { { .key = "sample_ms" }, { .key = "deadband" }, { .key = "heartbeat_ms" },
+                            { .key = "min_publish_ms" } };
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        g_sink += (size_t)json_extract_fields(json, (int)sizeof(json) - 1, fields, 4);
+    }
+    double json_ns = (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+
+    start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int len = cbor_to_json(cbor, (int)sizeof(cbor), decoded, sizeof(decoded));
+        g_sink += (size_t)json_extract_fields(decoded, len, fields, 4);
+    }
+    double cbor_ns = (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+
+    printf("\ncommand payload      bytes   parse ns/op\n");
+    printf("json                 %5zu   %11.1f\n", sizeof(json) - 1, json_ns);
+    printf("cbor (to json)       %5zu   %11.1f\n", sizeof(cbor), cbor_ns);
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        encode_fn fn;
+    } cases[] = {
+        { "led     snprintf json", encode_led_snprintf },
+        { "led     builder json ", encode_led_json },
+        { "led     builder cbor ", encode_led_cbor },
+        { "stats   snprintf json", encode_stats_snprintf },
+        { "stats   builder json ", encode_stats_json },
+        { "stats   builder cbor ", encode_stats_cbor },
+    };
+
+    if (!verify_result(build_led) || !verify_result(build_stats)) {
+        printf("encoding_bench: CBOR result does not match JSON result\n");
+        return 1;
+    }
+
+    printf("result                 bytes   vs json   encode ns/op\n");
+    size_t json_bytes = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t bytes;
+        double ns = bench_encode(cases[i].fn, &bytes);
+        if (i % 3 == 0) {
+            json_bytes = bytes;
+        }
+        printf("%s  %5zu   %6.0f%%   %12.1f\n", cases[i].name, bytes, 100.0 * bytes / json_bytes, ns);
+    }
+    bench_decode();
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "../src/mqtt.h"
+
+// 샤드 워커 풀 확장성 벤치마크
+// 가상 디바이스 1000개에 명령을 고르게 넣고 워커 수를 1부터 늘려 가며 처리량을 잼
+//   cpu: 핸들러가 약 5us 계산만 함 (코어 수만큼 늘어나야 함)
+//   io:  핸들러가 200us 잠듦 (GPIO/ADC 대기 흉내, 코어 수와 관계없이 워커 수만큼 늘어남)
+// 같은 디바이스 명령이 보낸 순서대로 실행됐는지도 확인
+
+#define BENCH_DEVICES 1000
+#define BENCH_CPU_COMMANDS 200000
+#define BENCH_IO_COMMANDS 20000
+
+static VirtualDevice *bench_devices[BENCH_DEVICES];
+static VirtualDevice *bench_base;
+static long bench_last_seq[BENCH_DEVICES];
+static volatile long g_done;
+static volatile long g_order_errors;
+static volatile uint64_t g_sink;
+
+// 디바이스별로 받은 순번이 늘어나는지 확인 (같은 디바이스는 같은 워커이므로 잠금 불필요)
+static void bench_check_order(const char *command) {
+    VirtualDevice *device = device_current();
+    long seq = atol(command);
+    long *last = &bench_last_seq[device - bench_base];
+    if (seq <= *last) {
+        __atomic_fetch_add(&g_order_errors, 1, __ATOMIC_RELAXED);
+    }
+    *last = seq;
+}
+
+static void bench_cpu_handler(const char *command) {
+    bench_check_order(command);
+    uint64_t x = (uint64_t)atol(command);
+    for (int i = 0; i < 2000; i++) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    g_sink += x;
+    __atomic_fetch_add(&g_done, 1, __ATOMIC_RELEASE);
+}
+
+static void bench_io_handler(const char *command) {
+    bench_check_order(command);
+    usleep(200);
+    __atomic_fetch_add(&g_done, 1, __ATOMIC_RELEASE);
+}
+
+// 명령 total개를 디바이스에 돌아가며 넣고 모두 끝날 때까지 걸린 시간 (초)
+static double bench_run(int workers, device_handler_t handler, long total) {
+    memset(bench_last_seq, 0, sizeof(bench_last_seq));
+    g_done = 0;
+    if (executor_start(workers) != workers) {
+        return -1.0;
+    }
+
+    uint64_t start = monotonic_time_ns();
+    char arg[24];
+    long window = (long)workers * MAX_EXECUTOR_QUEUE / 2;
+    for (long i = 0; i < total; i++) {
+        // 워커 큐가 넘치지 않도록 처리 중인 명령 수를 제한
+        while (i - __atomic_load_n(&g_done, __ATOMIC_ACQUIRE) >= window) {
+            usleep(50);
+        }
+        snprintf(arg, sizeof(arg), "%ld", i + 1);
+        if (executor_submit("led", IPC_LANE_NORMAL, handler, bench_devices[i % BENCH_DEVICES], arg) != 0) {
+            return -1.0;
+        }
+    }
+    while (__atomic_load_n(&g_done, __ATOMIC_ACQUIRE) < total) {
+        usleep(100);
+    }
+    double elapsed = (double)(monotonic_time_ns() - start) / 1e9;
+    executor_shutdown_all();
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_workers = argc > 1 ? atoi(argv[1]) : (cpus > 8 ? (int)cpus : 8);
+    if (max_workers < 1 || max_workers > MAX_EXECUTOR_WORKERS) {
+        max_workers = 8;
+    }
+
+    log_set_level(LOG_LEVEL_WARN);
+    if (device_table_add_range("bench_:1000") != BENCH_DEVICES) {
+        printf("executor_bench: failed to register devices\n");
+        return 1;
+    }
+    for (int i = 0; i < BENCH_DEVICES; i++) {
+        char id[MAX_DEVICE_ID_LEN];
+        snprintf(id, sizeof(id), "bench_%04d", i);
+        bench_devices[i] = device_table_find(id, strlen(id));
+    }
+    bench_base = bench_devices[0];
+
+    printf("online cpus: %ld, devices: %d\n", cpus, BENCH_DEVICES);
+    printf("workers    cpu cmd/s  speedup     io cmd/s  speedup   order errors\n");
+    double cpu_base = 0.0;
+    double io_base = 0.0;
+    for (int workers = 1; workers <= max_workers; workers *= 2) {
+        double cpu_s = bench_run(workers, bench_cpu_handler, BENCH_CPU_COMMANDS);
+        double io_s = bench_run(workers, bench_io_handler, BENCH_IO_COMMANDS);
+        if (cpu_s <= 0.0 || io_s <= 0.0) {
+            printf("executor_bench: run with %d workers failed\n", workers);
+            return 1;
+        }
+        double cpu_rate = BENCH_CPU_COMMANDS / cpu_s;
+        double io_rate = BENCH_IO_COMMANDS / io_s;
+        if (workers == 1) {
+            cpu_base = cpu_rate;
+            io_base = io_rate;
+        }
+        printf("%7d  %11.0f  %6.2fx  %11.0f  %6.2fx   %12ld\n", workers, cpu_rate, cpu_rate / cpu_base,
+               io_rate, io_rate / io_base, g_order_errors);
+    }
+
+    device_table_cleanup();
+    return g_order_errors == 0 ? 0 : 1;
+}
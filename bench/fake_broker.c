@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+// 벤치마크용 최소 MQTT 3.1.1 브로커 (평문 TCP, 단일 스레드 epoll)
+// CONNECT/SUBSCRIBE/UNSUBSCRIBE/PUBLISH(QoS 0~2)/PINGREQ/DISCONNECT만 처리
+// 세션 유지, retained 메시지, 인증은 없음. mosquitto가 없는 환경에서 make bench용
+
+#define BROKER_DEFAULT_PORT 1883
+#define BROKER_MAX_CLIENTS 256
+#define BROKER_MAX_FILTERS 32
+#define BROKER_FILTER_LEN 256
+#define BROKER_IN_BUFFER (1024 * 1024 + 1024)
+
+typedef struct {
+    int fd;
+    int connected;
+    unsigned char *in;
+    size_t in_len;
+    unsigned char *out;
+    size_t out_len;
+    size_t out_cap;
+    uint16_t next_packet_id;
+    int filter_count;
+    char filters[BROKER_MAX_FILTERS][BROKER_FILTER_LEN];
+    int filter_qos[BROKER_MAX_FILTERS];
+} BrokerClient;
+
+static BrokerClient *g_clients[BROKER_MAX_CLIENTS];
+static int g_epoll_fd = -1;
+static volatile sig_atomic_t g_running = 1;
+static unsigned long long g_forwarded = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+// MQTT 토픽 필터 매칭 ('+' 한 단계, '#' 나머지 전부)
+static int filter_matches(const char *filter, const char *topic, size_t topic_len) {
+    const char *end = topic + topic_len;
+    while (*filter) {
+        if (*filter == '#') {
+            return 1;
+        }
+        if (*filter == '+') {
+            while (topic < end && *topic != '/') topic++;
+            filter++;
+        } else {
+            if (topic >= end || *filter != *topic) {
+                // "a/#"는 "a"와도 일치
+                return topic >= end && filter[0] == '/' && filter[1] == '#' && filter[2] == '\0';
+            }
+            filter++;
+            topic++;
+        }
+    }
+    return topic == end;
+}
+
+static void client_want_write(BrokerClient *client, int want) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | (want ? EPOLLOUT : 0);
+    ev.data.ptr = client;
+    epoll_ctl(g_epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+}
+
+// 송신 버퍼를 가능한 만큼 전송
+static int client_flush(BrokerClient *client) {
+    size_t sent = 0;
+    while (sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + sent, client->out_len - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    memmove(client->out, client->out + sent, client->out_len - sent);
+    client->out_len -= sent;
+    client_want_write(client, client->out_len > 0);
+    return 0;
+}
+
+static int client_queue(BrokerClient *client, const void *data, size_t len) {
+    if (client->out_len + len > client->out_cap) {
+        size_t cap = client->out_cap ? client->out_cap : 4096;
+        while (cap < client->out_len + len) {
+            cap *= 2;
+        }
+        unsigned char *grown = realloc(client->out, cap);
+        if (!grown) {
+            return -1;
+        }
+        client->out = grown;
+        client->out_cap = cap;
+    }
+    memcpy(client->out + client->out_len, data, len);
+    client->out_len += len;
+    return 0;
+}
+
+// 고정 헤더 (타입/플래그 + 남은 길이 가변 인코딩)
+static size_t encode_header(unsigned char *buf, unsigned char type_flags, size_t remaining) {
+    size_t n = 0;
+    buf[n++] = type_flags;
+    do {
+        unsigned char byte = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) {
+            byte |= 0x80;
+        }
+        buf[n++] = byte;
+    } while (remaining > 0);
+    return n;
+}
+
+static void send_ack(BrokerClient *client, unsigned char type_flags, uint16_t packet_id) {
+    unsigned char ack[4] = { type_flags, 2, (unsigned char)(packet_id >> 8), (unsigned char)packet_id };
+    client_queue(client, ack, sizeof(ack));
+}
+
+// 구독자에게 PUBLISH 전달 (QoS는 최대 1, 구독자 PUBACK은 확인만 하고 무시)
+static void forward_publish(const char *topic, size_t topic_len, const unsigned char *payload,
+                            size_t payload_len, int qos) {
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        BrokerClient *client = g_clients[i];
+        if (!client || !client->connected) {
+            continue;
+        }
+        int granted = -1;
+        for (int f = 0; f < client->filter_count; f++) {
+            if (filter_matches(client->filters[f], topic, topic_len) && client->filter_qos[f] > granted) {
+                granted = client->filter_qos[f];
+            }
+        }
+        if (granted < 0) {
+            continue;
+        }
+        int out_qos = qos < granted ? qos : granted;
+        if (out_qos > 1) {
+            out_qos = 1;
+        }
+
+        unsigned char header[8];
+        size_t remaining = 2 + topic_len + (out_qos ? 2 : 0) + payload_len;
+        size_t header_len = encode_header(header, (unsigned char)(0x30 | (out_qos << 1)), remaining);
+        unsigned char topic_prefix[2] = { (unsigned char)(topic_len >> 8), (unsigned char)topic_len };
+        client_queue(client, header, header_len);
+        client_queue(client, topic_prefix, 2);
+        client_queue(client, topic, topic_len);
+        if (out_qos) {
+            if (++client->next_packet_id == 0) {
+                client->next_packet_id = 1;
+            }
+            unsigned char id[2] = { (unsigned char)(client->next_packet_id >> 8), (unsigned char)client->next_packet_id };
+            client_queue(client, id, 2);
+        }
+        client_queue(client, payload, payload_len);
+        client_flush(client);
+        g_forwarded++;
+    }
+}
+
+static uint16_t read_u16(const unsigned char *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// 패킷 하나 처리 (반환: -1이면 연결 종료)
+static int handle_packet(BrokerClient *client, unsigned char type_flags, const unsigned char *body, size_t len) {
+    int type = type_flags >> 4;
+
+    if (!client->connected && type != 1) {
+        return -1;
+    }
+    switch (type) {
+    case 1: {   // CONNECT
+        static const unsigned char connack[4] = { 0x20, 0x02, 0x00, 0x00 };
+        client->connected = 1;
+        client_queue(client, connack, sizeof(connack));
+        break;
+    }
+    case 3: {   // PUBLISH
+        int qos = (type_flags >> 1) & 3;
+        if (len < 2) {
+            return -1;
+        }
+        size_t topic_len = read_u16(body);
+        size_t pos = 2 + topic_len;
+        uint16_t packet_id = 0;
+        if (pos > len || (qos && pos + 2 > len)) {
+            return -1;
+        }
+        if (qos) {
+            packet_id = read_u16(body + pos);
+            pos += 2;
+        }
+        forward_publish((const char *)body + 2, topic_len, body + pos, len - pos, qos);
+        if (qos == 1) {
+            send_ack(client, 0x40, packet_id);          // PUBACK
+        } else if (qos == 2) {
+            send_ack(client, 0x50, packet_id);          // PUBREC
+        }
+        break;
+    }
+    case 6:     // PUBREL → PUBCOMP
+        if (len >= 2) {
+            send_ack(client, 0x70, read_u16(body));
+        }
+        break;
+    case 4:     // PUBACK (구독자 응답)
+    case 5:     // PUBREC
+    case 7:     // PUBCOMP
+        break;
+    case 8: {   // SUBSCRIBE
+        if (len < 2) {
+            return -1;
+        }
+        unsigned char suback[4 + BROKER_MAX_FILTERS + 8];
+        unsigned char codes[BROKER_MAX_FILTERS];
+        int code_count = 0;
+        size_t pos = 2;
+        while (pos + 2 <= len && code_count < BROKER_MAX_FILTERS) {
+            size_t filter_len = read_u16(body + pos);
+            pos += 2;
+            if (pos + filter_len + 1 > len) {
+                return -1;
+            }
+            int qos = body[pos + filter_len] & 3;
+            if (qos > 1) {
+                qos = 1;
+            }
+            if (filter_len < BROKER_FILTER_LEN && client->filter_count < BROKER_MAX_FILTERS) {
+                memcpy(client->filters[client->filter_count], body + pos, filter_len);
+                client->filters[client->filter_count][filter_len] = '\0';
+                client->filter_qos[client->filter_count++] = qos;
+                codes[code_count++] = (unsigned char)qos;
+            } else {
+                codes[code_count++] = 0x80;
+            }
+            pos += filter_len + 1;
+        }
+        size_t n = encode_header(suback, 0x90, 2 + (size_t)code_count);
+        suback[n++] = body[0];
+        suback[n++] = body[1];
+        memcpy(suback + n, codes, code_count);
+        client_queue(client, suback, n + code_count);
+        break;
+    }
+    case 10: {  // UNSUBSCRIBE
+        if (len < 2) {
+            return -1;
+        }
+        size_t pos = 2;
+        while (pos + 2 <= len) {
+            size_t filter_len = read_u16(body + pos);
+            pos += 2;
+            if (pos + filter_len > len) {
+                return -1;
+            }
+            for (int f = 0; f < client->filter_count; f++) {
+                if (strlen(client->filters[f]) == filter_len && memcmp(client->filters[f], body + pos, filter_len) == 0) {
+                    client->filter_count--;
+                    memmove(client->filters[f], client->filters[client->filter_count], BROKER_FILTER_LEN);
+                    client->filter_qos[f] = client->filter_qos[client->filter_count];
+                    break;
+                }
+            }
+            pos += filter_len;
+        }
+        send_ack(client, 0xB0, read_u16(body));
+        break;
+    }
+    case 12: {  // PINGREQ
+        static const unsigned char pingresp[2] = { 0xD0, 0x00 };
+        client_queue(client, pingresp, sizeof(pingresp));
+        break;
+    }
+    case 14:    // DISCONNECT
+        return -1;
+    default:
+        return -1;
+    }
+    return 0;
+}
+
+// 수신 버퍼에서 완성된 패킷을 모두 처리
+static int client_process(BrokerClient *client) {
+    size_t pos = 0;
+    while (client->in_len - pos >= 2) {
+        size_t remaining = 0;
+        size_t multiplier = 1;
+        size_t n = 1;
+        int complete = 0;
+        while (pos + n < client->in_len && n <= 4) {
+            unsigned char byte = client->in[pos + n++];
+            remaining += (byte & 0x7F) * multiplier;
+            multiplier *= 128;
+            if (!(byte & 0x80)) {
+                complete = 1;
+                break;
+            }
+        }
+        if (!complete) {
+            if (n > 4) {
+                return -1;
+            }
+            break;
+        }
+        if (n + remaining > BROKER_IN_BUFFER) {
+            return -1;
+        }
+        if (client->in_len - pos < n + remaining) {
+            break;
+        }
+        if (handle_packet(client, client->in[pos], client->in + pos + n, remaining) != 0) {
+            return -1;
+        }
+        pos += n + remaining;
+    }
+    memmove(client->in, client->in + pos, client->in_len - pos);
+    client->in_len -= pos;
+    return client_flush(client);
+}
+
+static void client_close(BrokerClient *client) {
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        if (g_clients[i] == client) {
+            g_clients[i] = NULL;
+        }
+    }
+    epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    free(client->in);
+    free(client->out);
+    free(client);
+}
+
+static void accept_clients(int listen_fd) {
+    while (1) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        int slot = -1;
+        for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+            if (!g_clients[i]) {
+                slot = i;
+                break;
+            }
+        }
+        BrokerClient *client = slot >= 0 ? calloc(1, sizeof(BrokerClient)) : NULL;
+        if (client) {
+            client->in = malloc(BROKER_IN_BUFFER);
+        }
+        if (!client || !client->in) {
+            if (client) free(client);
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        client->fd = fd;
+        g_clients[slot] = client;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = client;
+        epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int port = BROKER_DEFAULT_PORT;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:")) != -1) {
+        if (opt == 'p') {
+            port = atoi(optarg);
+        } else {
+            fprintf(stderr, "usage: %s [-p port]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+        perror("fake_broker: bind/listen failed");
+        return 1;
+    }
+
+    g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    printf("fake_broker: listening on 127.0.0.1:%d\n", port);
+    fflush(stdout);
+
+    struct epoll_event events[64];
+    while (g_running) {
+        int count = epoll_wait(g_epoll_fd, events, 64, 500);
+        for (int i = 0; i < count; i++) {
+            BrokerClient *client = events[i].data.ptr;
+            if (!client) {
+                accept_clients(listen_fd);
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                client_close(client);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                if (client_flush(client) != 0) {
+                    client_close(client);
+                    continue;
+                }
+            }
+            if (events[i].events & EPOLLIN) {
+                ssize_t n = recv(client->fd, client->in + client->in_len, BROKER_IN_BUFFER - client->in_len, 0);
+                if (n <= 0) {
+                    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                        continue;
+                    }
+                    client_close(client);
+                    continue;
+                }
+                client->in_len += (size_t)n;
+                if (client_process(client) != 0) {
+                    client_close(client);
+                }
+            }
+        }
+    }
+
+    printf("fake_broker: forwarded %llu messages\n", g_forwarded);
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        if (g_clients[i]) {
+            client_close(g_clients[i]);
+        }
+    }
+    close(listen_fd);
+    close(g_epoll_fd);
+    return 0;
+}
@@ -0,0 +1,349 @@
+#include "../src/mqtt.h"
+
+// 종단 간 부하 생성기
+// sub_topic.txt의 제어 토픽마다 명령을 정해진 속도로 보내고, 게이트웨이가 돌려주는
+// status/<device_id>/<target>/return 응답을 짝지어 명령 → 상태 지연을 잰다
+// 지연은 실제 전송 시각이 아니라 예정 전송 시각부터 재므로 송신이 밀려도 지연에 반영됨
+// 응답에는 요청 ID가 없으므로 대상별 FIFO 순서로 짝지음 (같은 디바이스는 실행기가 순서대로 처리)
+
+#define LOADGEN_MAX_WORKERS 64
+#define LOADGEN_FIFO_SIZE 65536
+
+// 부하 대상 하나 (제어 토픽 → 상태 토픽)
+typedef struct {
+    char control_topic[MAX_TOPIC_LEN];
+    char status_topic[MAX_TOPIC_LEN];
+    const char *payload;
+    pthread_mutex_t lock;           // 예정 시각 기록과 발행을 한 묶음으로 (FIFO 순서 보장)
+    uint64_t fifo[LOADGEN_FIFO_SIZE];
+    uint64_t head;
+    uint64_t tail;
+} LoadTarget;
+
+// 디바이스별 기본 명령 (결과를 발행하는 가벼운 명령)
+static const struct {
+    const char *device;
+    const char *command;
+    const char *payload;
+} g_default_commands[] = {
+    { "led", "on", "" },
+    { "buzzer", "off", "" },
+    { "photoresistor", "read", "" },
+    { "s_segment", "display", "7" },
+};
+
+static struct {
+    const char *url;
+    const char *topic_file;
+    const char *ca_file;
+    double rate;
+    int concurrency;
+    int duration_s;
+    int qos;
+    int drain_ms;
+} g_opts = { "tcp://127.0.0.1:1883", "sub_topic.txt", NULL, 200.0, 4, 10, 1, 2000 };
+
+static LoadTarget *g_targets;
+static int g_target_count = 0;
+static uint64_t *g_latencies;
+static uint64_t g_latency_capacity;
+static uint64_t g_latency_count = 0;
+static uint64_t g_sent = 0;
+static uint64_t g_send_failed = 0;
+static uint64_t g_unmatched = 0;
+static uint64_t g_start_ns;
+
+// 구독 필터에서 부하 대상 생성 (control/<id>/<device>/+ → control/<id>/<device>/<command>)
+static int build_targets(const TopicList *topics) {
+    g_targets = calloc(topics->count, sizeof(LoadTarget));
+    if (!g_targets) {
+        return -1;
+    }
+    for (int i = 0; i < topics->count; i++) {
+        ParsedTopic parsed;
+        char device_id[64];
+        char device[64];
+        if (parse_topic_view(topics->topics[i], &parsed) != 0 ||
+            !topic_level_is(topics->topics[i], parsed.prefix, "control")) {
+            continue;
+        }
+        topic_level_copy(topics->topics[i], parsed.device_id, device_id, sizeof(device_id));
+        topic_level_copy(topics->topics[i], parsed.target_device, device, sizeof(device));
+        if (strchr(device_id, '+') || strchr(device, '+') || strchr(device, '#')) {
+            continue;
+        }
+
+        const char *command = "on";
+        const char *payload = "";
+        for (size_t c = 0; c < sizeof(g_default_commands) / sizeof(g_default_commands[0]); c++) {
+            if (strcmp(device, g_default_commands[c].device) == 0) {
+                command = g_default_commands[c].command;
+                payload = g_default_commands[c].payload;
+            }
+        }
+
+        LoadTarget *target = &g_targets[g_target_count++];
+        snprintf(target->control_topic, sizeof(target->control_topic), "control/%s/%s/%s", device_id, device, command);
+        snprintf(target->status_topic, sizeof(target->status_topic), "status/%s/%s/return", device_id, device);
+        target->payload = payload;
+        pthread_mutex_init(&target->lock, NULL);
+    }
+    return g_target_count;
+}
+
+static int connect_client(MQTTClient *client, const char *client_id, MQTTClient_messageArrived *on_message) {
+    MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer;
+    MQTTClient_SSLOptions ssl_opts = MQTTClient_SSLOptions_initializer;
+    int rc;
+
+    if ((rc = MQTTClient_create(client, g_opts.url, client_id, MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTCLIENT_SUCCESS) {
+        printf("loadgen: Failed to create client '%s', return code %d\n", client_id, rc);
+        return -1;
+    }
+    if (on_message) {
+        MQTTClient_setCallbacks(*client, NULL, NULL, on_message, NULL);
+    }
+    conn_opts.keepAliveInterval = 30;
+    conn_opts.cleansession = 1;
+    if (strncmp(g_opts.url, "ssl://", 6) == 0) {
+        ssl_opts.trustStore = g_opts.ca_file;
+        ssl_opts.enableServerCertAuth = g_opts.ca_file != NULL;
+        conn_opts.ssl = &ssl_opts;
+    }
+    if ((rc = MQTTClient_connect(*client, &conn_opts)) != MQTTCLIENT_SUCCESS) {
+        printf("loadgen: Failed to connect '%s' to %s, return code %d\n", client_id, g_opts.url, rc);
+        MQTTClient_destroy(client);
+        return -1;
+    }
+    return 0;
+}
+
+// 응답 하나를 가장 오래된 미응답 명령과 짝지음
+static void match_response(LoadTarget *target, uint64_t now) {
+    pthread_mutex_lock(&target->lock);
+    if (target->tail == target->head) {
+        pthread_mutex_unlock(&target->lock);
+        __atomic_fetch_add(&g_unmatched, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    uint64_t scheduled = target->fifo[target->tail++ % LOADGEN_FIFO_SIZE];
+    pthread_mutex_unlock(&target->lock);
+
+    uint64_t index = __atomic_fetch_add(&g_latency_count, 1, __ATOMIC_RELAXED);
+    if (index < g_latency_capacity) {
+        g_latencies[index] = now > scheduled ? now - scheduled : 0;
+    }
+}
+
+// 상태 응답 수신 (배치 발행이면 "[{...},{...}]" 안의 결과 개수만큼 짝지음)
+static int on_status_message(void *context, char *topicName, int topicLen, MQTTClient_message *message) {
+    (void)context;
+    (void)topicLen;
+    uint64_t now = monotonic_time_ns();
+
+    for (int i = 0; i < g_target_count; i++) {
+        if (strcmp(g_targets[i].status_topic, topicName) != 0) {
+            continue;
+        }
+        const char *payload = message->payload;
+        int results = 1;
+        if (message->payloadlen > 0 && payload[0] == '[') {
+            int depth = 0;
+            int in_string = 0;
+            results = 0;
+            for (int p = 0; p < message->payloadlen; p++) {
+                char c = payload[p];
+                if (in_string) {
+                    if (c == '\\') p++;
+                    else if (c == '"') in_string = 0;
+                } else if (c == '"') {
+                    in_string = 1;
+                } else if (c == '{' || c == '[') {
+                    if (depth++ == 1 && c == '{') results++;
+                } else if (c == '}' || c == ']') {
+                    depth--;
+                }
+            }
+        }
+        for (int r = 0; r < results; r++) {
+            match_response(&g_targets[i], now);
+        }
+        break;
+    }
+
+    MQTTClient_freeMessage(&message);
+    MQTTClient_free(topicName);
+    return 1;
+}
+
+// 송신 스레드: 전체 속도의 1/concurrency로 대상을 돌아가며 전송 (예정 시각 기준 개방 루프)
+static void *worker_main(void *arg) {
+    int id = (int)(intptr_t)arg;
+    MQTTClient client;
+    char client_id[64];
+    snprintf(client_id, sizeof(client_id), "loadgen_pub_%d_%d", (int)getpid(), id);
+    if (connect_client(&client, client_id, NULL) != 0) {
+        return NULL;
+    }
+
+    uint64_t interval_ns = (uint64_t)(1e9 * g_opts.concurrency / g_opts.rate);
+    uint64_t end_ns = g_start_ns + (uint64_t)g_opts.duration_s * 1000000000ULL;
+    uint64_t scheduled = g_start_ns + interval_ns * (uint64_t)id / (uint64_t)g_opts.concurrency;
+    int next_target = id % g_target_count;
+
+    while (scheduled < end_ns) {
+        struct timespec wake = { (time_t)(scheduled / 1000000000ULL), (long)(scheduled % 1000000000ULL) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+
+        LoadTarget *target = &g_targets[next_target];
+        next_target = (next_target + 1) % g_target_count;
+
+        MQTTClient_message msg = MQTTClient_message_initializer;
+        msg.payload = (void *)target->payload;
+        msg.payloadlen = (int)strlen(target->payload);
+        msg.qos = g_opts.qos;
+        msg.retained = 0;
+
+        pthread_mutex_lock(&target->lock);
+        int rc = MQTTCLIENT_FAILURE;
+        if (target->head - target->tail < LOADGEN_FIFO_SIZE) {
+            target->fifo[target->head++ % LOADGEN_FIFO_SIZE] = scheduled;
+            rc = MQTTClient_publishMessage(client, target->control_topic, &msg, NULL);
+            if (rc != MQTTCLIENT_SUCCESS) {
+                target->head--;
+            }
+        }
+        pthread_mutex_unlock(&target->lock);
+
+        if (rc == MQTTCLIENT_SUCCESS) {
+            __atomic_fetch_add(&g_sent, 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_fetch_add(&g_send_failed, 1, __ATOMIC_RELAXED);
+        }
+        scheduled += interval_ns;
+    }
+
+    MQTTClient_disconnect(client, 1000);
+    MQTTClient_destroy(&client);
+    return NULL;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const uint64_t *sorted, uint64_t count, double percentile) {
+    if (count == 0) {
+        return 0.0;
+    }
+    uint64_t index = (uint64_t)(percentile / 100.0 * (double)(count - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+static void usage(const char *program) {
+    printf("usage: %s [-u url] [-f topic_file] [-r rate] [-c concurrency] [-d seconds] [-q qos] [-a ca_file] [-w drain_ms]\n",
+           program);
+    printf("  -u  broker URL (default tcp://127.0.0.1:1883, ssl://... for TLS)\n");
+    printf("  -f  subscriber topic file to derive control topics from (default sub_topic.txt)\n");
+    printf("  -r  total commands per second (default 200)\n");
+    printf("  -c  publishing connections (default 4)\n");
+    printf("  -d  test duration in seconds (default 10)\n");
+    printf("  -q  control message QoS (default 1)\n");
+    printf("  -a  CA certificate for ssl:// URLs\n");
+    printf("  -w  time to wait for late responses after sending stops (default 2000 ms)\n");
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "u:f:r:c:d:q:a:w:h")) != -1) {
+        switch (opt) {
+        case 'u': g_opts.url = optarg; break;
+        case 'f': g_opts.topic_file = optarg; break;
+        case 'r': g_opts.rate = atof(optarg); break;
+        case 'c': g_opts.concurrency = atoi(optarg); break;
+        case 'd': g_opts.duration_s = atoi(optarg); break;
+        case 'q': g_opts.qos = atoi(optarg); break;
+        case 'a': g_opts.ca_file = optarg; break;
+        case 'w': g_opts.drain_ms = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (g_opts.rate <= 0 || g_opts.concurrency <= 0 || g_opts.concurrency > LOADGEN_MAX_WORKERS ||
+        g_opts.duration_s <= 0 || g_opts.qos < 0 || g_opts.qos > 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    log_set_level(LOG_LEVEL_WARN);
+
+    TopicList topics;
+    int target_count = load_topics_from_file(&topics, g_opts.topic_file) > 0 ? build_targets(&topics) : 0;
+    topic_list_free(&topics);
+    if (target_count <= 0) {
+        printf("loadgen: No control topics found in '%s'\n", g_opts.topic_file);
+        return 1;
+    }
+
+    g_latency_capacity = (uint64_t)(g_opts.rate * g_opts.duration_s * 1.1) + 1024;
+    g_latencies = malloc(sizeof(uint64_t) * g_latency_capacity);
+    if (!g_latencies) {
+        return 1;
+    }
+
+    // 응답 수신용 연결 (대상별 상태 토픽 구독)
+    MQTTClient receiver;
+    char receiver_id[64];
+    snprintf(receiver_id, sizeof(receiver_id), "loadgen_sub_%d", (int)getpid());
+    if (connect_client(&receiver, receiver_id, on_status_message) != 0) {
+        return 1;
+    }
+    TopicList status_topics;
+    topic_list_init(&status_topics);
+    for (int i = 0; i < g_target_count; i++) {
+        topic_list_add(&status_topics, g_targets[i].status_topic, 1);
+    }
+    subscribe_to_topics(receiver, &status_topics, 1, 0);
+    topic_list_free(&status_topics);
+
+    printf("loadgen: %s, %d target(s), %.0f cmd/s over %d connection(s) for %d s, QoS %d\n",
+           g_opts.url, g_target_count, g_opts.rate, g_opts.concurrency, g_opts.duration_s, g_opts.qos);
+    for (int i = 0; i < g_target_count; i++) {
+        printf("  - %s -> %s\n", g_targets[i].control_topic, g_targets[i].status_topic);
+    }
+
+    pthread_t workers[LOADGEN_MAX_WORKERS];
+    g_start_ns = monotonic_time_ns() + 100000000ULL;
+    for (int i = 0; i < g_opts.concurrency; i++) {
+        pthread_create(&workers[i], NULL, worker_main, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < g_opts.concurrency; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    uint64_t send_end_ns = monotonic_time_ns();
+
+    // 늦은 응답 대기 (모두 받으면 바로 종료)
+    uint64_t drain_deadline = send_end_ns + (uint64_t)g_opts.drain_ms * 1000000ULL;
+    while (monotonic_time_ns() < drain_deadline &&
+           __atomic_load_n(&g_latency_count, __ATOMIC_RELAXED) < __atomic_load_n(&g_sent, __ATOMIC_RELAXED)) {
+        usleep(10000);
+    }
+    MQTTClient_disconnect(receiver, 1000);
+    MQTTClient_destroy(&receiver);
+
+    uint64_t received = g_latency_count < g_latency_capacity ? g_latency_count : g_latency_capacity;
+    double elapsed_s = (double)(send_end_ns - g_start_ns) / 1e9;
+    qsort(g_latencies, received, sizeof(uint64_t), compare_u64);
+
+    printf("sent=%llu send_failed=%llu received=%llu unmatched=%llu lost=%llu throughput=%.1f\n",
+           (unsigned long long)g_sent, (unsigned long long)g_send_failed, (unsigned long long)received,
+           (unsigned long long)g_unmatched,
+           (unsigned long long)(g_sent > received ? g_sent - received : 0),
+           elapsed_s > 0 ? received / elapsed_s : 0.0);
+    printf("latency_us p50=%.1f p99=%.1f p999=%.1f max=%.1f\n",
+           percentile_us(g_latencies, received, 50.0), percentile_us(g_latencies, received, 99.0),
+           percentile_us(g_latencies, received, 99.9), received ? g_latencies[received - 1] / 1000.0 : 0.0);
+    return received > 0 ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+#include "../src/mqtt.h"
+
+// 파싱/검증/IPC 기본 연산 마이크로벤치마크
+// 토픽 파서, 페이로드 파서, 토픽 검증, 토픽 파일 로드, IPC 송수신 왕복을 측정하고
+// Go 벤치마크 형식(한 줄에 하나)으로 출력해 커밋 간 비교에 그대로 사용 (예: benchstat)
+//
+//   BenchmarkName  반복수  ns/op  [MB/s]  B/op  allocs/op
+//
+// 사용법: primitives_bench [-t 최소측정ms] [이름필터]
+
+#define BENCH_DEFAULT_MIN_MS 200
+#define BENCH_MAX_ITERATIONS 1000000000L
+#define BENCH_IPC_PAYLOAD_LEN 64
+#define BENCH_LARGE_JSON_SIZE (MAX_PAYLOAD_SIZE - 4096)
+
+// ---- 할당 횟수 계측 ----
+// 실행 파일에서 malloc 계열을 정의해 libc 구현 앞에 끼워 넣음 (라이브러리 내부 호출 포함)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t g_alloc_count;
+static uint64_t g_alloc_bytes;
+
+static void count_alloc(size_t size) {
+    __atomic_fetch_add(&g_alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc_bytes, size, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    count_alloc(nmemb * size);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+// ---- 측정 도구 ----
+typedef void (*bench_fn_t)(void *ctx, long iterations);
+
+typedef struct {
+    const char *name;
+    bench_fn_t fn;
+    void *ctx;
+    size_t bytes_per_op;    // 처리량 계산용 (0이면 MB/s 생략)
+} BenchCase;
+
+static volatile int g_sink;
+static long g_min_ns = (long)BENCH_DEFAULT_MIN_MS * 1000000L;
+
+// 최소 측정 시간을 넘을 때까지 반복 수를 늘려 가며 실행하고 마지막 실행을 보고
+static void bench_run(const BenchCase *bench) {
+    long iterations = 1;
+    uint64_t elapsed = 0;
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+
+    for (;;) {
+        uint64_t allocs_before = __atomic_load_n(&g_alloc_count, __ATOMIC_RELAXED);
+        uint64_t bytes_before = __atomic_load_n(&g_alloc_bytes, __ATOMIC_RELAXED);
+        uint64_t start = monotonic_time_ns();
+        bench->fn(bench->ctx, iterations);
+        elapsed = monotonic_time_ns() - start;
+        allocs = __atomic_load_n(&g_alloc_count, __ATOMIC_RELAXED) - allocs_before;
+        bytes = __atomic_load_n(&g_alloc_bytes, __ATOMIC_RELAXED) - bytes_before;
+
+        if ((long)elapsed >= g_min_ns || iterations >= BENCH_MAX_ITERATIONS) {
+            break;
+        }
+        // 목표 시간에 맞춰 1.2배 여유를 두고 예측하되 한 번에 2~100배로 제한
+        double scale = elapsed ? (double)g_min_ns * 1.2 / (double)elapsed : 100.0;
+        if (scale < 2.0) {
+            scale = 2.0;
+        } else if (scale > 100.0) {
+            scale = 100.0;
+        }
+        iterations = (long)(iterations * scale);
+        if (iterations > BENCH_MAX_ITERATIONS) {
+            iterations = BENCH_MAX_ITERATIONS;
+        }
+    }
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    printf("Benchmark%-36s %10ld %14.1f ns/op", bench->name, iterations, ns_per_op);
+    if (bench->bytes_per_op > 0) {
+        printf(" %10.2f MB/s", (double)bench->bytes_per_op * 1e3 / ns_per_op);
+    }
+    printf(" %10llu B/op %8.2f allocs/op\n",
+           (unsigned long long)(bytes / (uint64_t)iterations), (double)allocs / (double)iterations);
+    fflush(stdout);
+}
+
+// ---- 토픽 파싱 (parse_topic_hierarchy의 뷰 기반 구현) ----
+static const char *bench_topics[] = {
+    "control/raspberry_001/led/on",
+    "control/raspberry_001/buzzer/beep",
+    "control/raspberry_001/s_segment/clear",
+    "control/raspberry_001/photoresistor/calibrate",
+};
+#define BENCH_TOPIC_COUNT (int)(sizeof(bench_topics) / sizeof(bench_topics[0]))
+
+static void bench_parse_topic(void *ctx, long iterations) {
+    (void)ctx;
+    for (long i = 0; i < iterations; i++) {
+        const char *topic = bench_topics[i % BENCH_TOPIC_COUNT];
+        ParsedTopic parsed;
+        parse_topic_view(topic, &parsed);
+        g_sink += parsed.is_valid + topic[parsed.command.offset];
+    }
+}
+
+// ---- 토픽 검증 ----
+static void bench_validate(void *ctx, long iterations) {
+    const char *topic = ctx;
+    for (long i = 0; i < iterations; i++) {
+        g_sink += validate_topic_format(topic);
+    }
+}
+
+// ---- 페이로드 파싱 ----
+typedef struct {
+    const char *payload;
+    int payload_len;
+} PayloadCase;
+
+static void bench_parse_payload(void *ctx, long iterations) {
+    const PayloadCase *pc = ctx;
+    for (long i = 0; i < iterations; i++) {
+        ParsedMessage parsed = parse_message_payload(pc->payload, pc->payload_len);
+        g_sink += parsed.is_json + parsed.message[0];
+    }
+}
+
+// 센서 배열 뒤에 message/value가 오는 큰 JSON (추출기가 문서 끝까지 훑어야 함)
+static char *make_large_json(size_t target, int *out_len) {
+    char *buf = malloc(target + 1);
+    if (!buf) {
+        return NULL;
+    }
+    static const char tail[] = "],\"message\":\"calibrate\",\"value\":512,\"status\":\"ok\"}";
+    size_t len = (size_t)snprintf(buf, target, "{\"data\":[");
+    for (int i = 0; len + 64 + sizeof(tail) < target; i++) {
+        len += (size_t)snprintf(buf + len, target - len, "%s{\"id\":%d,\"lux\":%d,\"tag\":\"sensor_%04d\"}",
+                                i ? "," : "", i, (i * 37) % 1024, i % 10000);
+    }
+    memcpy(buf + len, tail, sizeof(tail));
+    *out_len = (int)(len + sizeof(tail) - 1);
+    return buf;
+}
+
+// ---- 토픽 파일 로드 ----
+typedef struct {
+    char path[64];
+    size_t file_bytes;
+} TopicFileCase;
+
+static TopicList g_topic_list;
+
+static void bench_load_topics(void *ctx, long iterations) {
+    const TopicFileCase *tc = ctx;
+    for (long i = 0; i < iterations; i++) {
+        g_sink += load_topics_from_file(&g_topic_list, tc->path);
+        topic_list_free(&g_topic_list);
+    }
+}
+
+// 네 줄 중 세 줄은 토픽, 나머지는 주석/빈 줄 (expected에 토픽 수 반환)
+static int make_topic_file(TopicFileCase *tc, int lines, int *expected) {
+    snprintf(tc->path, sizeof(tc->path), "/tmp/primitives_bench_topics.XXXXXX");
+    int fd = mkstemp(tc->path);
+    if (fd == -1) {
+        return -1;
+    }
+    FILE *file = fdopen(fd, "w");
+    if (!file) {
+        close(fd);
+        unlink(tc->path);
+        return -1;
+    }
+
+    *expected = 0;
+    for (int i = 0; i < lines; i++) {
+        if (i % 4 != 0) {
+            fprintf(file, "control/device_%06d/sensor_%d/+\n", i, i % 8);
+            (*expected)++;
+        } else if (i % 8 == 0) {
+            fprintf(file, "\n");
+        } else {
+            fprintf(file, "# building_a/floor_%d/room_%d reserved filter\n", i % 12, i % 40);
+        }
+    }
+    tc->file_bytes = (size_t)ftell(file);
+    fclose(file);
+    return 0;
+}
+
+// ---- IPC 왕복 ----
+// 같은 프로세스에서 보내고 바로 받아 전송 계층 비용만 측정 (eventfd 깨우기와 fork는 제외)
+typedef struct {
+    int msg_queue_id;
+    char payload[BENCH_IPC_PAYLOAD_LEN];
+} IPCCase;
+
+static void bench_ipc_roundtrip(void *ctx, long iterations) {
+    IPCCase *ic = ctx;
+    for (long i = 0; i < iterations; i++) {
+        IPCRecordView view;
+        if (ipc_send_control_message(ic->msg_queue_id, IPC_LANE_NORMAL, bench_topics[0],
+                                     ic->payload, BENCH_IPC_PAYLOAD_LEN) != 0 ||
+            ipc_receive_control_view(ic->msg_queue_id, &view) != 0) {
+            g_sink -= 1;
+            continue;
+        }
+        g_sink += view.payload_len;
+        ipc_release_control_view(&view);
+    }
+}
+
+// 한 번 왕복시켜 전송 계층이 동작하는지 확인 (실패하면 측정값이 의미 없음)
+static int ipc_check_roundtrip(IPCCase *ic) {
+    IPCRecordView view;
+    if (ipc_send_control_message(ic->msg_queue_id, IPC_LANE_NORMAL, bench_topics[0],
+                                 ic->payload, BENCH_IPC_PAYLOAD_LEN) != 0 ||
+        ipc_receive_control_view(ic->msg_queue_id, &view) != 0) {
+        return -1;
+    }
+    int ok = view.payload_len == BENCH_IPC_PAYLOAD_LEN;
+    ipc_release_control_view(&view);
+    return ok ? 0 : -1;
+}
+
+static int matches_filter(const char *name, const char *filter) {
+    return !filter || strstr(name, filter) != NULL;
+}
+
+int main(int argc, char *argv[]) {
+    const char *filter = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            g_min_ns = atol(argv[++i]) * 1000000L;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    // 파일 로드 경고/정보 로그가 측정에 섞이지 않도록
+    log_set_level(LOG_LEVEL_ERROR);
+
+    printf("goos: linux\n");
+    printf("pkg: mqtt/primitives\n");
+
+    // 토픽
+    BenchCase topic_cases[] = {
+        { "ParseTopicView", bench_parse_topic, NULL, 0 },
+        { "ValidateTopic/exact", bench_validate, "control/raspberry_001/photoresistor/calibrate", 0 },
+        { "ValidateTopic/wildcard", bench_validate, "control/+/led/#", 0 },
+        { "ValidateTopic/invalid", bench_validate, "control/rasp#berry/led", 0 },
+    };
+    for (size_t i = 0; i < sizeof(topic_cases) / sizeof(topic_cases[0]); i++) {
+        if (matches_filter(topic_cases[i].name, filter)) {
+            bench_run(&topic_cases[i]);
+        }
+    }
+
+    // 페이로드
+    static const char plain[] = "on";
+    static const char small_json[] = "{\"message\":\"on\",\"value\":1,\"status\":\"ok\"}";
+    int large_len = 0;
+    char *large_json = make_large_json(BENCH_LARGE_JSON_SIZE, &large_len);
+    if (!large_json) {
+        printf("primitives_bench: out of memory\n");
+        return 1;
+    }
+    PayloadCase payloads[] = {
+        { plain, (int)strlen(plain) },
+        { small_json, (int)strlen(small_json) },
+        { large_json, large_len },
+    };
+    ParsedMessage check = parse_message_payload(large_json, large_len);
+    if (!check.is_json || strcmp(check.message, "calibrate") != 0) {
+        printf("primitives_bench: large JSON payload not parsed\n");
+        return 1;
+    }
+    BenchCase payload_cases[] = {
+        { "ParsePayload/plain", bench_parse_payload, &payloads[0], (size_t)payloads[0].payload_len },
+        { "ParsePayload/small_json", bench_parse_payload, &payloads[1], (size_t)payloads[1].payload_len },
+        { "ParsePayload/large_json", bench_parse_payload, &payloads[2], (size_t)payloads[2].payload_len },
+    };
+    for (size_t i = 0; i < sizeof(payload_cases) / sizeof(payload_cases[0]); i++) {
+        if (matches_filter(payload_cases[i].name, filter)) {
+            bench_run(&payload_cases[i]);
+        }
+    }
+    free(large_json);
+
+    // 토픽 파일
+    static const int file_lines[] = { 100, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(file_lines) / sizeof(file_lines[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "LoadTopicsFromFile/lines_%d", file_lines[i]);
+        if (!matches_filter(name, filter)) {
+            continue;
+        }
+        TopicFileCase tc;
+        int expected;
+        if (make_topic_file(&tc, file_lines[i], &expected) != 0) {
+            printf("primitives_bench: cannot create topic file\n");
+            return 1;
+        }
+        if (load_topics_from_file(&g_topic_list, tc.path) != expected) {
+            printf("primitives_bench: topic file loaded %d topics, expected %d\n",
+                   g_topic_list.count, expected);
+            unlink(tc.path);
+            return 1;
+        }
+        topic_list_free(&g_topic_list);
+        BenchCase bench = { name, bench_load_topics, &tc, tc.file_bytes };
+        bench_run(&bench);
+        unlink(tc.path);
+    }
+
+    // IPC (메시지 큐는 실행 중인 게이트웨이와 겹치지 않도록 전용 큐 사용)
+    IPCCase ipc;
+    memset(ipc.payload, 'x', sizeof(ipc.payload));
+    if (matches_filter("IPCRoundTrip/msgqueue", filter)) {
+        ipc.msg_queue_id = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+        if (ipc.msg_queue_id == -1) {
+            perror("msgget failed");
+            return 1;
+        }
+        if (ipc_check_roundtrip(&ipc) != 0) {
+            printf("primitives_bench: message queue round trip failed\n");
+            msgctl(ipc.msg_queue_id, IPC_RMID, NULL);
+            return 1;
+        }
+        BenchCase bench = { "IPCRoundTrip/msgqueue", bench_ipc_roundtrip, &ipc, BENCH_IPC_PAYLOAD_LEN };
+        bench_run(&bench);
+        msgctl(ipc.msg_queue_id, IPC_RMID, NULL);
+    }
+    if (matches_filter("IPCRoundTrip/shm", filter)) {
+        if (ipc_enable_shm_ring(IPC_RING_DEFAULT_SIZE) != 0) {
+            printf("primitives_bench: shared ring unavailable\n");
+            return 1;
+        }
+        ipc.msg_queue_id = -1;
+        if (ipc_check_roundtrip(&ipc) != 0) {
+            printf("primitives_bench: shared ring round trip failed\n");
+            ipc_cleanup(-1);
+            return 1;
+        }
+        BenchCase bench = { "IPCRoundTrip/shm", bench_ipc_roundtrip, &ipc, BENCH_IPC_PAYLOAD_LEN };
+        bench_run(&bench);
+        ipc_cleanup(-1);
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/sh
+# 종단 간 부하 벤치마크 (make bench에서 실행)
+# 로컬 브로커(mosquitto 또는 bin/fake_broker) → 게이트웨이(bin/mqtt, 평문 TCP) → bin/loadgen 순으로 띄우고
+# 명령 → 상태 응답 처리량과 p50/p99/p999 지연을 출력
+#
+# 환경 변수:
+#   BROKER=fake|mosquitto   (기본 fake, mosquitto가 없으면 fake 사용)
+#   BENCH_PORT=18830  RATE=200  CONCURRENCY=4  DURATION=10  QOS=1  MODE=fork|single
+
+set -u
+
+BIN=${BIN:-bin}
+BROKER=${BROKER:-fake}
+BENCH_PORT=${BENCH_PORT:-18830}
+RATE=${RATE:-200}
+CONCURRENCY=${CONCURRENCY:-4}
+DURATION=${DURATION:-10}
+QOS=${QOS:-1}
+MODE=${MODE:-fork}
+
+WORKDIR=$(mktemp -d /tmp/mqtt_bench.XXXXXX)
+BROKER_PID=""
+GATEWAY_PID=""
+
+cleanup() {
+    if [ -n "$GATEWAY_PID" ]; then
+        # fork 모드는 자식(Publisher)에도 전달
+        pkill -INT -P "$GATEWAY_PID" 2>/dev/null
+        kill -INT "$GATEWAY_PID" 2>/dev/null
+        wait "$GATEWAY_PID" 2>/dev/null
+    fi
+    if [ -n "$BROKER_PID" ]; then
+        kill -INT "$BROKER_PID" 2>/dev/null
+        wait "$BROKER_PID" 2>/dev/null
+    fi
+    rm -rf "$WORKDIR"
+}
+trap cleanup EXIT INT TERM
+
+# 1. 브로커
+if [ "$BROKER" = "mosquitto" ] && command -v mosquitto >/dev/null 2>&1; then
+    printf 'listener %s 127.0.0.1\nallow_anonymous true\n' "$BENCH_PORT" > "$WORKDIR/mosquitto.conf"
+    mosquitto -c "$WORKDIR/mosquitto.conf" > "$WORKDIR/broker.log" 2>&1 &
+else
+    [ "$BROKER" = "mosquitto" ] && echo "bench: mosquitto not found, using bundled fake broker"
+    "$BIN/fake_broker" -p "$BENCH_PORT" > "$WORKDIR/broker.log" 2>&1 &
+fi
+BROKER_PID=$!
+sleep 0.3
+
+# 2. 게이트웨이 (TLS 없이 로컬 브로커에 연결, 진단 로그는 경고 이상만)
+cat > "$WORKDIR/bench.conf" <<EOF
+endpoint=127.0.0.1
+port=$BENCH_PORT
+tls=0
+client_id=bench_gateway_$$
+topic_file=sub_topic.txt
+pub_topic_file=pub_topic.txt
+qos=$QOS
+keep_alive_interval=30
+timeout=10000
+process_mode=$MODE
+log_level=warn
+metrics_interval_ms=0
+EOF
+"$BIN/mqtt" "$WORKDIR/bench.conf" > "$WORKDIR/gateway.log" 2>&1 &
+GATEWAY_PID=$!
+sleep 1
+if ! kill -0 "$GATEWAY_PID" 2>/dev/null; then
+    echo "bench: gateway failed to start"
+    cat "$WORKDIR/gateway.log"
+    exit 1
+fi
+
+# 3. 부하 생성
+"$BIN/loadgen" -u "tcp://127.0.0.1:$BENCH_PORT" -f sub_topic.txt \
+    -r "$RATE" -c "$CONCURRENCY" -d "$DURATION" -q "$QOS"
+STATUS=$?
+if [ $STATUS -ne 0 ]; then
+    echo "bench: loadgen failed, gateway log tail:"
+    tail -20 "$WORKDIR/gateway.log"
+fi
+exit $STATUS
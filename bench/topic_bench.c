@@ -0,0 +1,124 @@
+#include "../src/mqtt.h"
+
+// 토픽 토크나이저 마이크로벤치마크
+// 기존 malloc + strtok 파서와 뷰 기반 파서를 같은 토픽 집합으로 비교
+
+#define BENCH_ITERATIONS 2000000
+
+// 비교용: 이전 parse_topic_hierarchy 구현 그대로
+typedef struct {
+    char prefix[64];
+    char device_id[64];
+    char target_device[64];
+    char command[64];
+    int is_valid;
+} LegacyParsedTopic;
+
+static LegacyParsedTopic legacy_parse_topic_hierarchy(const char *topic_name) {
+    LegacyParsedTopic result;
+    memset(&result, 0, sizeof(LegacyParsedTopic));
+
+    int topic_len = strlen(topic_name);
+    char *topic_copy = malloc(topic_len + 1);
+    if (!topic_copy) {
+        return result;
+    }
+    strcpy(topic_copy, topic_name);
+
+    char *prefix = strtok(topic_copy, "/");
+    char *device_id = strtok(NULL, "/");
+    char *target_device = strtok(NULL, "/");
+    char *command = strtok(NULL, "/");
+
+    if (prefix && device_id && target_device && command) {
+        strncpy(result.prefix, prefix, sizeof(result.prefix) - 1);
+        strncpy(result.device_id, device_id, sizeof(result.device_id) - 1);
+        strncpy(result.target_device, target_device, sizeof(result.target_device) - 1);
+        strncpy(result.command, command, sizeof(result.command) - 1);
+        result.is_valid = 1;
+    }
+
+    free(topic_copy);
+    return result;
+}
+
+static const char *bench_topics[] = {
+    "control/raspberry_001/led/on",
+    "control/raspberry_001/buzzer/beep",
+    "control/raspberry_001/s_segment/clear",
+    "control/raspberry_001/photoresistor/calibrate",
+    "control/gateway_building_a_floor_3/environment_sensor_array/read_all_channels",
+};
+#define BENCH_TOPIC_COUNT (int)(sizeof(bench_topics) / sizeof(bench_topics[0]))
+
+static volatile int g_sink;
+
+static double bench_legacy(void) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        LegacyParsedTopic parsed = legacy_parse_topic_hierarchy(bench_topics[i % BENCH_TOPIC_COUNT]);
+        g_sink += parsed.is_valid + parsed.command[0];
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+static double bench_view(void) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const char *topic = bench_topics[i % BENCH_TOPIC_COUNT];
+        ParsedTopic parsed;
+        parse_topic_view(topic, &parsed);
+        g_sink += parsed.is_valid + topic[parsed.command.offset];
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+// 실제 사용 형태: 뷰 파싱 + 디바이스 비교 + 명령만 스택에 복사
+static double bench_view_with_copy(void) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        const char *topic = bench_topics[i % BENCH_TOPIC_COUNT];
+        ParsedTopic parsed;
+        char command[64];
+        parse_topic_view(topic, &parsed);
+        topic_level_copy(topic, parsed.command, command, sizeof(command));
+        g_sink += topic_level_is(topic, parsed.target_device, "led") + command[0];
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+static double bench_tokenize_deep(void) {
+    static const char *deep = "site/a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p/q/r/s/t/u/v/w";
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        TopicTokens tokens;
+        g_sink += topic_tokenize(deep, &tokens);
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+int main(void) {
+    // 결과 확인 (두 구현이 같은 단계를 돌려주는지)
+    for (int i = 0; i < BENCH_TOPIC_COUNT; i++) {
+        LegacyParsedTopic legacy = legacy_parse_topic_hierarchy(bench_topics[i]);
+        ParsedTopic parsed;
+        parse_topic_view(bench_topics[i], &parsed);
+        if (!parsed.is_valid || !topic_level_is(bench_topics[i], parsed.command, legacy.command) ||
+            !topic_level_is(bench_topics[i], parsed.target_device, legacy.target_device)) {
+            printf("topic_bench: mismatch on '%s'\n", bench_topics[i]);
+            return 1;
+        }
+    }
+
+    double legacy_ns = bench_legacy();
+    double view_ns = bench_view();
+    double copy_ns = bench_view_with_copy();
+    double deep_ns = bench_tokenize_deep();
+
+    printf("benchmark                    ns/op   speedup\n");
+    printf("topic/legacy_strtok      %10.1f   %6.2fx\n", legacy_ns, 1.0);
+    printf("topic/parse_view         %10.1f   %6.2fx\n", view_ns, legacy_ns / view_ns);
+    printf("topic/parse_view+copy    %10.1f   %6.2fx\n", copy_ns, legacy_ns / copy_ns);
+    printf("topic/tokenize_24_levels %10.1f\n", deep_ns);
+    return 0;
+}
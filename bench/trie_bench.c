@@ -0,0 +1,125 @@
+#include "../src/mqtt.h"
+
+// 토픽 트라이 마이크로벤치마크
+// 필터 5만 개(정확 일치/+/#)를 등록하고, 트라이 매칭과
+// 기존 방식(topic_matches_filter로 모든 필터를 차례로 비교)을 같은 토픽 집합으로 비교
+
+#define BENCH_FILTERS 50000
+#define BENCH_TOPICS 1024
+#define BENCH_ITERATIONS 2000000
+#define BENCH_LINEAR_ITERATIONS 200
+
+static char (*bench_filters)[MAX_TOPIC_LEN];
+static int bench_filter_count = 0;
+static char bench_topics[BENCH_TOPICS][MAX_TOPIC_LEN];
+static volatile int g_sink;
+
+static void bench_route(const char *topic, void *message, void *context) {
+    (void)message;
+    (void)context;
+    g_sink += topic[0];
+}
+
+static uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+// 건물 50 x 층 20 x 디바이스 번호로 필터를 만듦 (70% 정확 일치, 20% +, 10% #)
+static void make_filter(int i, char *buf, size_t size) {
+    int building = i % 50;
+    int floor = (i / 50) % 20;
+    switch (i % 10) {
+    case 7:
+    case 8:
+        snprintf(buf, size, "site/b%02d/+/dev_%05d/+", building, i);
+        break;
+    case 9:
+        snprintf(buf, size, "site/b%02d/f%02d/dev_%05d/#", building, floor, i);
+        break;
+    default:
+        snprintf(buf, size, "site/b%02d/f%02d/dev_%05d/temp", building, floor, i);
+        break;
+    }
+}
+
+static int linear_match(const char *topic) {
+    int matched = 0;
+    for (int i = 0; i < bench_filter_count; i++) {
+        matched += topic_matches_filter(bench_filters[i], topic);
+    }
+    return matched;
+}
+
+static double bench_trie(const TopicTrie *trie) {
+    const TopicRoute *routes[MAX_TOPIC_ROUTES];
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        g_sink += topic_trie_match(trie, bench_topics[i % BENCH_TOPICS], routes, MAX_TOPIC_ROUTES);
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_ITERATIONS;
+}
+
+static double bench_linear(void) {
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_LINEAR_ITERATIONS; i++) {
+        g_sink += linear_match(bench_topics[i % BENCH_TOPICS]);
+    }
+    return (double)(monotonic_time_ns() - start) / BENCH_LINEAR_ITERATIONS;
+}
+
+int main(void) {
+    bench_filters = malloc((size_t)BENCH_FILTERS * MAX_TOPIC_LEN);
+    TopicTrie *trie = topic_trie_create();
+    if (!bench_filters || !trie) {
+        printf("trie_bench: out of memory\n");
+        return 1;
+    }
+
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < BENCH_FILTERS; i++) {
+        make_filter(i, bench_filters[bench_filter_count], MAX_TOPIC_LEN);
+        if (topic_trie_insert(trie, bench_filters[bench_filter_count], bench_route, NULL) != 0) {
+            printf("trie_bench: insert failed for '%s'\n", bench_filters[bench_filter_count]);
+            return 1;
+        }
+        bench_filter_count++;
+    }
+    double insert_ns = (double)(monotonic_time_ns() - start) / BENCH_FILTERS;
+
+    // 등록한 디바이스 토픽 위주로, 일부는 어떤 필터와도 맞지 않게
+    uint32_t seed = 12345;
+    for (int i = 0; i < BENCH_TOPICS; i++) {
+        int device = (int)(bench_rand(&seed) % BENCH_FILTERS);
+        int building = device % 50;
+        int floor = (device / 50) % 20;
+        const char *leaf = (i % 8 == 0) ? "humidity" : "temp";
+        if (i % 16 == 1) {
+            floor = (floor + 1) % 20;   // 층이 틀려 정확/# 필터는 빗나가고 + 필터만 맞음
+        }
+        snprintf(bench_topics[i], MAX_TOPIC_LEN, "site/b%02d/f%02d/dev_%05d/%s", building, floor, device, leaf);
+    }
+
+    // 결과 확인 (트라이와 선형 비교가 같은 수의 필터를 찾는지)
+    for (int i = 0; i < BENCH_TOPICS; i++) {
+        int expected = linear_match(bench_topics[i]);
+        int matched = topic_trie_match(trie, bench_topics[i], NULL, 0);
+        if (matched != expected) {
+            printf("trie_bench: mismatch on '%s' (trie %d, linear %d)\n", bench_topics[i], matched, expected);
+            return 1;
+        }
+    }
+
+    double trie_ns = bench_trie(trie);
+    double linear_ns = bench_linear();
+
+    printf("filters: %d\n", topic_trie_count(trie));
+    printf("benchmark                    ns/op   speedup\n");
+    printf("trie/insert              %10.1f\n", insert_ns);
+    printf("trie/linear_scan         %10.1f   %6.2fx\n", linear_ns, 1.0);
+    printf("trie/match               %10.1f   %6.2fx\n", trie_ns, linear_ns / trie_ns);
+
+    topic_trie_destroy(trie);
+    free(bench_filters);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "../src/mqtt.h"
+
+// 센서 구간 통계 마이크로벤치마크
+// 링 크기를 늘려 가며 샘플 추가 비용, 전체 구간/절반 구간 질의 비용을 재고
+// 같은 구간을 단순 루프로 다시 계산해 결과(평균/최소/최대/표준편차/백분위)를 확인
+
+#define BENCH_PUSHES 4000000
+
+static const int bench_sizes[] = { 1024, 65536, 1 << 20 };
+static volatile double g_sink;
+
+static uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+// 조도 센서처럼 천천히 움직이는 값 + 노이즈 (0-1023)
+static int32_t bench_value(uint32_t *state, int32_t *level) {
+    *level += (int32_t)(bench_rand(state) % 9) - 4;
+    if (*level < 100) *level = 100;
+    if (*level > 900) *level = 900;
+    int32_t value = *level + (int32_t)(bench_rand(state) % 41) - 20;
+    return value < 0 ? 0 : (value > 1023 ? 1023 : value);
+}
+
+static int compare_int32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 단순 계산과 비교 (백분위는 히스토그램 한 칸 폭 안이면 통과)
+static int bench_verify(const int32_t *values, int n, const WindowStats *stats, int32_t *sorted) {
+    double sum = 0.0;
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+    for (int i = 0; i < n; i++) {
+        sum += values[i];
+        min = values[i] < min ? values[i] : min;
+        max = values[i] > max ? values[i] : max;
+    }
+    double mean = sum / n;
+    double var = 0.0;
+    for (int i = 0; i < n; i++) {
+        var += (values[i] - mean) * (values[i] - mean);
+    }
+    double stddev = sqrt(var / n);
+
+    memcpy(sorted, values, (size_t)n * sizeof(int32_t));
+    qsort(sorted, (size_t)n, sizeof(int32_t), compare_int32);
+    double p50 = sorted[(int)(0.50 * (n - 1))];
+    double p99 = sorted[(int)(0.99 * (n - 1))];
+    double width = 1024.0 / SAMPLE_WINDOW_BUCKETS;
+
+    return stats->count == n && stats->min == min && stats->max == max &&
+           fabs(stats->mean - mean) < 1e-6 && fabs(stats->stddev - stddev) < 1e-6 &&
+           fabs(stats->p50 - p50) <= width && fabs(stats->p99 - p99) <= width;
+}
+
+// 질의 한 번의 평균 시간 (ns)
+static double bench_query(const SampleWindow *w, uint64_t window_ms, uint64_t now_ms, int iterations) {
+    WindowStats stats;
+    uint64_t start = monotonic_time_ns();
+    for (int i = 0; i < iterations; i++) {
+        sample_window_stats(w, window_ms, now_ms, &stats);
+        g_sink += stats.mean;
+    }
+    return (double)(monotonic_time_ns() - start) / iterations;
+}
+
+int main(void) {
+    printf("window      push ns   all ns    half ns   half Msamples/s   check\n");
+    int failures = 0;
+    for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+        int size = bench_sizes[s];
+        SampleWindow *w = sample_window_create(size, 0, 1023);
+        int32_t *history = malloc((size_t)size * sizeof(int32_t));
+        int32_t *sorted = malloc((size_t)size * sizeof(int32_t));
+        if (!w || !history || !sorted) {
+            printf("window_bench: out of memory at %d samples\n", size);
+            return 1;
+        }
+
+        // 1ms 간격 샘플을 링이 여러 번 돌 만큼 넣음 (마지막 size개를 따로 보관해 확인에 씀)
+        uint32_t seed = 12345;
+        int32_t level = 512;
+        int pushes = BENCH_PUSHES > size * 4 ? BENCH_PUSHES : size * 4;
+        uint64_t start = monotonic_time_ns();
+        for (int i = 0; i < pushes; i++) {
+            int32_t value = bench_value(&seed, &level);
+            sample_window_push(w, value, (uint64_t)i);
+            history[i & (size - 1)] = value;
+        }
+        double push_ns = (double)(monotonic_time_ns() - start) / pushes;
+        uint64_t now_ms = (uint64_t)pushes - 1;
+
+        // history를 오래된 순서로 정렬한 뒤 전체/절반 구간 확인
+        int32_t *ordered = malloc((size_t)size * sizeof(int32_t));
+        if (!ordered) {
+            return 1;
+        }
+        for (int i = 0; i < size; i++) {
+            ordered[i] = history[(pushes + i) & (size - 1)];
+        }
+        WindowStats all;
+        WindowStats half;
+        sample_window_stats(w, 0, now_ms, &all);
+        sample_window_stats(w, (uint64_t)size / 2 - 1, now_ms, &half);
+        int ok = bench_verify(ordered, size, &all, sorted) &&
+                 bench_verify(ordered + size / 2, size / 2, &half, sorted);
+        failures += !ok;
+
+        int iterations = size >= (1 << 20) ? 50 : (size >= 65536 ? 2000 : 200000);
+        double all_ns = bench_query(w, 0, now_ms, iterations);
+        double half_ns = bench_query(w, (uint64_t)size / 2 - 1, now_ms, iterations);
+        printf("%7d   %8.1f  %8.0f  %9.0f   %15.0f   %s\n", size, push_ns, all_ns, half_ns,
+               (size / 2) / half_ns * 1000.0, ok ? "ok" : "MISMATCH");
+
+        free(ordered);
+        free(sorted);
+        free(history);
+        free(w);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -1,6 +1,19 @@
 #include "../mqtt.h"
 
 static int g_msg_queue_id = -1;
+static int g_event_fd = -1;  // 메시지 도착 알림용 eventfd (fork 시 상속)
+static ShmRing *g_rings[IPC_LANE_COUNT];  // 레인별 공유 메모리 링 (NULL이면 msgsnd 경로 사용)
+static int g_ring_enabled = 0;
+
+// msgqueue 경로용 수신 버퍼와 카운터 (프로세스별)
+static control_message_t g_recv_msg;
+static uint64_t g_mq_enqueued = 0;
+static uint64_t g_mq_dequeued = 0;
+static uint64_t g_mq_dropped = 0;
+static uint64_t g_mq_lane_dropped[IPC_LANE_COUNT];
+
+// 레인별 대기 지연 통계 (수신측에서 기록)
+static IPCLaneStats g_lane_stats[IPC_LANE_COUNT];
 
 // IPC 초기화
 int ipc_init(void) {
@@ -9,78 +22,289 @@ int ipc_init(void) {
         perror("ftok failed");
         return -1;
     }
-    
+
     g_msg_queue_id = msgget(key, IPC_CREAT | 0666);
     if (g_msg_queue_id == -1) {
         perror("msgget failed");
         return -1;
     }
-    
-    printf("IPC: Message queue initialized (ID: %d)\n", g_msg_queue_id);
+
+    // SysV 메시지 큐는 epoll로 감시할 수 없으므로 eventfd로 도착을 알림
+    g_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_event_fd == -1) {
+        perror("eventfd failed");
+        msgctl(g_msg_queue_id, IPC_RMID, NULL);
+        return -1;
+    }
+
+    log_info("IPC: Message queue initialized (ID: %d)", g_msg_queue_id);
     return g_msg_queue_id;
 }
 
+// 공유 메모리 링 활성화 (fork 전에 호출, 실패 시 msgsnd 경로 유지)
+// 레인마다 링을 하나씩 두어 낮은 우선순위 명령이 높은 레인을 막지 않도록 함
+int ipc_enable_shm_ring(size_t capacity) {
+    if (g_ring_enabled) {
+        return 0;
+    }
+
+    for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+        g_rings[lane] = shm_ring_create(capacity);
+        if (!g_rings[lane]) {
+            for (int i = 0; i < lane; i++) {
+                shm_ring_destroy(g_rings[i]);
+                g_rings[i] = NULL;
+            }
+            log_warn("IPC: Shared ring unavailable, falling back to message queue");
+            return -1;
+        }
+    }
+    g_ring_enabled = 1;
+
+    IPCStats stats;
+    shm_ring_get_stats(g_rings[0], &stats);
+    log_info("IPC: Shared memory rings initialized (%d lanes x %llu bytes)",
+             IPC_LANE_COUNT, (unsigned long long)stats.capacity_bytes);
+    return 0;
+}
+
 // IPC 정리
 void ipc_cleanup(int msg_queue_id) {
     if (msg_queue_id != -1) {
         if (msgctl(msg_queue_id, IPC_RMID, NULL) == -1) {
             perror("msgctl IPC_RMID failed");
         } else {
-            printf("IPC: Message queue cleaned up\n");
+            log_info("IPC: Message queue cleaned up");
         }
     }
+    if (g_event_fd != -1) {
+        close(g_event_fd);
+        g_event_fd = -1;
+    }
+    if (g_ring_enabled) {
+        for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+            shm_ring_destroy(g_rings[lane]);
+            g_rings[lane] = NULL;
+        }
+        g_ring_enabled = 0;
+    }
 }
 
-// 제어 메시지 전송
-int ipc_send_control_message(int msg_queue_id, const char *topic, const char *payload) {
-    if (msg_queue_id == -1 || !topic || !payload) {
-        return -1;
-    }
-    
+// 메시지 도착 알림용 eventfd 반환 (Publisher 리액터에 등록)
+int ipc_get_event_fd(void) {
+    return g_event_fd;
+}
+
+// msgsnd 경로 전송 (페이로드는 MAX_STRING_LEN으로 잘림)
+static int ipc_send_msgqueue(int msg_queue_id, int lane, const char *topic, const char *payload, int payload_len) {
     control_message_t msg;
-    msg.msg_type = 1;
-    
+    msg.msg_type = lane + 1;
+    msg.enqueue_ns = monotonic_time_ns();
+
     // 토픽 복사 (길이 체크)
     strncpy(msg.topic, topic, sizeof(msg.topic) - 1);
     msg.topic[sizeof(msg.topic) - 1] = '\0';
-    
+
     // 페이로드 복사 (길이 체크)
-    strncpy(msg.payload, payload, sizeof(msg.payload) - 1);
-    msg.payload[sizeof(msg.payload) - 1] = '\0';
-    
+    if (payload_len >= (int)sizeof(msg.payload)) {
+        log_warn("IPC: Payload truncated from %d to %d bytes (message queue transport)",
+                 payload_len, (int)sizeof(msg.payload) - 1);
+        payload_len = sizeof(msg.payload) - 1;
+    }
+    memcpy(msg.payload, payload, payload_len);
+    msg.payload[payload_len] = '\0';
+    msg.payload_len = payload_len;
+
     if (msgsnd(msg_queue_id, &msg, sizeof(msg) - sizeof(long), IPC_NOWAIT) == -1) {
         if (errno != EAGAIN) {  // 큐가 가득 찬 경우가 아니면 에러 출력
             perror("IPC: msgsnd failed");
         }
+        g_mq_dropped++;
+        g_mq_lane_dropped[lane]++;
         return -1;
     }
-    
-    printf("IPC: Control message sent - Topic: %s\n", topic);
+    g_mq_enqueued++;
+    return 0;
+}
+
+// 제어 메시지 전송 (공유 링 우선, 없으면 메시지 큐)
+int ipc_send_control_message(int msg_queue_id, int lane, const char *topic, const char *payload, int payload_len) {
+    if (!topic || !payload || payload_len < 0) {
+        return -1;
+    }
+    if (lane < 0 || lane >= IPC_LANE_COUNT) {
+        lane = IPC_LANE_NORMAL;
+    }
+
+    if (g_ring_enabled) {
+        if (shm_ring_push(g_rings[lane], topic, strlen(topic), payload, payload_len,
+                          monotonic_time_ns()) != 0) {
+            log_warn("IPC: Shared ring full (%s lane), control message dropped - Topic: %s",
+                     priority_lane_name(lane), topic);
+            return -1;
+        }
+    } else {
+        if (msg_queue_id == -1 || ipc_send_msgqueue(msg_queue_id, lane, topic, payload, payload_len) != 0) {
+            return -1;
+        }
+    }
+
+    // 수신측 리액터 깨우기
+    if (g_event_fd != -1) {
+        uint64_t one = 1;
+        if (write(g_event_fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+            perror("IPC: eventfd write failed");
+        }
+    }
+
+    log_debug("IPC: Control message sent - Topic: %s", topic);
     return 0;
 }
 
-// 제어 메시지 수신
+// 제어 메시지 수신 (메시지 큐 전용, 호출자 버퍼로 복사)
 int ipc_receive_control_message(int msg_queue_id, char *topic, char *payload, size_t payload_size) {
     if (msg_queue_id == -1 || !topic || !payload) {
         return -1;
     }
-    
+
     control_message_t msg;
-    ssize_t result = msgrcv(msg_queue_id, &msg, sizeof(msg) - sizeof(long), 1, IPC_NOWAIT);
+    ssize_t result = msgrcv(msg_queue_id, &msg, sizeof(msg) - sizeof(long), -IPC_LANE_COUNT, IPC_NOWAIT);
     if (result == -1) {
         if (errno != ENOMSG) {  // 메시지가 없는 경우가 아니면 에러 출력
             perror("IPC: msgrcv failed");
         }
         return -1;
     }
-    
+    g_mq_dequeued++;
+
     // 받은 토픽과 페이로드 복사
     strncpy(topic, msg.topic, MAX_TOPIC_LEN - 1);
     topic[MAX_TOPIC_LEN - 1] = '\0';
-    
+
     strncpy(payload, msg.payload, payload_size - 1);
     payload[payload_size - 1] = '\0';
-    
-    printf("IPC: Control message received - Topic: %s\n", msg.topic);
+
+    log_debug("IPC: Control message received - Topic: %s", msg.topic);
     return 0;
-}
\ No newline at end of file
+}
+
+// 레인별 대기 시간 기록
+static void ipc_record_wait(int lane, uint64_t enqueue_ns) {
+    IPCLaneStats *stats = &g_lane_stats[lane];
+    uint64_t now = monotonic_time_ns();
+    uint64_t wait_ns = now > enqueue_ns ? now - enqueue_ns : 0;
+
+    stats->received++;
+    stats->total_wait_ns += wait_ns;
+    metrics_record(METRIC_STAGE_IPC_WAIT, wait_ns);
+    if (wait_ns > stats->max_wait_ns) {
+        stats->max_wait_ns = wait_ns;
+    }
+}
+
+// 제어 메시지 조회 (높은 레인부터, 공유 링이면 복사 없이 링 메모리를 가리킴)
+// 처리 후 반드시 ipc_release_control_view 호출
+int ipc_receive_control_view(int msg_queue_id, IPCRecordView *view) {
+    if (!view) {
+        return -1;
+    }
+
+    if (g_ring_enabled) {
+        int lane;
+        for (lane = 0; lane < IPC_LANE_COUNT; lane++) {
+            if (shm_ring_peek(g_rings[lane], view) == 0) {
+                break;
+            }
+        }
+        if (lane == IPC_LANE_COUNT) {
+            return -1;
+        }
+        view->lane = lane;
+    } else {
+        if (msg_queue_id == -1) {
+            return -1;
+        }
+        // 음수 타입: 타입 번호가 가장 작은(우선순위 높은) 메시지부터 수신
+        ssize_t result = msgrcv(msg_queue_id, &g_recv_msg, sizeof(g_recv_msg) - sizeof(long),
+                                -IPC_LANE_COUNT, IPC_NOWAIT);
+        if (result == -1) {
+            if (errno != ENOMSG) {
+                perror("IPC: msgrcv failed");
+            }
+            return -1;
+        }
+        g_mq_dequeued++;
+        g_recv_msg.topic[sizeof(g_recv_msg.topic) - 1] = '\0';
+        g_recv_msg.payload[sizeof(g_recv_msg.payload) - 1] = '\0';
+        view->topic = g_recv_msg.topic;
+        view->topic_len = (int)strlen(g_recv_msg.topic);
+        view->payload = g_recv_msg.payload;
+        view->payload_len = g_recv_msg.payload_len >= 0 && g_recv_msg.payload_len < (int)sizeof(g_recv_msg.payload) ?
+                            g_recv_msg.payload_len : (int)strlen(g_recv_msg.payload);
+        view->lane = (int)g_recv_msg.msg_type - 1;
+        view->stamp = g_recv_msg.enqueue_ns;
+        view->release_pos = 0;
+    }
+
+    ipc_record_wait(view->lane, view->stamp);
+    log_debug("IPC: Control message received (%s lane) - Topic: %s",
+              priority_lane_name(view->lane), view->topic);
+    return 0;
+}
+
+// 조회한 제어 메시지 반환
+void ipc_release_control_view(const IPCRecordView *view) {
+    if (g_ring_enabled && view) {
+        shm_ring_release(g_rings[view->lane], view);
+    }
+}
+
+// 큐 깊이/드롭 통계 조회 (모든 레인 합계)
+void ipc_get_stats(int msg_queue_id, IPCStats *stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(IPCStats));
+
+    if (g_ring_enabled) {
+        for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+            IPCStats lane_stats;
+            shm_ring_get_stats(g_rings[lane], &lane_stats);
+            stats->enqueued += lane_stats.enqueued;
+            stats->dequeued += lane_stats.dequeued;
+            stats->dropped += lane_stats.dropped;
+            stats->depth_messages += lane_stats.depth_messages;
+            stats->depth_bytes += lane_stats.depth_bytes;
+            stats->capacity_bytes += lane_stats.capacity_bytes;
+        }
+        return;
+    }
+
+    // 메시지 큐 경로: 카운터는 프로세스별, 깊이는 커널에서 조회
+    stats->enqueued = g_mq_enqueued;
+    stats->dequeued = g_mq_dequeued;
+    stats->dropped = g_mq_dropped;
+    struct msqid_ds ds;
+    if (msg_queue_id != -1 && msgctl(msg_queue_id, IPC_STAT, &ds) == 0) {
+        stats->depth_messages = ds.msg_qnum;
+        stats->depth_bytes = ds.__msg_cbytes;
+        stats->capacity_bytes = ds.msg_qbytes;
+    }
+}
+
+// 레인별 지연/드롭 통계 조회
+// 지연은 수신 프로세스 기준, 드롭은 공유 링이면 전체, 메시지 큐면 송신 프로세스 기준
+void ipc_get_lane_stats(int lane, IPCLaneStats *stats) {
+    if (!stats || lane < 0 || lane >= IPC_LANE_COUNT) {
+        return;
+    }
+    *stats = g_lane_stats[lane];
+
+    if (g_ring_enabled) {
+        IPCStats ring_stats;
+        shm_ring_get_stats(g_rings[lane], &ring_stats);
+        stats->dropped = ring_stats.dropped;
+    } else {
+        stats->dropped = g_mq_lane_dropped[lane];
+    }
+}
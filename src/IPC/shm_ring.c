@@ -0,0 +1,155 @@
+#include "../mqtt.h"
+#include <sys/mman.h>
+
+// 레코드 헤더 (레코드는 16바이트 정렬, 뒤에 topic\0 payload\0 가 이어짐)
+// 패딩 레코드는 size/flags만 사용하므로 링 끝에 16바이트만 남아도 기록 가능
+typedef struct {
+    uint32_t size;          // 패딩 포함 레코드 전체 크기
+    uint32_t flags;         // SHM_RECORD_PAD 이면 링 끝 패딩 레코드
+    uint32_t topic_len;
+    uint32_t payload_len;
+    uint64_t stamp;         // 송신측이 기록한 값 (enqueue 시각 등)
+} ShmRecordHeader;
+
+#define SHM_RECORD_ALIGN 16
+#define SHM_RECORD_PAD 0x1u
+
+// fork() 전후로 공유되는 링 헤더 (producer/consumer 필드를 캐시라인 분리)
+struct ShmRing {
+    uint64_t head;                  // producer 쓰기 위치 (누적 바이트)
+    uint64_t enqueued;
+    uint64_t dropped;
+    char pad_producer[40];
+    uint64_t tail;                  // consumer 읽기 위치 (누적 바이트)
+    uint64_t dequeued;
+    char pad_consumer[48];
+    uint64_t capacity;              // 데이터 영역 크기 (2의 거듭제곱)
+    size_t mapped_size;
+    char pad_const[48];
+    unsigned char data[];
+};
+
+static size_t shm_record_size(size_t topic_len, size_t payload_len) {
+    size_t size = sizeof(ShmRecordHeader) + topic_len + 1 + payload_len + 1;
+    return (size + SHM_RECORD_ALIGN - 1) & ~(size_t)(SHM_RECORD_ALIGN - 1);
+}
+
+// 공유 링 생성 (fork 전에 호출해야 양쪽 프로세스가 같은 메모리를 봄)
+ShmRing *shm_ring_create(size_t capacity) {
+    // 용량을 2의 거듭제곱으로 올림
+    size_t cap = 4096;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    size_t mapped_size = sizeof(ShmRing) + cap;
+    void *mem = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("IPC: mmap for shared ring failed");
+        return NULL;
+    }
+
+    ShmRing *ring = mem;
+    memset(ring, 0, sizeof(ShmRing));
+    ring->capacity = cap;
+    ring->mapped_size = mapped_size;
+    return ring;
+}
+
+// 공유 링 해제
+void shm_ring_destroy(ShmRing *ring) {
+    if (ring) {
+        munmap(ring, ring->mapped_size);
+    }
+}
+
+// 레코드 추가 (단일 producer 전용). 공간이 없으면 버리고 drop 카운트 증가
+int shm_ring_push(ShmRing *ring, const char *topic, size_t topic_len,
+                  const char *payload, size_t payload_len, uint64_t stamp) {
+    size_t rec_size = shm_record_size(topic_len, payload_len);
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t offset = head & (ring->capacity - 1);
+    uint64_t contiguous = ring->capacity - offset;
+
+    // 링 끝에 연속 공간이 부족하면 패딩 레코드를 쓰고 처음으로 감음
+    uint64_t needed = rec_size;
+    if (contiguous < rec_size) {
+        needed += contiguous;
+    }
+    if (rec_size > ring->capacity / 2 || ring->capacity - (head - tail) < needed) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    if (contiguous < rec_size) {
+        ShmRecordHeader *pad = (ShmRecordHeader *)(ring->data + offset);
+        pad->size = (uint32_t)contiguous;
+        pad->flags = SHM_RECORD_PAD;
+        head += contiguous;
+        offset = 0;
+    }
+
+    ShmRecordHeader *rec = (ShmRecordHeader *)(ring->data + offset);
+    char *body = (char *)(rec + 1);
+    rec->size = (uint32_t)rec_size;
+    rec->flags = 0;
+    rec->topic_len = (uint32_t)topic_len;
+    rec->payload_len = (uint32_t)payload_len;
+    rec->stamp = stamp;
+    memcpy(body, topic, topic_len);
+    body[topic_len] = '\0';
+    memcpy(body + topic_len + 1, payload, payload_len);
+    body[topic_len + 1 + payload_len] = '\0';
+
+    // 레코드 내용이 보인 뒤에 head가 갱신되도록 release
+    __atomic_store_n(&ring->head, head + rec_size, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->enqueued, ring->enqueued + 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// 다음 레코드를 복사 없이 조회 (단일 consumer 전용). 없으면 -1
+int shm_ring_peek(ShmRing *ring, IPCRecordView *view) {
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    while (tail != head) {
+        ShmRecordHeader *rec = (ShmRecordHeader *)(ring->data + (tail & (ring->capacity - 1)));
+        if (rec->flags & SHM_RECORD_PAD) {
+            tail += rec->size;
+            continue;
+        }
+
+        const char *body = (const char *)(rec + 1);
+        view->topic = body;
+        view->topic_len = (int)rec->topic_len;
+        view->payload = body + rec->topic_len + 1;
+        view->payload_len = (int)rec->payload_len;
+        view->stamp = rec->stamp;
+        view->release_pos = tail + rec->size;
+        return 0;
+    }
+    return -1;
+}
+
+// peek한 레코드 반환 (이후 view의 포인터는 사용 불가)
+void shm_ring_release(ShmRing *ring, const IPCRecordView *view) {
+    __atomic_store_n(&ring->tail, view->release_pos, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->dequeued, ring->dequeued + 1, __ATOMIC_RELAXED);
+}
+
+// 큐 깊이/드롭 통계 조회 (어느 프로세스에서나 호출 가능)
+void shm_ring_get_stats(ShmRing *ring, IPCStats *stats) {
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint64_t enqueued = __atomic_load_n(&ring->enqueued, __ATOMIC_RELAXED);
+    uint64_t dequeued = __atomic_load_n(&ring->dequeued, __ATOMIC_RELAXED);
+
+    stats->enqueued = enqueued;
+    stats->dequeued = dequeued;
+    stats->dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    stats->depth_messages = enqueued >= dequeued ? enqueued - dequeued : 0;
+    stats->depth_bytes = head - tail;
+    stats->capacity_bytes = ring->capacity;
+}
@@ -1,48 +1,73 @@
 #include "../mqtt.h"
 
-// 버저 제어 함수
-void handle_buzzer(const char *command) {
-    printf("[BUZZER] Command received: %s\n", command);
-    
-    // 실제 제어 로직
-    if (strcmp(command, "on") == 0) {
-        buzzer_control(1);
-        printf("[BUZZER] Turned ON\n");
-    } else if (strcmp(command, "off") == 0) {
-        buzzer_control(0);
-        printf("[BUZZER] Turned OFF\n");
-    } else if (strcmp(command, "beep") == 0) {
-        // 짧은 비프음
-        buzzer_control(1);
-        usleep(500000); // 0.5초
-        buzzer_control(0);
-        printf("[BUZZER] Beeped\n");
+// 결과를 pub_message_handler의 send_result_to_topic으로 전송
+static void buzzer_report(const char *command, int success) {
+    ResultBuilder rb;
+    result_begin(&rb, "buzzer", command);
+    if (success) {
+        result_add_str(&rb, "status", "success");
     } else {
-        printf("[BUZZER] Invalid command: %s\n", command);
+        result_add_str(&rb, "status", "error");
+        result_add_str(&rb, "message", "invalid command");
     }
-    
-    char topic[MAX_TOPIC_LEN];
-    char result[MAX_STRING_LEN];
-    
-    snprintf(topic, sizeof(topic), "status/raspberry_001/buzzer/return");
-    
-    if (strcmp(command, "on") == 0 || strcmp(command, "off") == 0 || strcmp(command, "beep") == 0) {
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"buzzer\",\"command\":\"%s\",\"status\":\"success\",\"timestamp\":%ld}", 
-                 command, time(NULL));
-    } else {
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"buzzer\",\"command\":\"%s\",\"status\":\"error\",\"message\":\"invalid command\",\"timestamp\":%ld}", 
-                 command, time(NULL));
+    result_publish(&rb, "buzzer");
+}
+
+// 실제 디바이스면 GPIO를 구동하고, 가상 디바이스는 상태만 바꿈
+static void buzzer_set(VirtualDevice *device, int on_off) {
+    if (device->physical) {
+        buzzer_control(on_off);
     }
-    
-    send_result_to_topic(topic, result);
+    device->buzzer_on = (uint8_t)on_off;
+}
+
+static void buzzer_on(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[BUZZER] %s command received: %s", device->id, command);
+    buzzer_set(device, 1);
+    log_info("[BUZZER] %s turned ON", device->id);
+    buzzer_report(command, 1);
+}
+
+static void buzzer_off(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[BUZZER] %s command received: %s", device->id, command);
+    buzzer_set(device, 0);
+    log_info("[BUZZER] %s turned OFF", device->id);
+    buzzer_report(command, 1);
+}
+
+// 짧은 비프음 (가상 디바이스는 기다리지 않아 같은 실행기의 다른 디바이스를 막지 않음)
+static void buzzer_beep(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[BUZZER] %s command received: %s", device->id, command);
+    buzzer_set(device, 1);
+    if (device->physical) {
+        usleep(500000); // 0.5초
+    }
+    buzzer_set(device, 0);
+    log_info("[BUZZER] %s beeped", device->id);
+    buzzer_report(command, 1);
 }
 
+static void buzzer_invalid(const char *command) {
+    log_warn("[BUZZER] Invalid command: %s", command);
+    buzzer_report(command, 0);
+}
+
+// 버저 명령 테이블
+static const DispatchEntry buzzer_commands[] = {
+    { "buzzer", "on", buzzer_on, 0 },
+    { "buzzer", "off", buzzer_off, 0 },
+    { "buzzer", "beep", buzzer_beep, 0 },
+    { "buzzer", DISPATCH_ANY_COMMAND, buzzer_invalid, 0 },
+};
+DISPATCH_MODULE(buzzer_commands)
+
 // 실제 부저 제어 함수 (하드웨어 인터페이스)
 void buzzer_control(int on_off) {
     // TODO: 실제 GPIO 제어 코드 구현
-    printf("[HW] Buzzer GPIO control: %s\n", on_off ? "HIGH" : "LOW");
+    log_debug("[HW] Buzzer GPIO control: %s", on_off ? "HIGH" : "LOW");
     
     // 실제 구현 시 추가될 코드:
     // - GPIO 라이브러리 초기화
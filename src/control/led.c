@@ -1,44 +1,60 @@
 #include "../mqtt.h"
 
-// LED 제어를 위한 함수
-void handle_led(const char *command) {
-    printf("[LED] Command received: %s\n", command);
-    
-    // 실제 제어 로직
-    if (strcmp(command, "on") == 0) {
-        led_control(1);
-        printf("[LED] Turned ON\n");
-    } else if (strcmp(command, "off") == 0) {
-        led_control(0);
-        printf("[LED] Turned OFF\n");
+// 결과를 pub_message_handler의 send_result_to_topic으로 전송
+static void led_report(const char *command, int success) {
+    ResultBuilder rb;
+    result_begin(&rb, "led", command);
+    if (success) {
+        result_add_str(&rb, "status", "success");
     } else {
-        printf("[LED] Invalid command: %s\n", command);
+        result_add_str(&rb, "status", "error");
+        result_add_str(&rb, "message", "invalid command");
     }
-    
-    // 결과를 pub_message_handler의 send_result_to_topic으로 전송
-    char topic[MAX_TOPIC_LEN];
-    char result[MAX_STRING_LEN];
-    
-    snprintf(topic, sizeof(topic), "status/raspberry_001/led/return");
-    
-    if (strcmp(command, "on") == 0 || strcmp(command, "off") == 0) {
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"led\",\"command\":\"%s\",\"status\":\"success\",\"timestamp\":%ld}", 
-                 command, time(NULL));
-    } else {
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"led\",\"command\":\"%s\",\"status\":\"error\",\"message\":\"invalid command\",\"timestamp\":%ld}", 
-                 command, time(NULL));
+    result_publish(&rb, "led");
+}
+
+// 실제 디바이스면 GPIO를 구동하고, 가상 디바이스는 상태만 바꿈
+static void led_set(VirtualDevice *device, int on_off) {
+    if (device->physical) {
+        led_control(on_off);
     }
-    
-    send_result_to_topic(topic, result);
+    device->led_on = (uint8_t)on_off;
 }
 
+static void led_on(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[LED] %s command received: %s", device->id, command);
+    led_set(device, 1);
+    log_info("[LED] %s turned ON", device->id);
+    led_report(command, 1);
+}
+
+static void led_off(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[LED] %s command received: %s", device->id, command);
+    led_set(device, 0);
+    log_info("[LED] %s turned OFF", device->id);
+    led_report(command, 1);
+}
+
+static void led_invalid(const char *command) {
+    log_warn("[LED] Invalid command: %s", command);
+    led_report(command, 0);
+}
+
+// LED 명령 테이블
+static const DispatchEntry led_commands[] = {
+    { "led", "on", led_on, 0 },
+    { "led", "off", led_off, 0 },
+    { "led", DISPATCH_ANY_COMMAND, led_invalid, 0 },
+};
+DISPATCH_MODULE(led_commands)
+
 // 실제 LED 제어 함수 (하드웨어 인터페이스)
 void led_control(int on_off) {
     // TODO: 실제 GPIO 제어 코드 구현
     // 예시: GPIO 핀 제어
-    printf("[HW] LED GPIO control: %s\n", on_off ? "HIGH" : "LOW");
+    log_debug("[HW] LED GPIO control: %s", on_off ? "HIGH" : "LOW");
     
     // 실제 구현 시 추가될 코드:
     // - GPIO 라이브러리 초기화
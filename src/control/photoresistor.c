@@ -1,53 +1,341 @@
 #include "../mqtt.h"
 
-// 포토레지스터 제어 함수
-void handle_photoresistor(const char *command) {
-    printf("[PHOTORESISTOR] Command received: %s\n", command);
+#define CALIBRATE_SAMPLES 10
+#define CALIBRATE_INTERVAL_MS 100
+
+static int g_window_capacity = SAMPLE_WINDOW_DEFAULT_CAPACITY;
+
+static uint64_t monotonic_time_ms(void) {
+    return monotonic_time_ns() / 1000000ULL;
+}
+
+// 조도를 읽어 디바이스의 샘플 링에 넣음 (read, calibrate, 스트리밍 샘플이 모두 이 경로로 읽음)
+// 링은 처음 읽을 때 할당하고, 같은 디바이스의 포토레지스터 명령은 한 샤드 워커에서만 돌므로 잠금 없음
+static int photoresistor_sample(VirtualDevice *device) {
+    int value = photoresistor_read(device);
+    if (!device->light_window) {
+        device->light_window = sample_window_create(g_window_capacity, 0, 1023);
+    }
+    if (device->light_window) {
+        sample_window_push(device->light_window, value, monotonic_time_ms());
+    }
+    return value;
+}
+
+// 현재 조도 값 읽기 (read, value)
+static void photoresistor_read_command(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[PHOTORESISTOR] %s command received: %s", device->id, command);
     
-    char topic[MAX_TOPIC_LEN];
-    char result[MAX_STRING_LEN];
-    int sensor_value = 0;
+    int sensor_value = photoresistor_sample(device);
+    log_info("[PHOTORESISTOR] %s read value: %d", device->id, sensor_value);
+    
+    ResultBuilder rb;
+    result_begin(&rb, "photoresistor", command);
+    result_add_int(&rb, "value", sensor_value);
+    result_add_str(&rb, "status", "success");
+    result_publish(&rb, "photoresistor");
+}
+
+// 센서 캘리브레이션 (최근 1초 안의 샘플이 충분하면 링에서 바로 계산,
+// 아니면 100ms 간격으로 10번 읽음. 가상 디바이스는 간격 없이 읽음)
+static void photoresistor_calibrate(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[PHOTORESISTOR] %s command received: %s", device->id, command);
     
-    // 실제 제어 로직
-    if (strcmp(command, "read") == 0 || strcmp(command, "value") == 0) {
-        sensor_value = photoresistor_read();
-        printf("[PHOTORESISTOR] Read value: %d\n", sensor_value);
-        
-        snprintf(topic, sizeof(topic), "status/raspberry_001/photoresistor/return");
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"photoresistor\",\"command\":\"%s\",\"value\":%d,\"status\":\"success\",\"timestamp\":%ld}", 
-                 command, sensor_value, time(NULL));
-    } 
-    else if (strcmp(command, "calibrate") == 0) {
-        // 센서 캘리브레이션 (여러 번 읽어서 평균값 계산)
-        int sum = 0;
-        int samples = 10;
-        for (int i = 0; i < samples; i++) {
-            sum += photoresistor_read();
-            usleep(100000); // 100ms 간격
+    WindowStats stats;
+    const char *source = "window";
+    if (sample_window_stats(device->light_window, CALIBRATE_SAMPLES * CALIBRATE_INTERVAL_MS,
+                            monotonic_time_ms(), &stats) < CALIBRATE_SAMPLES) {
+        source = "sampled";
+        for (int i = 0; i < CALIBRATE_SAMPLES; i++) {
+            photoresistor_sample(device);
+            if (device->physical && i + 1 < CALIBRATE_SAMPLES) {
+                usleep(CALIBRATE_INTERVAL_MS * 1000);
+            }
         }
-        sensor_value = sum / samples;
-        printf("[PHOTORESISTOR] Calibrated average value: %d\n", sensor_value);
-        
-        snprintf(topic, sizeof(topic), "status/raspberry_001/photoresistor/return");
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"photoresistor\",\"command\":\"%s\",\"calibrated_value\":%d,\"samples\":%d,\"status\":\"success\",\"timestamp\":%ld}", 
-                 command, sensor_value, samples, time(NULL));
-    }
-    else {
-        printf("[PHOTORESISTOR] Invalid command: %s\n", command);
-        
-        snprintf(topic, sizeof(topic), "status/raspberry_001/photoresistor/return");
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"photoresistor\",\"command\":\"%s\",\"status\":\"error\",\"message\":\"invalid command\",\"timestamp\":%ld}", 
-                 command, time(NULL));
+        sample_window_stats_last(device->light_window, CALIBRATE_SAMPLES, &stats);
     }
+    int sensor_value = (int)(stats.mean + 0.5);
+    log_info("[PHOTORESISTOR] %s calibrated average value: %d (%s, %d samples)", device->id, sensor_value,
+             source, stats.count);
     
-    send_result_to_topic(topic, result);
+    ResultBuilder rb;
+    result_begin(&rb, "photoresistor", command);
+    result_add_int(&rb, "calibrated_value", sensor_value);
+    result_add_int(&rb, "samples", stats.count);
+    result_add_int(&rb, "min", stats.min);
+    result_add_int(&rb, "max", stats.max);
+    result_add_double(&rb, "stddev", stats.stddev);
+    result_add_str(&rb, "source", source);
+    result_add_str(&rb, "status", "success");
+    result_publish(&rb, "photoresistor");
 }
 
+// 구간 통계 조회: stats (링 전체), stats?window=60s (최근 60초, ms/s/m/h 또는 all)
+// 다시 읽지 않고 링에 쌓인 샘플로 바로 답함 (링은 read/calibrate/stream 샘플로 채워짐)
+static void photoresistor_stats(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[PHOTORESISTOR] %s command received: %s", device->id, command);
+
+    ResultBuilder rb;
+    result_begin(&rb, "photoresistor", command);
+    long window_ms = 0;
+    const char *query = strchr(command, '?');
+    while (query && *query) {
+        const char *param = query + 1;
+        size_t param_len = strcspn(param, "&");
+        if (param_len > 7 && memcmp(param, "window=", 7) == 0) {
+            window_ms = sample_window_parse_duration(param + 7, param_len - 7);
+        } else if (param_len > 0) {
+            window_ms = -1;
+        }
+        if (window_ms < 0) {
+            log_warn("[PHOTORESISTOR] %s invalid stats query: %s", device->id, command);
+            result_add_str(&rb, "status", "error");
+            result_add_str(&rb, "message", "invalid query (expected window=<N>ms|s|m|h or all)");
+            result_publish(&rb, "photoresistor");
+            return;
+        }
+        query = param + param_len;
+    }
+
+    WindowStats stats;
+    result_add_int(&rb, "window_ms", window_ms);
+    if (sample_window_stats(device->light_window, (uint64_t)window_ms, monotonic_time_ms(), &stats) == 0) {
+        result_add_int(&rb, "count", 0);
+        result_add_str(&rb, "status", "no_samples");
+        result_publish(&rb, "photoresistor");
+        return;
+    }
+    result_add_int(&rb, "count", stats.count);
+    result_add_int(&rb, "span_ms", (long)stats.span_ms);
+    result_add_double(&rb, "mean", stats.mean);
+    result_add_int(&rb, "min", stats.min);
+    result_add_int(&rb, "max", stats.max);
+    result_add_double(&rb, "stddev", stats.stddev);
+    result_add_double(&rb, "ewma", stats.ewma);
+    result_add_double(&rb, "p50", stats.p50);
+    result_add_double(&rb, "p90", stats.p90);
+    result_add_double(&rb, "p99", stats.p99);
+    result_add_int(&rb, "last", stats.last);
+    result_add_str(&rb, "status", "success");
+    result_publish(&rb, "photoresistor");
+}
+
+static void photoresistor_invalid(const char *command) {
+    log_warn("[PHOTORESISTOR] Invalid command: %s", command);
+    
+    ResultBuilder rb;
+    result_begin(&rb, "photoresistor", command);
+    result_add_str(&rb, "status", "error");
+    result_add_str(&rb, "message", "invalid command");
+    result_publish(&rb, "photoresistor");
+}
+
+// 조도 스트리밍: 디바이스에서 주기적으로 샘플링하고, 마지막 발행 값에서 deadband를 넘게 움직였거나
+// 하트비트 주기가 지났을 때만 telemetry/<device_id>/photoresistor로 발행
+// 주기는 스케줄러(디스패치 스레드)가 재고, 샘플은 read와 같은 샤드 워커에서 읽으므로 센서 상태는 워커만 씀
+struct TelemetryStream {
+    char topic[MAX_TOPIC_LEN];
+    char task_id[64];
+    int active;
+    int sampling;               // 샘플 작업이 워커 큐에 있음 (느린 calibrate 뒤에 쌓이지 않게)
+    int encoding;               // 발행 인코딩 (CBOR로 stream 명령을 받았거나 토픽이 cbor_topic에 맞으면 CBOR)
+    // 설정 (디스패치 스레드가 쓰고 워커가 읽음)
+    int sample_ms;
+    int deadband;
+    int heartbeat_ms;
+    int min_publish_ms;
+    // 워커 전용
+    int has_published;
+    int last_value;
+    uint64_t last_publish_ns;
+    uint64_t samples;
+    uint64_t published;
+};
+
+// 설정 파일의 기본값 (stream 명령에 없는 항목에 사용)
+static struct {
+    int sample_ms;
+    int deadband;
+    int heartbeat_ms;
+    int min_publish_ms;
+} g_stream_defaults = { TELEMETRY_DEFAULT_SAMPLE_MS, TELEMETRY_DEFAULT_DEADBAND, TELEMETRY_DEFAULT_HEARTBEAT_MS, 0 };
+
+void photoresistor_configure(const MQTTConfig *config) {
+    if (config->sensor_window_samples > 0) {
+        g_window_capacity = config->sensor_window_samples;
+    }
+    g_stream_defaults.sample_ms = config->telemetry_sample_ms >= TELEMETRY_MIN_SAMPLE_MS ?
+                                  config->telemetry_sample_ms : TELEMETRY_MIN_SAMPLE_MS;
+    g_stream_defaults.deadband = config->telemetry_deadband > 0 ? config->telemetry_deadband : 0;
+    g_stream_defaults.heartbeat_ms = config->telemetry_heartbeat_ms > 0 ? config->telemetry_heartbeat_ms : 0;
+    g_stream_defaults.min_publish_ms = config->telemetry_min_publish_ms > 0 ? config->telemetry_min_publish_ms : 0;
+}
+
+// 샘플 하나 읽고 발행 여부 결정 (샤드 워커)
+static void photoresistor_stream_sample(const char *command) {
+    (void)command;
+    VirtualDevice *device = device_current();
+    TelemetryStream *stream = device->stream;
+    __atomic_store_n(&stream->sampling, 0, __ATOMIC_RELEASE);
+    if (!__atomic_load_n(&stream->active, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    int value = photoresistor_sample(device);
+    uint64_t now = monotonic_time_ns();
+    uint64_t since_ns = now - stream->last_publish_ns;
+    __atomic_fetch_add(&stream->samples, 1, __ATOMIC_RELAXED);
+    metrics_count(METRIC_TELEMETRY_SAMPLES);
+
+    int deadband = __atomic_load_n(&stream->deadband, __ATOMIC_RELAXED);
+    uint64_t heartbeat_ns = (uint64_t)__atomic_load_n(&stream->heartbeat_ms, __ATOMIC_RELAXED) * 1000000ULL;
+    uint64_t min_publish_ns = (uint64_t)__atomic_load_n(&stream->min_publish_ms, __ATOMIC_RELAXED) * 1000000ULL;
+    const char *reason = NULL;
+    if (!stream->has_published) {
+        reason = "initial";
+    } else if (abs(value - stream->last_value) > deadband && since_ns >= min_publish_ns) {
+        reason = "delta";
+    } else if (heartbeat_ns > 0 && since_ns >= heartbeat_ns) {
+        reason = "heartbeat";
+    }
+    if (!reason) {
+        return;
+    }
+
+    stream->has_published = 1;
+    stream->last_value = value;
+    stream->last_publish_ns = now;
+    __atomic_fetch_add(&stream->published, 1, __ATOMIC_RELAXED);
+    metrics_count(METRIC_TELEMETRY_PUBLISHED);
+
+    ResultBuilder rb;
+    result_init(&rb);
+    result_add_int(&rb, "value", value);
+    result_add_str(&rb, "reason", reason);
+    result_add_int(&rb, "samples", (long)__atomic_load_n(&stream->samples, __ATOMIC_RELAXED));
+    result_publish_to(&rb, stream->topic);
+}
+
+// 스케줄러 콜백: 샘플 작업을 디바이스의 샤드 워커에 넣음 (디스패치 스레드)
+static void photoresistor_stream_tick(void *context) {
+    VirtualDevice *device = context;
+    TelemetryStream *stream = device->stream;
+    if (__atomic_exchange_n(&stream->sampling, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    result_set_encoding(stream->encoding);
+    if (executor_submit("photoresistor", IPC_LANE_LOW, photoresistor_stream_sample, device, "sample") != 0) {
+        __atomic_store_n(&stream->sampling, 0, __ATOMIC_RELEASE);
+    }
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+}
+
+static void stream_report(TelemetryStream *stream, const char *command, const char *status) {
+    ResultBuilder rb;
+    result_begin(&rb, "photoresistor", command);
+    result_add_str(&rb, "topic", stream->topic);
+    result_add_int(&rb, "sample_ms", stream->sample_ms);
+    result_add_int(&rb, "deadband", stream->deadband);
+    result_add_int(&rb, "heartbeat_ms", stream->heartbeat_ms);
+    result_add_int(&rb, "min_publish_ms", stream->min_publish_ms);
+    result_add_int(&rb, "samples", (long)__atomic_load_n(&stream->samples, __ATOMIC_RELAXED));
+    result_add_int(&rb, "published", (long)__atomic_load_n(&stream->published, __ATOMIC_RELAXED));
+    result_add_str(&rb, "status", status);
+    result_publish(&rb, "photoresistor");
+}
+
+// 스트리밍 시작/설정 변경 (디스패치 스레드에서 바로 실행)
+// 페이로드: {"sample_ms":N,"deadband":N,"heartbeat_ms":N,"min_publish_ms":N}, 빠진 항목은 현재 값 유지
+static void photoresistor_stream(const char *payload) {
+    VirtualDevice *device = device_current();
+    TelemetryStream *stream = device->stream;
+    if (!stream) {
+        stream = calloc(1, sizeof(TelemetryStream));
+        if (!stream) {
+            return;
+        }
+        snprintf(stream->topic, sizeof(stream->topic), "telemetry/%s/photoresistor", device->id);
+        snprintf(stream->task_id, sizeof(stream->task_id), "%c%.62s", SCHEDULE_INTERNAL_PREFIX, device->id);
+        stream->sample_ms = g_stream_defaults.sample_ms;
+        stream->deadband = g_stream_defaults.deadband;
+        stream->heartbeat_ms = g_stream_defaults.heartbeat_ms;
+        stream->min_publish_ms = g_stream_defaults.min_publish_ms;
+        device->stream = stream;
+    }
+
+    enum { F_SAMPLE, F_DEADBAND, F_HEARTBEAT, F_MIN_PUBLISH, F_TOTAL };
+    JsonField fields[F_TOTAL] = {
+        { .key = "sample_ms" }, { .key = "deadband" }, { .key = "heartbeat_ms" }, { .key = "min_publish_ms" },
+    };
+    int value;
+    if (payload[0] == '{' && json_extract_fields(payload, (int)strlen(payload), fields, F_TOTAL) > 0) {
+        if (json_field_int(&fields[F_SAMPLE], &value) == 0) {
+            stream->sample_ms = value >= TELEMETRY_MIN_SAMPLE_MS ? value : TELEMETRY_MIN_SAMPLE_MS;
+        }
+        if (json_field_int(&fields[F_DEADBAND], &value) == 0 && value >= 0) {
+            __atomic_store_n(&stream->deadband, value, __ATOMIC_RELAXED);
+        }
+        if (json_field_int(&fields[F_HEARTBEAT], &value) == 0 && value >= 0) {
+            __atomic_store_n(&stream->heartbeat_ms, value, __ATOMIC_RELAXED);
+        }
+        if (json_field_int(&fields[F_MIN_PUBLISH], &value) == 0 && value >= 0) {
+            __atomic_store_n(&stream->min_publish_ms, value, __ATOMIC_RELAXED);
+        }
+    }
+
+    stream->encoding = (result_encoding() == PAYLOAD_ENCODING_CBOR || cbor_wants(stream->topic)) ?
+                       PAYLOAD_ENCODING_CBOR : PAYLOAD_ENCODING_JSON;
+
+    // 샘플 주기가 바뀔 수 있으므로 항상 다시 예약
+    scheduler_cancel(device, stream->task_id);
+    uint64_t sample_ns = (uint64_t)stream->sample_ms * 1000000ULL;
+    if (scheduler_add(device, stream->task_id, sample_ns, sample_ns, -1, photoresistor_stream_tick, device, NULL) != 0) {
+        __atomic_store_n(&stream->active, 0, __ATOMIC_RELEASE);
+        log_error("[PHOTORESISTOR] %s failed to schedule telemetry", device->id);
+        stream_report(stream, "stream", "error");
+        return;
+    }
+    __atomic_store_n(&stream->active, 1, __ATOMIC_RELEASE);
+    log_info("[PHOTORESISTOR] %s streaming every %d ms (deadband %d, heartbeat %d ms, min publish %d ms)",
+             device->id, stream->sample_ms, stream->deadband, stream->heartbeat_ms, stream->min_publish_ms);
+    stream_report(stream, "stream", "streaming");
+}
+
+// 스트리밍 중지 (디스패치 스레드에서 바로 실행)
+static void photoresistor_stream_stop(const char *command) {
+    VirtualDevice *device = device_current();
+    TelemetryStream *stream = device->stream;
+    if (!stream || !__atomic_load_n(&stream->active, __ATOMIC_ACQUIRE)) {
+        ResultBuilder rb;
+        result_begin(&rb, "photoresistor", command);
+        result_add_str(&rb, "status", "not_streaming");
+        result_publish(&rb, "photoresistor");
+        return;
+    }
+    scheduler_cancel(device, stream->task_id);
+    __atomic_store_n(&stream->active, 0, __ATOMIC_RELEASE);
+    log_info("[PHOTORESISTOR] %s streaming stopped", device->id);
+    stream_report(stream, command, "stopped");
+}
+
+// 포토레지스터 명령 테이블
+static const DispatchEntry photoresistor_commands[] = {
+    { "photoresistor", "read", photoresistor_read_command, 0 },
+    { "photoresistor", "value", photoresistor_read_command, 0 },
+    { "photoresistor", "calibrate", photoresistor_calibrate, 0 },
+    { "photoresistor", "stats", photoresistor_stats, 0 },
+    { "photoresistor", "stream", photoresistor_stream, DISPATCH_ARG_PAYLOAD | DISPATCH_INLINE },
+    { "photoresistor", "stream_stop", photoresistor_stream_stop, DISPATCH_INLINE },
+    { "photoresistor", DISPATCH_ANY_COMMAND, photoresistor_invalid, 0 },
+};
+DISPATCH_MODULE(photoresistor_commands)
+
 // 실제 포토레지스터 읽기 함수 (하드웨어 인터페이스)
-int photoresistor_read(void) {
+// 시뮬레이션 기준값은 디바이스마다 따로 움직임
+int photoresistor_read(VirtualDevice *device) {
     // TODO: 실제 ADC 읽기 코드 구현
     // 포토레지스터는 아날로그 센서이므로 ADC(Analog-to-Digital Converter) 필요
     
@@ -58,16 +346,16 @@ int photoresistor_read(void) {
     // - 조도 값으로 변환
     
     // 임시로 시뮬레이션 (랜덤 값 + 시간 기반 변화)
-    static int base_value = 512;
-    static time_t last_time = 0;
+    int base_value = device->light_value;
     
     time_t current_time = time(NULL);
-    if (current_time != last_time) {
+    if (current_time != device->light_time) {
         // 시간이 바뀔 때마다 약간의 변화 추가 (조도 변화 시뮬레이션)
         base_value += (rand() % 100 - 50); // -50 ~ +49 범위의 변화
         if (base_value < 0) base_value = 0;
         if (base_value > 1023) base_value = 1023;
-        last_time = current_time;
+        device->light_value = (int16_t)base_value;
+        device->light_time = current_time;
     }
     
     // 약간의 노이즈 추가
@@ -77,7 +365,7 @@ int photoresistor_read(void) {
     if (final_value < 0) final_value = 0;
     if (final_value > 1023) final_value = 1023;
     
-    printf("[HW] Photoresistor ADC value: %d (simulated)\n", final_value);
+    log_debug("[HW] Photoresistor ADC value for %s: %d (simulated)", device->id, final_value);
     
     return final_value;
 }
\ No newline at end of file
@@ -15,82 +15,91 @@ static const unsigned char segment_patterns[10] = {
     0x6F  // 9: abcdfg
 };
 
-// s_segment 제어 함수
-void handle_s_segment(const char *command) {
-    printf("[S_SEGMENT] Command received: %s\n", command);
+// 실제 디바이스면 디스플레이를 구동하고, 가상 디바이스는 표시 값만 바꿈
+static void segment_set(VirtualDevice *device, int value) {
+    if (device->physical) {
+        seven_segment_display(value);
+    }
+    device->segment_value = (int8_t)value;
+}
+
+// s_segment 제어 함수 (토픽 명령과 관계없이 표시 값 하나를 받음: 0-9, clear, off, test)
+static void handle_s_segment(const char *command) {
+    VirtualDevice *device = device_current();
+    log_debug("[S_SEGMENT] %s command received: %s", device->id, command);
     
-    char topic[MAX_TOPIC_LEN];
-    char result[MAX_STRING_LEN];
+    ResultBuilder rb;
     int display_value = -1;
     
+    result_begin(&rb, "7segment", command);
+    
     // 명령어 파싱
     if (strcmp(command, "clear") == 0 || strcmp(command, "off") == 0) {
         // 디스플레이 끄기
-        seven_segment_display(-1);
-        printf("[S_SEGMENT] Display cleared\n");
+        segment_set(device, -1);
+        log_info("[S_SEGMENT] %s display cleared", device->id);
         
-        snprintf(topic, sizeof(topic), "status/raspberry_001/s_segment/return");
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"7segment\",\"command\":\"%s\",\"status\":\"success\",\"timestamp\":%ld}", 
-                 command, time(NULL));
+        result_add_str(&rb, "status", "success");
     }
     else if (strcmp(command, "test") == 0) {
-        // 테스트 패턴 (0-9 순차 표시)
-        printf("[S_SEGMENT] Running test pattern\n");
+        // 테스트 패턴 (0-9 순차 표시, 가상 디바이스는 기다리지 않음)
+        log_info("[S_SEGMENT] %s running test pattern", device->id);
         for (int i = 0; i <= 9; i++) {
-            seven_segment_display(i);
-            usleep(500000); // 0.5초 대기
+            segment_set(device, i);
+            if (device->physical) {
+                usleep(500000); // 0.5초 대기
+            }
         }
-        seven_segment_display(-1); // 끄기
+        segment_set(device, -1); // 끄기
         
-        snprintf(topic, sizeof(topic), "status/raspberry_001/s_segment/return");
-        snprintf(result, sizeof(result), 
-                 "{\"device\":\"7segment\",\"command\":\"%s\",\"status\":\"success\",\"message\":\"test pattern completed\",\"timestamp\":%ld}", 
-                 command, time(NULL));
+        result_add_str(&rb, "status", "success");
+        result_add_str(&rb, "message", "test pattern completed");
     }
     else {
         // 숫자 값으로 파싱 시도
         display_value = atoi(command);
         if (display_value >= 0 && display_value <= 9) {
-            seven_segment_display(display_value);
-            printf("[S_SEGMENT] Displaying: %d\n", display_value);
+            segment_set(device, display_value);
+            log_info("[S_SEGMENT] %s displaying: %d", device->id, display_value);
             
-            snprintf(topic, sizeof(topic), "status/raspberry_001/s_segment/return");
-            snprintf(result, sizeof(result), 
-                     "{\"device\":\"7segment\",\"command\":\"%s\",\"value\":%d,\"status\":\"success\",\"timestamp\":%ld}", 
-                     command, display_value, time(NULL));
+            result_add_int(&rb, "value", display_value);
+            result_add_str(&rb, "status", "success");
         } else {
-            printf("[S_SEGMENT] Invalid value: %s (must be 0-9, 'clear', 'off', or 'test')\n", command);
+            log_warn("[S_SEGMENT] Invalid value: %s (must be 0-9, 'clear', 'off', or 'test')", command);
             
-            snprintf(topic, sizeof(topic), "status/raspberry_001/s_segment/return");
-            snprintf(result, sizeof(result), 
-                     "{\"device\":\"7segment\",\"command\":\"%s\",\"status\":\"error\",\"message\":\"invalid value (0-9, clear, off, test)\",\"timestamp\":%ld}", 
-                     command, time(NULL));
+            result_add_str(&rb, "status", "error");
+            result_add_str(&rb, "message", "invalid value (0-9, clear, off, test)");
         }
     }
     
-    send_result_to_topic(topic, result);
+    result_publish(&rb, "s_segment");
 }
 
+// 7-세그먼트 명령 테이블 (표시 값은 페이로드로 전달, 비어 있으면 토픽의 명령)
+static const DispatchEntry s_segment_commands[] = {
+    { "s_segment", DISPATCH_ANY_COMMAND, handle_s_segment, DISPATCH_ARG_PAYLOAD },
+};
+DISPATCH_MODULE(s_segment_commands)
+
 // 실제 7-세그먼트 디스플레이 제어 함수 (하드웨어 인터페이스)
 void seven_segment_display(int value) {
     // TODO: 실제 GPIO 제어 코드 구현
     
     if (value == -1) {
         // 디스플레이 끄기
-        printf("[HW] 7-Segment display: OFF (all segments)\n");
+        log_debug("[HW] 7-Segment display: OFF (all segments)");
         // 모든 GPIO 핀을 LOW로 설정
         // for (int i = 0; i < 8; i++) gpio_write(segment_pins[i], GPIO_LOW);
         return;
     }
     
     if (value < 0 || value > 9) {
-        printf("[HW] 7-Segment display: Invalid value %d\n", value);
+        log_warn("[HW] 7-Segment display: Invalid value %d", value);
         return;
     }
     
     unsigned char pattern = segment_patterns[value];
-    printf("[HW] 7-Segment display: %d (pattern: 0x%02X)\n", value, pattern);
+    log_debug("[HW] 7-Segment display: %d (pattern: 0x%02X)", value, pattern);
     
     // 실제 구현 시 추가될 코드:
     // - GPIO 핀 설정 (예: BCM 2, 3, 4, 17, 27, 22, 10, 9번 핀)
@@ -98,18 +107,19 @@ void seven_segment_display(int value) {
     // - 공통 캐소드/애노드에 따른 로직 레벨 조정
     
     // 임시로 세그먼트별 상태 출력
-    printf("[HW] Segments: ");
     char segments[] = "abcdefgp";
+    char states[9];
     for (int i = 0; i < 8; i++) {
         if (pattern & (1 << i)) {
-            printf("%c", segments[i]);
+            states[i] = segments[i];
             // gpio_write(segment_pins[i], GPIO_HIGH);
         } else {
-            printf("-");
+            states[i] = '-';
             // gpio_write(segment_pins[i], GPIO_LOW);
         }
     }
-    printf("\n");
+    states[8] = '\0';
+    log_debug("[HW] Segments: %s", states);
     
     // 실제 GPIO 제어 예시:
     /*
@@ -0,0 +1,222 @@
+#include "../mqtt.h"
+
+// 게이트웨이가 맡은 디바이스 ID 테이블
+// 설정의 device_id는 실제 하드웨어를 구동하고, device/device_range로 추가한 ID는
+// 상태만 가진 가상 디바이스. 시작 시(fork 전) 한 번 만들고 이후에는 조회만 하므로 잠금 없음
+// 디바이스 상태는 필드마다 해당 대상(led, buzzer...)의 실행기 스레드만 씀
+
+static VirtualDevice *g_devices = NULL;
+static int g_device_count = 0;
+static int g_device_capacity = 0;
+static uint32_t *g_device_index = NULL;     // 디바이스 번호 + 1 (0이면 빈 칸)
+static uint32_t g_device_index_mask = 0;
+
+// 테이블이 비어 있을 때(벤치마크, 초기화 전) 핸들러가 쓰는 실제 디바이스
+static VirtualDevice g_fallback_device = { .id = DEFAULT_DEVICE_ID, .id_len = sizeof(DEFAULT_DEVICE_ID) - 1,
+                                           .physical = 1, .segment_value = -1, .light_value = 512 };
+static VirtualDevice *g_primary_device = &g_fallback_device;
+
+// 지금 실행 중인 명령의 대상 디바이스 (실행기 스레드별)
+static __thread VirtualDevice *t_current_device = NULL;
+
+static uint32_t device_hash(const char *id, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)id[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 인덱스를 디바이스 수의 두 배 이상으로 다시 만듦
+static int device_index_rebuild(uint32_t size) {
+    uint32_t *index = calloc(size, sizeof(uint32_t));
+    if (!index) {
+        return -1;
+    }
+    for (int i = 0; i < g_device_count; i++) {
+        uint32_t slot = g_devices[i].hash & (size - 1);
+        while (index[slot]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        index[slot] = (uint32_t)i + 1;
+    }
+    free(g_device_index);
+    g_device_index = index;
+    g_device_index_mask = size - 1;
+    return 0;
+}
+
+// 디바이스 ID로 조회 (토픽 단계 뷰를 그대로 받음, 복사 없음)
+VirtualDevice *device_table_find(const char *id, size_t len) {
+    if (!g_device_index) {
+        return NULL;
+    }
+    uint32_t hash = device_hash(id, len);
+    for (uint32_t slot = hash & g_device_index_mask; g_device_index[slot];
+         slot = (slot + 1) & g_device_index_mask) {
+        VirtualDevice *device = &g_devices[g_device_index[slot] - 1];
+        if (device->hash == hash && device->id_len == len && memcmp(device->id, id, len) == 0) {
+            return device;
+        }
+    }
+    return NULL;
+}
+
+// 디바이스 등록 (시작 전에만 호출, 배열이 옮겨질 수 있음)
+// 이미 있으면 physical만 갱신. 반환: 디바이스 번호, 실패 시 -1
+int device_table_add(const char *id, int physical) {
+    size_t len = strlen(id);
+    if (len == 0 || len >= MAX_DEVICE_ID_LEN || strpbrk(id, "/+#") != NULL) {
+        log_warn("Warning: Invalid device id '%s'", id);
+        return -1;
+    }
+
+    VirtualDevice *existing = device_table_find(id, len);
+    if (existing) {
+        existing->physical |= (uint8_t)(physical != 0);
+        return (int)(existing - g_devices);
+    }
+
+    if (g_device_count == g_device_capacity) {
+        int capacity = g_device_capacity ? g_device_capacity * 2 : 16;
+        VirtualDevice *devices = realloc(g_devices, (size_t)capacity * sizeof(VirtualDevice));
+        if (!devices) {
+            log_error("Devices: Out of memory at %d devices", g_device_count);
+            return -1;
+        }
+        g_devices = devices;
+        g_device_capacity = capacity;
+    }
+
+    VirtualDevice *device = &g_devices[g_device_count++];
+    memset(device, 0, sizeof(*device));
+    memcpy(device->id, id, len + 1);
+    device->id_len = (uint8_t)len;
+    device->hash = device_hash(id, len);
+    device->physical = (uint8_t)(physical != 0);
+    device->segment_value = -1;
+    device->light_value = 512;
+
+    // 적재율 1/2 이하 유지
+    if ((uint32_t)g_device_count * 2 > g_device_index_mask) {
+        uint32_t size = g_device_index ? (g_device_index_mask + 1) * 2 : 64;
+        if (device_index_rebuild(size) != 0) {
+            g_device_count--;
+            return -1;
+        }
+    } else {
+        uint32_t slot = device->hash & g_device_index_mask;
+        while (g_device_index[slot]) {
+            slot = (slot + 1) & g_device_index_mask;
+        }
+        g_device_index[slot] = (uint32_t)g_device_count;
+    }
+    return g_device_count - 1;
+}
+
+// "<prefix>:<count>" 형식으로 가상 디바이스 여러 개 등록 (예: sim_:1000 → sim_0000 ... sim_0999)
+// 반환: 등록한 수, 형식 오류면 -1
+int device_table_add_range(const char *spec) {
+    const char *colon = strrchr(spec, ':');
+    if (!colon || colon == spec) {
+        log_warn("Warning: Invalid device_range '%s' (expected <prefix>:<count>)", spec);
+        return -1;
+    }
+    int count = atoi(colon + 1);
+    if (count <= 0) {
+        log_warn("Warning: Invalid device_range count in '%s'", spec);
+        return -1;
+    }
+
+    int width = 4;
+    for (int n = count - 1; n >= 10000; n /= 10) {
+        width++;
+    }
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        char id[MAX_DEVICE_ID_LEN];
+        int len = snprintf(id, sizeof(id), "%.*s%0*d", (int)(colon - spec), spec, width, i);
+        if (len < 0 || (size_t)len >= sizeof(id) || device_table_add(id, 0) < 0) {
+            break;
+        }
+        added++;
+    }
+    return added;
+}
+
+// 디바이스 테이블 요약 출력
+static void print_device_table(void) {
+    size_t bytes = device_table_memory();
+    printf("Devices (%d, %zu bytes/device, %zu KB total):\n", g_device_count,
+           g_device_count ? bytes / (size_t)g_device_count : 0, bytes / 1024);
+    int shown = g_device_count < 8 ? g_device_count : 8;
+    for (int i = 0; i < shown; i++) {
+        printf("  - %s%s\n", g_devices[i].id, g_devices[i].physical ? " (hardware)" : "");
+    }
+    if (shown < g_device_count) {
+        printf("  ... %d more\n", g_device_count - shown);
+    }
+}
+
+// 설정의 device_id를 실제 디바이스로 등록하고 테이블 확정 (상태 토픽 초기화 후, fork 전 호출)
+int device_table_init(const MQTTConfig *config) {
+    const char *primary_id = config->device_id[0] ? config->device_id : DEFAULT_DEVICE_ID;
+    int primary = device_table_add(primary_id, 1);
+    if (primary < 0) {
+        return -1;
+    }
+    // 등록이 끝났으므로 이후 포인터는 바뀌지 않음
+    g_primary_device = &g_devices[primary];
+
+    print_device_table();
+    return g_device_count;
+}
+
+int device_table_count(void) {
+    return g_device_count;
+}
+
+// 테이블이 차지하는 메모리 (디바이스 배열 + 인덱스, 예비 용량 포함)
+size_t device_table_memory(void) {
+    size_t bytes = (size_t)g_device_capacity * sizeof(VirtualDevice);
+    if (g_device_index) {
+        bytes += ((size_t)g_device_index_mask + 1) * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+// 설정의 실제 디바이스
+VirtualDevice *device_table_primary(void) {
+    return g_primary_device;
+}
+
+// 실행기가 핸들러 호출 전에 대상 디바이스 지정 (NULL이면 실제 디바이스)
+void device_set_current(VirtualDevice *device) {
+    t_current_device = device;
+}
+
+// 핸들러가 다루는 디바이스 (항상 NULL 아님)
+VirtualDevice *device_current(void) {
+    return t_current_device ? t_current_device : g_primary_device;
+}
+
+// 실행기와 스케줄러를 정리한 뒤 호출
+void device_table_cleanup(void) {
+    for (int i = 0; i < g_device_count; i++) {
+        free(g_devices[i].stream);
+        free(g_devices[i].light_window);
+    }
+    free(g_fallback_device.stream);
+    free(g_fallback_device.light_window);
+    g_fallback_device.stream = NULL;
+    g_fallback_device.light_window = NULL;
+    free(g_devices);
+    free(g_device_index);
+    g_devices = NULL;
+    g_device_index = NULL;
+    g_device_count = 0;
+    g_device_capacity = 0;
+    g_device_index_mask = 0;
+    g_primary_device = &g_fallback_device;
+}
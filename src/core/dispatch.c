@@ -0,0 +1,243 @@
+#include "../mqtt.h"
+
+// (디바이스, 명령) → 핸들러 레지스트리
+// 제어 모듈이 main 실행 전에 항목을 등록하고, dispatch_build가 완전 해시 테이블을 만듦
+// 완전 해시는 hash-and-displace 방식: 1단계 해시로 버킷을 고르고,
+// 버킷마다 찾아둔 변위값으로 2단계 해시를 돌려 충돌 없는 슬롯을 얻음
+
+#define DISPATCH_SLOT_COUNT (MAX_DISPATCH_ENTRIES * 2)
+#define DISPATCH_MAX_DISPLACE (1u << 20)
+
+typedef struct {
+    DispatchEntry entry;
+    uint16_t device_len;
+    uint16_t command_len;
+    uint64_t hash;
+} RegistryEntry;
+
+static RegistryEntry g_entries[MAX_DISPATCH_ENTRIES];
+static int g_entry_count = 0;
+
+// 완전 해시 테이블 (빌드 후 읽기 전용)
+static int16_t g_slots[DISPATCH_SLOT_COUNT];
+static uint32_t g_displace[DISPATCH_SLOT_COUNT];
+static uint32_t g_slot_mask = 0;
+static uint32_t g_bucket_mask = 0;
+static int g_built = 0;
+
+// 키 해시 (device '/' command 에 대한 64비트 FNV-1a, 토픽을 한 번만 훑음)
+static uint64_t dispatch_key_hash(const char *device, size_t device_len, const char *command, size_t command_len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < device_len; i++) {
+        h ^= (unsigned char)device[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= '/';
+    h *= 1099511628211ULL;
+    for (size_t i = 0; i < command_len; i++) {
+        h ^= (unsigned char)command[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// 키 해시를 섞어 버킷/슬롯 번호로 (displace 0은 1단계 버킷용)
+static uint32_t dispatch_mix(uint64_t hash, uint32_t displace) {
+    uint64_t x = hash ^ (displace * 0x9E3779B97F4A7C15ULL);
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+static uint32_t next_pow2(uint32_t value) {
+    uint32_t pow2 = 1;
+    while (pow2 < value) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+// 항목 하나 등록 (시작 전에만 호출, 같은 키가 있으면 거부)
+// device/command 문자열은 복사하지 않으므로 프로그램 끝까지 유지되어야 함
+int dispatch_register(const char *device, const char *command, device_handler_t handler, int flags) {
+    if (!device || !command || !handler || device[0] == '\0' || command[0] == '\0') {
+        return -1;
+    }
+    size_t device_len = strlen(device);
+    size_t command_len = strlen(command);
+    if (device_len > UINT16_MAX || command_len > UINT16_MAX) {
+        return -1;
+    }
+    for (int i = 0; i < g_entry_count; i++) {
+        if (strcmp(g_entries[i].entry.device, device) == 0 && strcmp(g_entries[i].entry.command, command) == 0) {
+            log_warn("Dispatch: Duplicate handler for %s/%s ignored", device, command);
+            return -1;
+        }
+    }
+    if (g_entry_count >= MAX_DISPATCH_ENTRIES) {
+        log_error("Dispatch: Registry full (max %d), %s/%s ignored", MAX_DISPATCH_ENTRIES, device, command);
+        return -1;
+    }
+
+    RegistryEntry *slot = &g_entries[g_entry_count++];
+    slot->entry.device = device;
+    slot->entry.command = command;
+    slot->entry.handler = handler;
+    slot->entry.flags = flags;
+    slot->device_len = (uint16_t)device_len;
+    slot->command_len = (uint16_t)command_len;
+    slot->hash = dispatch_key_hash(device, device_len, command, command_len);
+    g_built = 0;
+    return 0;
+}
+
+// 모듈 테이블 등록 (DISPATCH_MODULE 매크로에서 사용)
+int dispatch_register_table(const DispatchEntry *entries, int count) {
+    int registered = 0;
+    for (int i = 0; i < count; i++) {
+        if (dispatch_register(entries[i].device, entries[i].command, entries[i].handler, entries[i].flags) == 0) {
+            registered++;
+        }
+    }
+    return registered;
+}
+
+static uint32_t g_bucket_sizes[DISPATCH_SLOT_COUNT];
+
+static int compare_bucket_size(const void *a, const void *b) {
+    uint32_t size_a = g_bucket_sizes[*(const uint32_t *)a];
+    uint32_t size_b = g_bucket_sizes[*(const uint32_t *)b];
+    return (size_a < size_b) - (size_a > size_b);
+}
+
+// 완전 해시 테이블 생성 (스레드 시작 전에 호출)
+// 큰 버킷부터 모든 항목이 빈 슬롯에 들어가는 변위값을 찾음
+int dispatch_build(void) {
+    static uint32_t order[DISPATCH_SLOT_COUNT];
+    static uint32_t bucket_start[DISPATCH_SLOT_COUNT + 1];
+    static uint32_t fill[DISPATCH_SLOT_COUNT];
+    static int16_t members[MAX_DISPATCH_ENTRIES];
+    uint32_t bucket_count;
+
+    g_slot_mask = next_pow2((uint32_t)g_entry_count + (uint32_t)g_entry_count / 2 + 1) - 1;
+    bucket_count = next_pow2((uint32_t)g_entry_count / 2 + 1);
+    g_bucket_mask = bucket_count - 1;
+
+    memset(g_slots, 0xFF, sizeof(int16_t) * (g_slot_mask + 1));
+    memset(g_displace, 0, sizeof(uint32_t) * bucket_count);
+    memset(g_bucket_sizes, 0, sizeof(uint32_t) * bucket_count);
+
+    // 버킷별로 항목 모으기 (계수 정렬)
+    for (int i = 0; i < g_entry_count; i++) {
+        g_bucket_sizes[dispatch_mix(g_entries[i].hash, 0) & g_bucket_mask]++;
+    }
+    bucket_start[0] = 0;
+    for (uint32_t b = 0; b < bucket_count; b++) {
+        bucket_start[b + 1] = bucket_start[b] + g_bucket_sizes[b];
+        order[b] = b;
+    }
+    memcpy(fill, bucket_start, sizeof(uint32_t) * bucket_count);
+    for (int i = 0; i < g_entry_count; i++) {
+        uint32_t b = dispatch_mix(g_entries[i].hash, 0) & g_bucket_mask;
+        members[fill[b]++] = (int16_t)i;
+    }
+    qsort(order, bucket_count, sizeof(uint32_t), compare_bucket_size);
+
+    for (uint32_t k = 0; k < bucket_count && g_bucket_sizes[order[k]] > 0; k++) {
+        uint32_t b = order[k];
+        uint32_t size = g_bucket_sizes[b];
+        uint32_t placed[MAX_DISPATCH_ENTRIES];
+        uint32_t displace;
+
+        for (displace = 1; displace < DISPATCH_MAX_DISPLACE; displace++) {
+            uint32_t n;
+            for (n = 0; n < size; n++) {
+                const RegistryEntry *entry = &g_entries[members[bucket_start[b] + n]];
+                uint32_t slot = dispatch_mix(entry->hash, displace) & g_slot_mask;
+                if (g_slots[slot] != -1) {
+                    break;
+                }
+                // 같은 버킷 안에서도 겹치면 안 됨 (임시로 표시)
+                g_slots[slot] = members[bucket_start[b] + n];
+                placed[n] = slot;
+            }
+            if (n == size) {
+                break;
+            }
+            for (uint32_t u = 0; u < n; u++) {
+                g_slots[placed[u]] = -1;
+            }
+        }
+        if (displace == DISPATCH_MAX_DISPLACE) {
+            log_error("Dispatch: Failed to build perfect hash (%d entries)", g_entry_count);
+            g_built = 0;
+            return -1;
+        }
+        g_displace[b] = displace;
+    }
+
+    g_built = 1;
+    return g_entry_count;
+}
+
+static const DispatchEntry *dispatch_find(const char *device, size_t device_len, const char *command, size_t command_len) {
+    uint64_t hash = dispatch_key_hash(device, device_len, command, command_len);
+    uint32_t displace = g_displace[dispatch_mix(hash, 0) & g_bucket_mask];
+    if (displace == 0) {
+        return NULL;
+    }
+    int16_t index = g_slots[dispatch_mix(hash, displace) & g_slot_mask];
+    if (index < 0) {
+        return NULL;
+    }
+    const RegistryEntry *entry = &g_entries[index];
+    if (entry->hash != hash || entry->device_len != device_len || entry->command_len != command_len ||
+        memcmp(entry->entry.device, device, device_len) != 0 ||
+        memcmp(entry->entry.command, command, command_len) != 0) {
+        return NULL;
+    }
+    return &entry->entry;
+}
+
+// 디바이스/명령 이름으로 핸들러 조회 (정확한 명령이 없으면 "*" 항목)
+const DispatchEntry *dispatch_lookup_name(const char *device, size_t device_len, const char *command, size_t command_len) {
+    if (!g_built && dispatch_build() < 0) {
+        return NULL;
+    }
+    // "stats?window=60s"처럼 '?' 뒤는 명령 인자이므로 이름 비교에서 뺌 (핸들러는 명령 전체를 받음)
+    const char *query = memchr(command, '?', command_len);
+    if (query) {
+        command_len = (size_t)(query - command);
+    }
+    const DispatchEntry *entry = dispatch_find(device, device_len, command, command_len);
+    if (!entry) {
+        entry = dispatch_find(device, device_len, DISPATCH_ANY_COMMAND, 1);
+    }
+    return entry;
+}
+
+// 토큰화된 토픽으로 핸들러 조회 (target_device/command 뷰를 그대로 해시)
+const DispatchEntry *dispatch_lookup(const ParsedTopic *topic_info) {
+    if (!topic_info || !topic_info->is_valid) {
+        return NULL;
+    }
+    const char *topic = topic_info->topic;
+    return dispatch_lookup_name(topic + topic_info->target_device.offset, topic_info->target_device.len,
+                                topic + topic_info->command.offset, topic_info->command.len);
+}
+
+int dispatch_entry_count(void) {
+    return g_entry_count;
+}
+
+// 등록된 항목 출력
+void print_dispatch_table(void) {
+    printf("Dispatch table (%d entries, %u slots):\n", g_entry_count, g_built ? g_slot_mask + 1 : 0);
+    for (int i = 0; i < g_entry_count; i++) {
+        const DispatchEntry *entry = &g_entries[i].entry;
+        printf("  - %s/%s%s%s\n", entry->device, entry->command,
+               (entry->flags & DISPATCH_ARG_PAYLOAD) ? " (payload)" : "",
+               (entry->flags & DISPATCH_INLINE) ? " (inline)" : "");
+    }
+}
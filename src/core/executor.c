@@ -0,0 +1,359 @@
+#include "../mqtt.h"
+#include <sched.h>
+
+// 샤드 워커 풀
+// 작업은 키((device_id, 대상 디바이스) 또는 메시지의 device_id) 해시로 워커 하나에 고정되므로
+// 같은 디바이스의 작업은 도착 순서대로 실행되고, 서로 다른 디바이스는 워커 수만큼 동시에 실행됨
+// 워커마다 레인별 무잠금 MPSC 큐를 두어 디스패치 스레드와 Paho 콜백 스레드가 잠금 없이 넣고,
+// 워커는 높은 레인부터 꺼냄 (실행 중인 작업은 중단하지 않음). 큐가 비면 eventfd로 잠듦
+
+// 큐 연결 고리 (작업 맨 앞에 둠)
+typedef struct JobNode {
+    struct JobNode *next;
+} JobNode;
+
+// 워커 풀에 들어가는 작업 (arg는 구조체 뒤에 이어서 할당)
+// 제어 명령이면 arg = 명령 문자열, 일반 메시지면 arg = topic\0payload
+typedef struct {
+    JobNode node;
+    device_handler_t handler;
+    message_handler_t message;
+    VirtualDevice *device;      // 명령을 받은 디바이스 ID (NULL이면 실제 디바이스)
+    int metrics_slot;           // 대상 디바이스별 핸들러 지연 히스토그램 위치
+    int encoding;               // 결과 인코딩 (등록한 스레드의 현재 값)
+    int payload_len;
+    uint64_t enqueue_ns;
+    char arg[];
+} ExecutorJob;
+
+// 무잠금 MPSC 큐 (Vyukov 방식): 생산자는 tail 교환 한 번, head는 워커만 읽음
+typedef struct {
+    JobNode *tail __attribute__((aligned(64)));
+    JobNode *head __attribute__((aligned(64)));
+    JobNode stub;
+} JobQueue;
+
+typedef struct {
+    pthread_t thread;
+    int index;
+    int wake_fd;                // 잠든 워커를 깨우는 eventfd
+    int sleeping;
+    int stopping;
+    int pending;                // 큐에 있는 작업 수 (생산자/워커 공유)
+    uint64_t completed;         // 워커 전용
+    uint64_t rejected;          // 생산자 공유 (원자적 증가)
+    JobQueue lanes[IPC_LANE_COUNT];
+} ExecutorWorker;
+
+// 종료 뒤 늦게 들어온 생산자도 안전하게 거절하도록 정적 배열로 둠
+static ExecutorWorker g_workers[MAX_EXECUTOR_WORKERS];
+static int g_worker_count = 0;
+static int g_active_producers = 0;      // 워커 수를 읽고 넣기를 마치지 않은 생산자 수 (종료가 기다림)
+
+static void job_queue_init(JobQueue *queue) {
+    queue->stub.next = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+}
+
+static void job_queue_push(JobQueue *queue, JobNode *node) {
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+    JobNode *prev = __atomic_exchange_n(&queue->tail, node, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+// 워커 전용. 생산자가 tail만 바꾸고 아직 연결하지 않았으면 NULL (연결 후 깨우므로 다시 확인됨)
+static JobNode *job_queue_pop(JobQueue *queue) {
+    JobNode *head = queue->head;
+    JobNode *next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    if (head == &queue->stub) {
+        if (!next) {
+            return NULL;
+        }
+        queue->head = next;
+        head = next;
+        next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+        queue->head = next;
+        return head;
+    }
+    if (head != __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    // 마지막 작업을 꺼내기 전에 stub을 다시 넣어 큐가 비지 않게 함
+    job_queue_push(queue, &queue->stub);
+    next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        queue->head = next;
+        return head;
+    }
+    return NULL;
+}
+
+// 높은 레인부터 작업 하나 꺼냄
+static ExecutorJob *worker_pop(ExecutorWorker *worker) {
+    for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+        JobNode *node = job_queue_pop(&worker->lanes[lane]);
+        if (node) {
+            __atomic_fetch_sub(&worker->pending, 1, __ATOMIC_RELAXED);
+            return (ExecutorJob *)node;
+        }
+    }
+    return NULL;
+}
+
+static void executor_run_job(ExecutorJob *job) {
+    uint64_t start_ns = monotonic_time_ns();
+    if (job->message) {
+        job->message(job->arg, job->arg + strlen(job->arg) + 1, job->payload_len);
+        return;
+    }
+
+    // 블로킹 동작(usleep 등)은 이 워커에 모인 디바이스만 멈춤
+    metrics_record(METRIC_STAGE_EXECUTOR_WAIT, start_ns - job->enqueue_ns);
+    device_set_current(job->device);
+    result_set_encoding(job->encoding);
+    job->handler(job->arg);
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+    device_set_current(NULL);
+    if (job->device) {
+        __atomic_fetch_add(&job->device->commands, 1, __ATOMIC_RELAXED);
+    }
+    uint64_t elapsed_ns = monotonic_time_ns() - start_ns;
+    metrics_record(METRIC_STAGE_HANDLER, elapsed_ns);
+    metrics_record_device(job->metrics_slot, elapsed_ns);
+}
+
+// 워커 스레드 본체
+static void *executor_worker_main(void *arg) {
+    ExecutorWorker *worker = arg;
+
+    while (!__atomic_load_n(&worker->stopping, __ATOMIC_ACQUIRE)) {
+        ExecutorJob *job = worker_pop(worker);
+        if (!job) {
+            // 잠들기 전에 표시하고 한 번 더 확인 (생산자는 넣은 뒤 표시를 보고 깨움)
+            __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+            job = worker_pop(worker);
+            if (!job && !__atomic_load_n(&worker->stopping, __ATOMIC_SEQ_CST)) {
+                uint64_t value;
+                if (read(worker->wake_fd, &value, sizeof(value)) < 0 && errno != EINTR) {
+                    perror("Executor: eventfd read failed");
+                }
+            }
+            __atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+            if (!job) {
+                continue;
+            }
+        }
+        executor_run_job(job);
+        free(job);
+        worker->completed++;
+    }
+    return NULL;
+}
+
+static void executor_wake(ExecutorWorker *worker) {
+    uint64_t one = 1;
+    if (write(worker->wake_fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        perror("Executor: eventfd write failed");
+    }
+}
+
+// 워커 풀 시작 (workers가 0 이하면 온라인 CPU 수)
+int executor_start(int workers) {
+    if (g_worker_count > 0) {
+        return g_worker_count;
+    }
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (workers > MAX_EXECUTOR_WORKERS) {
+        workers = MAX_EXECUTOR_WORKERS;
+    }
+
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        ExecutorWorker *worker = &g_workers[i];
+        memset(worker, 0, sizeof(*worker));
+        worker->index = i;
+        for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+            job_queue_init(&worker->lanes[lane]);
+        }
+        worker->wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (worker->wake_fd == -1) {
+            perror("Executor: eventfd failed");
+            break;
+        }
+        if (pthread_create(&worker->thread, NULL, executor_worker_main, worker) != 0) {
+            log_error("Executor: Failed to start worker %d", i);
+            close(worker->wake_fd);
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        return -1;
+    }
+    __atomic_store_n(&g_worker_count, started, __ATOMIC_RELEASE);
+    log_info("Executor: Started %d worker(s), sharded by device", started);
+    return started;
+}
+
+int executor_worker_count(void) {
+    return __atomic_load_n(&g_worker_count, __ATOMIC_ACQUIRE);
+}
+
+// 생산자 구간 시작: 워커 수를 읽기 전에 표시해 두면 종료는 구간이 끝날 때까지 fd를 닫지 않음
+// (반환: 워커 수, 0이면 풀 없음. 어느 경우든 producer_leave로 끝냄)
+static int producer_enter(void) {
+    __atomic_fetch_add(&g_active_producers, 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&g_worker_count, __ATOMIC_SEQ_CST);
+}
+
+static void producer_leave(void) {
+    __atomic_fetch_sub(&g_active_producers, 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t shard_hash(uint32_t hash, const char *key, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 샤드 워커 큐에 넣고 잠들어 있으면 깨움 (count는 호출자가 한 번 읽은 워커 수)
+static int executor_enqueue(int count, uint32_t hash, int lane, ExecutorJob *job, const char *what) {
+    ExecutorWorker *worker = &g_workers[hash % (uint32_t)count];
+    if (lane < 0 || lane >= IPC_LANE_COUNT) {
+        lane = IPC_LANE_NORMAL;
+    }
+
+    if (__atomic_load_n(&worker->stopping, __ATOMIC_ACQUIRE)) {
+        free(job);
+        return -1;
+    }
+    if (__atomic_fetch_add(&worker->pending, 1, __ATOMIC_RELAXED) >= MAX_EXECUTOR_QUEUE) {
+        __atomic_fetch_sub(&worker->pending, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&worker->rejected, 1, __ATOMIC_RELAXED);
+        metrics_count(METRIC_EXECUTOR_REJECTED);
+        log_warn("Executor: Queue full on worker %d, %s dropped", worker->index, what);
+        free(job);
+        return -1;
+    }
+
+    job->enqueue_ns = monotonic_time_ns();
+    job_queue_push(&worker->lanes[lane], &job->node);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST)) {
+        executor_wake(worker);
+    }
+    return 0;
+}
+
+// 제어 명령 등록 (즉시 반환). arg는 복사되므로 호출 후 해제해도 됨
+// (target의 device_id, device)가 같은 명령은 같은 워커에서 레인별 도착 순서로 실행
+// target은 핸들러가 device_current()로 보는 디바이스 (디바이스 테이블 안의 항목)
+int executor_submit(const char *device, int lane, device_handler_t handler, VirtualDevice *target, const char *arg) {
+    if (!device || !handler || !arg) {
+        return -1;
+    }
+    int count = producer_enter();
+    if (count == 0) {
+        producer_leave();
+        return -1;
+    }
+
+    size_t arg_len = strlen(arg);
+    ExecutorJob *job = malloc(sizeof(ExecutorJob) + arg_len + 1);
+    if (!job) {
+        producer_leave();
+        return -1;
+    }
+    job->handler = handler;
+    job->message = NULL;
+    job->device = target;
+    job->metrics_slot = metrics_device_slot(device);
+    job->encoding = result_encoding();
+    job->payload_len = 0;
+    memcpy(job->arg, arg, arg_len + 1);
+
+    const VirtualDevice *owner = target ? target : device_table_primary();
+    uint32_t hash = shard_hash(owner->hash, device, strlen(device));
+    int rc = executor_enqueue(count, hash, lane, job, "command");
+    producer_leave();
+    return rc;
+}
+
+// 일반 메시지 처리 등록 (Paho 콜백 스레드가 복사만 하고 바로 반환하도록)
+// key(보통 토픽의 device_id 단계)가 같은 메시지는 도착 순서대로 처리
+// 풀이 아직 없으면 호출한 스레드에서 바로 처리
+int executor_submit_message(const char *key, size_t key_len, message_handler_t handler,
+                            const char *topic, const char *payload, int payload_len) {
+    if (!handler || !topic || payload_len < 0) {
+        return -1;
+    }
+    int count = producer_enter();
+    if (count == 0) {
+        producer_leave();
+        handler(topic, payload ? payload : "", payload_len);
+        return 0;
+    }
+
+    size_t topic_len = strlen(topic);
+    ExecutorJob *job = malloc(sizeof(ExecutorJob) + topic_len + 1 + (size_t)payload_len + 1);
+    if (!job) {
+        producer_leave();
+        return -1;
+    }
+    job->handler = NULL;
+    job->message = handler;
+    job->device = NULL;
+    job->metrics_slot = -1;
+    job->encoding = PAYLOAD_ENCODING_JSON;
+    job->payload_len = payload_len;
+    memcpy(job->arg, topic, topic_len + 1);
+    if (payload_len > 0) {
+        memcpy(job->arg + topic_len + 1, payload, (size_t)payload_len);
+    }
+    job->arg[topic_len + 1 + payload_len] = '\0';
+
+    int rc = executor_enqueue(count, shard_hash(2166136261u, key, key_len), IPC_LANE_NORMAL, job, "message");
+    producer_leave();
+    return rc;
+}
+
+// 워커 풀 종료 (실행 중인 작업은 끝까지 수행, 대기 작업은 폐기)
+// 이후 들어오는 메시지는 호출한 스레드에서 바로 처리됨
+// Paho 콜백 스레드가 아직 연결되어 있어도 되도록, 예전 워커 수를 읽은 생산자가 넣기를 마칠 때까지
+// 기다린 뒤 워커를 멈추고 fd를 닫음 (그 뒤 생산자는 워커 수 0을 봄)
+void executor_shutdown_all(void) {
+    int count = executor_worker_count();
+    __atomic_store_n(&g_worker_count, 0, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_active_producers, __ATOMIC_SEQ_CST) > 0) {
+        sched_yield();
+    }
+    for (int i = 0; i < count; i++) {
+        __atomic_store_n(&g_workers[i].stopping, 1, __ATOMIC_SEQ_CST);
+        executor_wake(&g_workers[i]);
+    }
+
+    for (int i = 0; i < count; i++) {
+        ExecutorWorker *worker = &g_workers[i];
+        pthread_join(worker->thread, NULL);
+
+        int discarded = 0;
+        ExecutorJob *job;
+        while ((job = worker_pop(worker)) != NULL) {
+            free(job);
+            discarded++;
+        }
+        log_info("Executor: Worker %d stopped - completed %llu, rejected %llu, discarded %d",
+                 i, (unsigned long long)worker->completed,
+                 (unsigned long long)__atomic_load_n(&worker->rejected, __ATOMIC_RELAXED), discarded);
+        close(worker->wake_fd);
+        worker->wake_fd = -1;
+    }
+}
@@ -0,0 +1,543 @@
+#include "../mqtt.h"
+
+// 비동기 바이너리 로거
+// 호출 스레드는 서식 문자열 포인터와 인자 값만 고정 크기 레코드로 자기 링에 넣고
+// (락/시스템 콜 없음), 백그라운드 스레드가 시간순으로 모아 서식화한 뒤 한 번에 출력함
+// 로거가 돌고 있지 않으면 (시작 전/종료 후/fork 직후) 같은 서식으로 바로 출력
+
+#define LOG_STRBUF_SIZE (LOG_RECORD_SIZE - 24 - 8 * LOG_MAX_ARGS)
+#define LOG_IDLE_WAIT_MS 5
+#define LOG_OUT_BUFFER_SIZE 65536
+
+// 고정 크기 로그 레코드 (문자열 인자는 strbuf에 복사, 나머지는 64비트 값)
+typedef struct {
+    uint64_t ts_ns;             // CLOCK_REALTIME
+    const char *fmt;            // 정적 서식 문자열 (복사하지 않음)
+    uint16_t str_used;
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t overflow;           // 인자/문자열 공간이 모자라 뒤를 잘랐음
+    uint64_t args[LOG_MAX_ARGS];
+    char strbuf[LOG_STRBUF_SIZE];
+} LogRecord;
+
+// 스레드별 SPSC 링 (생산자: 소유 스레드, 소비자: 로거 스레드)
+typedef struct LogRing {
+    LogRecord *records;
+    uint64_t head;              // 생산자가 다음에 쓸 위치
+    uint64_t tail;              // 소비자가 다음에 읽을 위치
+    uint64_t written;
+    uint64_t dropped;
+    int closed;                 // 소유 스레드 종료 (비우고 나면 해제)
+    struct LogRing *next;
+} LogRing;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t flushed;
+    pthread_t thread;
+    pthread_key_t ring_key;
+    int key_ready;
+    int running;
+    int stopping;
+    uint64_t flush_requested;
+    uint64_t flush_done;
+    uint64_t retired_written;   // 해제한 링의 누적 통계
+    uint64_t retired_dropped;
+    LogRing *rings;
+} g_log = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .flushed = PTHREAD_COND_INITIALIZER,
+};
+
+static int g_log_level = LOG_LEVEL_INFO;
+static __thread LogRing *t_log_ring = NULL;
+
+static const char *g_level_names[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+
+void log_set_level(int level) {
+    if (level < LOG_LEVEL_ERROR) level = LOG_LEVEL_ERROR;
+    if (level > LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+    __atomic_store_n(&g_log_level, level, __ATOMIC_RELAXED);
+}
+
+int log_get_level(void) {
+    return __atomic_load_n(&g_log_level, __ATOMIC_RELAXED);
+}
+
+// 레벨 이름 → 번호 (모르면 -1)
+int log_level_from_name(const char *name) {
+    for (int level = LOG_LEVEL_ERROR; level <= LOG_LEVEL_DEBUG; level++) {
+        if (strcasecmp(name, g_level_names[level]) == 0) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+// 변환 명세 하나 (%[flags][width][.precision][length]conv)
+typedef struct {
+    char flags[8];
+    int width;                  // -1: 없음, -2: '*'
+    int precision;              // -1: 없음, -2: '*'
+    char length[3];
+    char conv;
+} LogSpec;
+
+// fmt의 '%' 다음부터 명세 하나를 읽고 다음 위치 반환
+static const char *parse_spec(const char *p, LogSpec *spec) {
+    int n = 0;
+    memset(spec, 0, sizeof(LogSpec));
+    spec->width = -1;
+    spec->precision = -1;
+
+    while (*p && strchr("-+ #0", *p)) {
+        if (n < (int)sizeof(spec->flags) - 1) {
+            spec->flags[n++] = *p;
+        }
+        p++;
+    }
+    if (*p == '*') {
+        spec->width = -2;
+        p++;
+    } else if (isdigit((unsigned char)*p)) {
+        spec->width = 0;
+        while (isdigit((unsigned char)*p)) spec->width = spec->width * 10 + (*p++ - '0');
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->precision = -2;
+            p++;
+        } else {
+            spec->precision = 0;
+            while (isdigit((unsigned char)*p)) spec->precision = spec->precision * 10 + (*p++ - '0');
+        }
+    }
+    n = 0;
+    while (*p && strchr("hlzjtL", *p) && n < 2) {
+        spec->length[n++] = *p++;
+    }
+    spec->conv = *p ? *p++ : '\0';
+    return p;
+}
+
+// 인자 값을 레코드에 저장 (서식 문자열을 따라 va_arg 타입 결정)
+static void encode_args(LogRecord *rec, const char *fmt, va_list ap) {
+    const char *p = fmt;
+    rec->nargs = 0;
+    rec->str_used = 0;
+    rec->overflow = 0;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        LogSpec spec;
+        p = parse_spec(p + 1, &spec);
+        if (spec.conv == '%' || spec.conv == '\0') {
+            if (spec.conv == '\0') break;
+            continue;
+        }
+        // '*' 너비/정밀도도 인자 하나씩 차지
+        int star_count = (spec.width == -2) + (spec.precision == -2);
+        int precision = spec.precision;
+        for (int i = 0; i < star_count; i++) {
+            int value = va_arg(ap, int);
+            if (i == star_count - 1 && spec.precision == -2) {
+                precision = value;
+            }
+            if (rec->nargs < LOG_MAX_ARGS) {
+                rec->args[rec->nargs++] = (uint64_t)(int64_t)value;
+            } else {
+                rec->overflow = 1;
+            }
+        }
+
+        uint64_t word = 0;
+        switch (spec.conv) {
+        case 'd': case 'i':
+            if (strcmp(spec.length, "ll") == 0) word = (uint64_t)va_arg(ap, long long);
+            else if (spec.length[0] == 'l' || spec.length[0] == 'z' || spec.length[0] == 't') word = (uint64_t)va_arg(ap, long);
+            else if (spec.length[0] == 'j') word = (uint64_t)va_arg(ap, intmax_t);
+            else word = (uint64_t)(int64_t)va_arg(ap, int);
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            if (strcmp(spec.length, "ll") == 0) word = (uint64_t)va_arg(ap, unsigned long long);
+            else if (spec.length[0] == 'l' || spec.length[0] == 'z' || spec.length[0] == 't') word = (uint64_t)va_arg(ap, unsigned long);
+            else if (spec.length[0] == 'j') word = (uint64_t)va_arg(ap, uintmax_t);
+            else word = (uint64_t)va_arg(ap, unsigned int);
+            break;
+        case 'c':
+            word = (uint64_t)va_arg(ap, int);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double value = spec.length[0] == 'L' ? (double)va_arg(ap, long double) : va_arg(ap, double);
+            memcpy(&word, &value, sizeof(word));
+            break;
+        }
+        case 'p':
+            word = (uint64_t)(uintptr_t)va_arg(ap, void *);
+            break;
+        case 's': {
+            // 문자열은 레코드 안에 복사: 상위 32비트 = 오프셋, 하위 32비트 = 길이
+            const char *str = va_arg(ap, const char *);
+            size_t len = 0;
+            if (!str) str = "(null)";
+            size_t limit = precision >= 0 ? (size_t)precision : SIZE_MAX;
+            size_t room = LOG_STRBUF_SIZE - rec->str_used;
+            while (len < limit && str[len] && len < room) len++;
+            if (len == room && len < limit && str[len]) rec->overflow = 1;
+            memcpy(rec->strbuf + rec->str_used, str, len);
+            word = ((uint64_t)rec->str_used << 32) | len;
+            rec->str_used += (uint16_t)len;
+            break;
+        }
+        default:
+            // 지원하지 않는 변환 (%n 등): 이후 인자는 해석하지 않음
+            rec->overflow = 1;
+            return;
+        }
+        if (rec->nargs < LOG_MAX_ARGS) {
+            rec->args[rec->nargs++] = word;
+        } else {
+            rec->overflow = 1;
+        }
+    }
+}
+
+// 레코드 → 한 줄 텍스트 (반환: 길이, 줄바꿈 포함)
+static size_t format_record(const LogRecord *rec, char *out, size_t size) {
+    time_t sec = (time_t)(rec->ts_ns / 1000000000ULL);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    int len = snprintf(out, size, "%02d:%02d:%02d.%06lu %-5s ", tm.tm_hour, tm.tm_min, tm.tm_sec,
+                       (unsigned long)(rec->ts_ns % 1000000000ULL / 1000), g_level_names[rec->level]);
+    size_t pos = len > 0 ? (size_t)len : 0;
+    const char *p = rec->fmt;
+    int arg = 0;
+
+    while (*p && pos < size - 2) {
+        if (*p != '%') {
+            out[pos++] = *p++;
+            continue;
+        }
+        LogSpec spec;
+        p = parse_spec(p + 1, &spec);
+        if (spec.conv == '%') {
+            out[pos++] = '%';
+            continue;
+        }
+        if (spec.conv == '\0') {
+            break;
+        }
+
+        int width = spec.width;
+        int precision = spec.precision;
+        if (width == -2) width = arg < rec->nargs ? (int)(int64_t)rec->args[arg++] : -1;
+        if (precision == -2) precision = arg < rec->nargs ? (int)(int64_t)rec->args[arg++] : -1;
+        if (arg >= rec->nargs) {
+            break;
+        }
+        uint64_t word = rec->args[arg++];
+
+        // 명세를 숫자로 다시 조립해 인자 하나만 서식화
+        char fmt_one[32];
+        int n = snprintf(fmt_one, sizeof(fmt_one), "%%%s", spec.flags);
+        if (width >= 0) n += snprintf(fmt_one + n, sizeof(fmt_one) - n, "%d", width);
+        if (precision >= 0 && spec.conv != 's') n += snprintf(fmt_one + n, sizeof(fmt_one) - n, ".%d", precision);
+
+        size_t room = size - 1 - pos;
+        int written = 0;
+        switch (spec.conv) {
+        case 'd': case 'i':
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, "lld");
+            written = snprintf(out + pos, room, fmt_one, (long long)(int64_t)word);
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, "ll%c", spec.conv);
+            // 부호 없는 값은 원래 폭으로 잘라야 같은 결과 (%x에 -1 등)
+            if (spec.length[0] == '\0' || spec.length[0] == 'h') word &= 0xFFFFFFFFULL;
+            written = snprintf(out + pos, room, fmt_one, (unsigned long long)word);
+            break;
+        case 'c':
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, "c");
+            written = snprintf(out + pos, room, fmt_one, (int)word);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            double value;
+            memcpy(&value, &word, sizeof(value));
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, "%c", spec.conv);
+            written = snprintf(out + pos, room, fmt_one, value);
+            break;
+        }
+        case 'p':
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, "p");
+            written = snprintf(out + pos, room, fmt_one, (void *)(uintptr_t)word);
+            break;
+        case 's':
+            snprintf(fmt_one + n, sizeof(fmt_one) - n, ".*s");
+            written = snprintf(out + pos, room, fmt_one, (int)(word & 0xFFFFFFFFULL),
+                               rec->strbuf + (word >> 32));
+            break;
+        default:
+            break;
+        }
+        if (written > 0) {
+            pos += (size_t)written < room ? (size_t)written : room;
+        }
+    }
+    if (rec->overflow && pos + 3 < size - 1) {
+        memcpy(out + pos, "...", 3);
+        pos += 3;
+    }
+    // 서식 문자열 끝의 줄바꿈은 하나로 정리
+    while (pos > 0 && out[pos - 1] == '\n') pos--;
+    out[pos++] = '\n';
+    out[pos] = '\0';
+    return pos;
+}
+
+static void fill_record(LogRecord *rec, int level, const char *fmt, va_list ap) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rec->ts_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    rec->fmt = fmt;
+    rec->level = (uint8_t)level;
+    encode_args(rec, fmt, ap);
+}
+
+// 스레드 종료 시 링 닫기 (로거 스레드가 비운 뒤 해제)
+static void close_ring(void *ring) {
+    __atomic_store_n(&((LogRing *)ring)->closed, 1, __ATOMIC_RELEASE);
+}
+
+// 현재 스레드의 링 (처음 쓸 때 만들어 등록, 실패하면 NULL)
+static LogRing *thread_ring(void) {
+    if (t_log_ring) {
+        return t_log_ring;
+    }
+    LogRing *ring = calloc(1, sizeof(LogRing));
+    if (!ring) {
+        return NULL;
+    }
+    ring->records = malloc(sizeof(LogRecord) * LOG_RING_RECORDS);
+    if (!ring->records) {
+        free(ring);
+        return NULL;
+    }
+    pthread_mutex_lock(&g_log.lock);
+    ring->next = g_log.rings;
+    g_log.rings = ring;
+    pthread_mutex_unlock(&g_log.lock);
+    pthread_setspecific(g_log.ring_key, ring);
+
+    t_log_ring = ring;
+    return ring;
+}
+
+// fork 직후 자식 (fork한 스레드만 남음): 부모의 링과 로거 스레드는 자식 것이 아니므로
+// 로거를 멈춘 상태로 되돌려 동기 출력으로 전환 (다시 쓰려면 log_start)
+static void reset_after_fork(void) {
+    pthread_mutex_init(&g_log.lock, NULL);
+    pthread_cond_init(&g_log.wake, NULL);
+    pthread_cond_init(&g_log.flushed, NULL);
+    g_log.running = 0;
+    g_log.rings = NULL;
+    t_log_ring = NULL;
+}
+
+void log_write(int level, const char *fmt, ...) {
+    if (level > __atomic_load_n(&g_log_level, __ATOMIC_RELAXED) || !fmt) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    LogRing *ring = __atomic_load_n(&g_log.running, __ATOMIC_ACQUIRE) ? thread_ring() : NULL;
+    if (!ring) {
+        // 로거가 없으면 같은 서식으로 바로 출력
+        LogRecord rec;
+        char line[LOG_RECORD_SIZE * 2];
+        fill_record(&rec, level, fmt, ap);
+        va_end(ap);
+        fwrite(line, 1, format_record(&rec, line, sizeof(line)), stdout);
+        return;
+    }
+
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= LOG_RING_RECORDS) {
+        // 링이 가득 차면 기다리지 않고 버림
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        va_end(ap);
+        return;
+    }
+    fill_record(&ring->records[head & (LOG_RING_RECORDS - 1)], level, fmt, ap);
+    va_end(ap);
+    ring->written++;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// 모든 링을 시간순으로 비우며 출력 (로거 스레드 전용, g_log.lock 보유 상태)
+static size_t drain_rings(char *out, size_t size) {
+    size_t pos = 0;
+    size_t count = 0;
+
+    for (;;) {
+        LogRing *oldest = NULL;
+        uint64_t oldest_ts = UINT64_MAX;
+        for (LogRing *ring = g_log.rings; ring; ring = ring->next) {
+            uint64_t tail = ring->tail;
+            if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+                continue;
+            }
+            uint64_t ts = ring->records[tail & (LOG_RING_RECORDS - 1)].ts_ns;
+            if (ts < oldest_ts) {
+                oldest_ts = ts;
+                oldest = ring;
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        if (size - pos < LOG_RECORD_SIZE * 2) {
+            fwrite(out, 1, pos, stdout);
+            pos = 0;
+        }
+        pos += format_record(&oldest->records[oldest->tail & (LOG_RING_RECORDS - 1)], out + pos, size - pos);
+        __atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+    if (pos > 0) {
+        fwrite(out, 1, pos, stdout);
+    }
+    if (count > 0) {
+        fflush(stdout);
+    }
+
+    // 종료된 스레드의 빈 링 해제
+    LogRing **link = &g_log.rings;
+    while (*link) {
+        LogRing *ring = *link;
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) &&
+            ring->tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+            *link = ring->next;
+            g_log.retired_written += ring->written;
+            g_log.retired_dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+            free(ring->records);
+            free(ring);
+            continue;
+        }
+        link = &ring->next;
+    }
+    return count;
+}
+
+static void *log_thread_main(void *arg) {
+    (void)arg;
+    static char out[LOG_OUT_BUFFER_SIZE];
+
+    pthread_mutex_lock(&g_log.lock);
+    for (;;) {
+        uint64_t requested = g_log.flush_requested;
+        int stopping = g_log.stopping;
+        size_t count = drain_rings(out, sizeof(out));
+
+        if (g_log.flush_done < requested) {
+            g_log.flush_done = requested;
+            pthread_cond_broadcast(&g_log.flushed);
+        }
+        if (stopping && count == 0) {
+            break;
+        }
+        if (count == 0 && g_log.flush_requested == requested) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += LOG_IDLE_WAIT_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_log.wake, &g_log.lock, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&g_log.lock);
+    return NULL;
+}
+
+// 로거 스레드 시작 (fork 후 각 프로세스에서 호출, 종료 시 자동으로 비움)
+int log_start(void) {
+    if (g_log.running) {
+        return 0;
+    }
+    if (!g_log.key_ready) {
+        if (pthread_key_create(&g_log.ring_key, close_ring) != 0) {
+            return -1;
+        }
+        pthread_atfork(NULL, NULL, reset_after_fork);
+        g_log.key_ready = 1;
+    }
+    g_log.stopping = 0;
+    g_log.flush_requested = 0;
+    g_log.flush_done = 0;
+
+    // 로거 스레드는 시그널을 받지 않도록 모두 막은 상태로 생성
+    sigset_t all;
+    sigset_t old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int rc = pthread_create(&g_log.thread, NULL, log_thread_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        printf("Logger: Failed to start logging thread, writing synchronously\n");
+        return -1;
+    }
+
+    __atomic_store_n(&g_log.running, 1, __ATOMIC_RELEASE);
+    atexit(log_stop);
+    return 0;
+}
+
+// 지금까지 기록한 로그가 모두 출력될 때까지 대기
+void log_flush(void) {
+    if (!__atomic_load_n(&g_log.running, __ATOMIC_ACQUIRE)) {
+        fflush(stdout);
+        return;
+    }
+    pthread_mutex_lock(&g_log.lock);
+    uint64_t target = ++g_log.flush_requested;
+    pthread_cond_signal(&g_log.wake);
+    while (g_log.flush_done < target && !g_log.stopping) {
+        pthread_cond_wait(&g_log.flushed, &g_log.lock);
+    }
+    pthread_mutex_unlock(&g_log.lock);
+}
+
+// 남은 로그를 출력하고 로거 스레드 종료 (이후 로그는 동기 출력)
+void log_stop(void) {
+    if (!__atomic_load_n(&g_log.running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&g_log.lock);
+    g_log.stopping = 1;
+    pthread_cond_signal(&g_log.wake);
+    pthread_cond_broadcast(&g_log.flushed);
+    pthread_mutex_unlock(&g_log.lock);
+
+    pthread_join(g_log.thread, NULL);
+    __atomic_store_n(&g_log.running, 0, __ATOMIC_RELEASE);
+    fflush(stdout);
+}
+
+// 기록/버림 통계 (살아 있는 링 + 해제한 링)
+void log_get_stats(LogStats *stats) {
+    memset(stats, 0, sizeof(LogStats));
+    pthread_mutex_lock(&g_log.lock);
+    stats->written = g_log.retired_written;
+    stats->dropped = g_log.retired_dropped;
+    for (LogRing *ring = g_log.rings; ring; ring = ring->next) {
+        stats->written += __atomic_load_n(&ring->written, __ATOMIC_RELAXED);
+        stats->dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&g_log.lock);
+}
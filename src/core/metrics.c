@@ -0,0 +1,368 @@
+#include "../mqtt.h"
+#include <sys/mman.h>
+
+// 단계별 지연 히스토그램과 카운터
+// fork 전에 공유 메모리에 만들어 구독/발행 프로세스가 같은 통계에 기록함
+// 기록은 원자적 덧셈 몇 번뿐이라 운영 중에도 켜 둘 수 있음
+// 히스토그램은 HDR 방식: 2의 거듭제곱 구간마다 16칸 (상대 오차 6.25% 이내)
+
+#define METRIC_SUB_BUCKETS (1 << METRIC_HIST_SUB_BITS)
+
+// 지연 히스토그램 (ns 단위, count는 스냅샷 때 버킷 합으로 계산)
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[METRIC_HIST_BUCKETS];
+} MetricHistogram;
+
+// 공유 메모리에 두는 전체 통계
+typedef struct {
+    uint64_t start_ns;
+    uint64_t counters[METRIC_COUNTER_COUNT];
+    MetricHistogram stages[METRIC_STAGE_COUNT];
+    int device_count;
+    char device_names[MAX_METRIC_DEVICES][64];
+    MetricHistogram devices[MAX_METRIC_DEVICES];
+} MetricsShared;
+
+static MetricsShared *g_metrics = NULL;
+static char g_metrics_topic[MAX_TOPIC_LEN];
+static char g_metrics_file[MAX_STRING_LEN];
+static char g_metrics_client_id[MAX_STRING_LEN];
+static int g_metrics_queue_id = -1;
+static int g_metrics_reporting = 0;         // metrics_interval_ms > 0
+
+static const char *g_stage_names[METRIC_STAGE_COUNT] = {
+    "receive", "ipc_wait", "dispatch", "executor_wait", "handler", "publish", "puback",
+    "reconnect", "compress", "decompress"
+};
+
+static const char *g_counter_names[METRIC_COUNTER_COUNT] = {
+    "messages_received", "control_forwarded", "ipc_send_failed", "commands_dispatched",
+    "commands_scheduled", "unknown_device", "unknown_device_id", "executor_rejected",
+    "connections_lost", "reconnect_attempts", "sessions_resumed", "telemetry_samples",
+    "telemetry_published", "cbor_commands", "cbor_invalid", "cbor_oversize", "payloads_compressed",
+    "compress_skipped", "compress_bytes_in", "compress_bytes_out", "payloads_inflated", "inflate_invalid"
+};
+
+// Prometheus 버킷 경계 (초)
+static const double g_prom_bounds[] = {
+    0.000001, 0.000005, 0.00001, 0.00005, 0.0001, 0.0005, 0.001,
+    0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 30.0, 120.0
+};
+#define PROM_BOUND_COUNT ((int)(sizeof(g_prom_bounds) / sizeof(g_prom_bounds[0])))
+
+// 공유 통계 생성 (fork 전에 한 번 호출, 실패하면 기록 없이 동작)
+int metrics_init(const MQTTConfig *config, int msg_queue_id) {
+    if (!g_metrics) {
+        void *mem = mmap(NULL, sizeof(MetricsShared), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            perror("Metrics: mmap failed");
+            return -1;
+        }
+        g_metrics = mem;
+    }
+    memset(g_metrics, 0, sizeof(MetricsShared));
+    g_metrics->start_ns = monotonic_time_ns();
+    g_metrics_queue_id = msg_queue_id;
+
+    if (config) {
+        snprintf(g_metrics_client_id, sizeof(g_metrics_client_id), "%s", config->client_id);
+        if (config->metrics_topic[0] != '\0') {
+            snprintf(g_metrics_topic, sizeof(g_metrics_topic), "%s", config->metrics_topic);
+        } else {
+            snprintf(g_metrics_topic, sizeof(g_metrics_topic), "metrics/%.*s",
+                     (int)sizeof(g_metrics_topic) - 9, config->client_id);
+        }
+        snprintf(g_metrics_file, sizeof(g_metrics_file), "%s", config->metrics_file);
+        g_metrics_reporting = config->metrics_interval_ms > 0;
+    }
+    return 0;
+}
+
+// 값 → 버킷 번호 (16 미만은 그대로, 이후 구간마다 상위 4비트로 16칸)
+static int metrics_bucket(uint64_t value) {
+    if (value < METRIC_SUB_BUCKETS) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int index = (msb - METRIC_HIST_SUB_BITS + 1) * METRIC_SUB_BUCKETS +
+                (int)((value >> (msb - METRIC_HIST_SUB_BITS)) & (METRIC_SUB_BUCKETS - 1));
+    return index < METRIC_HIST_BUCKETS ? index : METRIC_HIST_BUCKETS - 1;
+}
+
+// 버킷이 담는 가장 큰 값
+static uint64_t metrics_bucket_upper(int index) {
+    if (index < METRIC_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int shift = index / METRIC_SUB_BUCKETS - 1;
+    uint64_t sub = (uint64_t)(index % METRIC_SUB_BUCKETS);
+    return ((METRIC_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+static void histogram_record(MetricHistogram *hist, uint64_t value_ns) {
+    __atomic_fetch_add(&hist->buckets[metrics_bucket(value_ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->sum_ns, value_ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+    while (value_ns > max &&
+           !__atomic_compare_exchange_n(&hist->max_ns, &max, value_ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// 단계 지연 기록
+void metrics_record(int stage, uint64_t elapsed_ns) {
+    if (g_metrics && stage >= 0 && stage < METRIC_STAGE_COUNT) {
+        histogram_record(&g_metrics->stages[stage], elapsed_ns);
+    }
+}
+
+// 디바이스별 핸들러 실행 시간 기록 (slot은 metrics_device_slot 반환값)
+void metrics_record_device(int slot, uint64_t elapsed_ns) {
+    if (g_metrics && slot >= 0 && slot < MAX_METRIC_DEVICES) {
+        histogram_record(&g_metrics->devices[slot], elapsed_ns);
+    }
+}
+
+void metrics_count(int counter) {
+    if (g_metrics && counter >= 0 && counter < METRIC_COUNTER_COUNT) {
+        __atomic_fetch_add(&g_metrics->counters[counter], 1, __ATOMIC_RELAXED);
+    }
+}
+
+// 카운터에 value만큼 더함 (바이트 합계 등)
+void metrics_add(int counter, uint64_t value) {
+    if (g_metrics && counter >= 0 && counter < METRIC_COUNTER_COUNT) {
+        __atomic_fetch_add(&g_metrics->counters[counter], value, __ATOMIC_RELAXED);
+    }
+}
+
+// 디바이스 히스토그램 자리 조회/할당 (실행기 생성 시 한 번, 디스패치 스레드 전용)
+int metrics_device_slot(const char *device) {
+    if (!g_metrics || !device) {
+        return -1;
+    }
+    int count = __atomic_load_n(&g_metrics->device_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(g_metrics->device_names[i], device) == 0) {
+            return i;
+        }
+    }
+    if (count >= MAX_METRIC_DEVICES) {
+        return -1;
+    }
+    strncpy(g_metrics->device_names[count], device, sizeof(g_metrics->device_names[count]) - 1);
+    __atomic_store_n(&g_metrics->device_count, count + 1, __ATOMIC_RELEASE);
+    return count;
+}
+
+// 히스토그램 사본 (기록 중에도 읽을 수 있도록 칸별 원자적 읽기)
+static void histogram_copy(const MetricHistogram *src, MetricHistogram *dst) {
+    dst->count = 0;
+    for (int i = 0; i < METRIC_HIST_BUCKETS; i++) {
+        dst->buckets[i] = __atomic_load_n(&src->buckets[i], __ATOMIC_RELAXED);
+        dst->count += dst->buckets[i];
+    }
+    dst->sum_ns = __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+    dst->max_ns = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+}
+
+// 백분위 값 (ns, 해당 버킷의 상한)
+static uint64_t histogram_percentile(const MetricHistogram *hist, double percentile) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)hist->count + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < METRIC_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = metrics_bucket_upper(i);
+            return upper < hist->max_ns ? upper : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+// 압축한 결과의 평균 압축률 (압축 전 / 후 바이트, 압축한 적 없으면 1)
+static double metrics_compress_ratio(void) {
+    uint64_t in = __atomic_load_n(&g_metrics->counters[METRIC_COMPRESS_BYTES_IN], __ATOMIC_RELAXED);
+    uint64_t out = __atomic_load_n(&g_metrics->counters[METRIC_COMPRESS_BYTES_OUT], __ATOMIC_RELAXED);
+    return out > 0 ? (double)in / (double)out : 1.0;
+}
+
+// 히스토그램 요약 JSON ({"count":..,"p50_us":..})
+static size_t append_histogram_json(char *buf, size_t size, size_t len, const char *name,
+                                    const MetricHistogram *hist) {
+    if (len >= size) {
+        return len;
+    }
+    int n = snprintf(buf + len, size - len,
+                     "%s\"%s\":{\"count\":%llu,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,"
+                     "\"p999_us\":%.1f,\"max_us\":%.1f}",
+                     buf[len - 1] == '{' ? "" : ",", name, (unsigned long long)hist->count,
+                     hist->count ? (double)hist->sum_ns / (double)hist->count / 1000.0 : 0.0,
+                     histogram_percentile(hist, 50.0) / 1000.0, histogram_percentile(hist, 99.0) / 1000.0,
+                     histogram_percentile(hist, 99.9) / 1000.0, hist->max_ns / 1000.0);
+    return n > 0 ? len + (size_t)n : len;
+}
+
+// 통계 스냅샷 JSON 생성 (반환: 길이, 버퍼가 모자라면 -1)
+int metrics_snapshot_json(char *buf, size_t size) {
+    static MetricHistogram hist;
+    if (!g_metrics || size < 2) {
+        return -1;
+    }
+
+    PublishStats pub_stats;
+    IPCStats ipc_stats;
+    LogStats log_stats;
+    publisher_get_stats(&pub_stats);
+    ipc_get_stats(g_metrics_queue_id, &ipc_stats);
+    log_get_stats(&log_stats);
+
+    int n = snprintf(buf, size, "{\"client_id\":\"%s\",\"uptime_s\":%llu,\"counters\":{",
+                     g_metrics_client_id,
+                     (unsigned long long)((monotonic_time_ns() - g_metrics->start_ns) / 1000000000ULL));
+    size_t len = n > 0 ? (size_t)n : 0;
+    for (int i = 0; i < METRIC_COUNTER_COUNT && len < size; i++) {
+        n = snprintf(buf + len, size - len, "%s\"%s\":%llu", i ? "," : "", g_counter_names[i],
+                     (unsigned long long)__atomic_load_n(&g_metrics->counters[i], __ATOMIC_RELAXED));
+        len += n > 0 ? (size_t)n : 0;
+    }
+    if (len < size) {
+        n = snprintf(buf + len, size - len,
+                     ",\"ipc_dropped\":%llu,\"results_published\":%llu,\"results_delivered\":%llu,"
+                     "\"publish_failed\":%llu,\"publish_dropped\":%llu,\"publish_expired\":%llu,\"publish_retried\":%llu,"
+                     "\"log_dropped\":%llu},"
+                     "\"gauges\":{\"ipc_queue_depth\":%llu,\"publish_queue_depth\":%d,\"publish_inflight\":%d,"
+                     "\"compress_ratio\":%.2f},"
+                     "\"stages\":{",
+                     (unsigned long long)ipc_stats.dropped, (unsigned long long)pub_stats.published,
+                     (unsigned long long)pub_stats.delivered, (unsigned long long)pub_stats.failed,
+                     (unsigned long long)pub_stats.dropped, (unsigned long long)pub_stats.expired,
+                     (unsigned long long)pub_stats.retried, (unsigned long long)log_stats.dropped, (unsigned long long)ipc_stats.depth_messages,
+                     pub_stats.queue_depth, pub_stats.inflight, metrics_compress_ratio());
+        len += n > 0 ? (size_t)n : 0;
+    }
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+        histogram_copy(&g_metrics->stages[i], &hist);
+        len = append_histogram_json(buf, size, len, g_stage_names[i], &hist);
+    }
+    if (len + 14 < size) {
+        memcpy(buf + len, "},\"devices\":{", 14);
+        len += 13;
+    }
+    int device_count = __atomic_load_n(&g_metrics->device_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < device_count; i++) {
+        histogram_copy(&g_metrics->devices[i], &hist);
+        len = append_histogram_json(buf, size, len, g_metrics->device_names[i], &hist);
+    }
+    if (len + 3 > size) {
+        return -1;
+    }
+    memcpy(buf + len, "}}", 3);
+    return (int)(len + 2);
+}
+
+// Prometheus 히스토그램 하나 출력 (le 경계 이하 버킷 누적)
+static void write_prometheus_histogram(FILE *file, const char *metric, const char *label,
+                                       const char *value, const MetricHistogram *hist) {
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int b = 0; b < PROM_BOUND_COUNT; b++) {
+        uint64_t bound_ns = (uint64_t)(g_prom_bounds[b] * 1e9 + 0.5);
+        while (bucket < METRIC_HIST_BUCKETS && metrics_bucket_upper(bucket) <= bound_ns) {
+            cumulative += hist->buckets[bucket++];
+        }
+        fprintf(file, "%s_bucket{%s=\"%s\",le=\"%g\"} %llu\n", metric, label, value, g_prom_bounds[b],
+                (unsigned long long)cumulative);
+    }
+    fprintf(file, "%s_bucket{%s=\"%s\",le=\"+Inf\"} %llu\n", metric, label, value, (unsigned long long)hist->count);
+    fprintf(file, "%s_sum{%s=\"%s\"} %.9f\n", metric, label, value, (double)hist->sum_ns / 1e9);
+    fprintf(file, "%s_count{%s=\"%s\"} %llu\n", metric, label, value, (unsigned long long)hist->count);
+}
+
+// Prometheus 텍스트 형식으로 파일 저장 (임시 파일에 쓴 뒤 rename으로 교체)
+int metrics_write_prometheus(const char *path) {
+    static MetricHistogram hist;
+    char tmp_path[MAX_STRING_LEN + 8];
+    if (!g_metrics || !path || path[0] == '\0') {
+        return -1;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) {
+        log_error("Metrics: Cannot open '%s' for writing", tmp_path);
+        return -1;
+    }
+
+    PublishStats pub_stats;
+    IPCStats ipc_stats;
+    LogStats log_stats;
+    publisher_get_stats(&pub_stats);
+    ipc_get_stats(g_metrics_queue_id, &ipc_stats);
+    log_get_stats(&log_stats);
+
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        fprintf(file, "# TYPE mqtt_%s_total counter\nmqtt_%s_total %llu\n", g_counter_names[i], g_counter_names[i],
+                (unsigned long long)__atomic_load_n(&g_metrics->counters[i], __ATOMIC_RELAXED));
+    }
+    fprintf(file, "# TYPE mqtt_ipc_dropped_total counter\nmqtt_ipc_dropped_total %llu\n",
+            (unsigned long long)ipc_stats.dropped);
+    fprintf(file, "# TYPE mqtt_results_published_total counter\nmqtt_results_published_total %llu\n",
+            (unsigned long long)pub_stats.published);
+    fprintf(file, "# TYPE mqtt_results_delivered_total counter\nmqtt_results_delivered_total %llu\n",
+            (unsigned long long)pub_stats.delivered);
+    fprintf(file, "# TYPE mqtt_publish_failed_total counter\nmqtt_publish_failed_total %llu\n",
+            (unsigned long long)pub_stats.failed);
+    fprintf(file, "# TYPE mqtt_publish_dropped_total counter\nmqtt_publish_dropped_total %llu\n",
+            (unsigned long long)(pub_stats.dropped + pub_stats.expired));
+    fprintf(file, "# TYPE mqtt_publish_retried_total counter\nmqtt_publish_retried_total %llu\n",
+            (unsigned long long)pub_stats.retried);
+    fprintf(file, "# TYPE mqtt_log_dropped_total counter\nmqtt_log_dropped_total %llu\n",
+            (unsigned long long)log_stats.dropped);
+    fprintf(file, "# TYPE mqtt_ipc_queue_depth gauge\nmqtt_ipc_queue_depth %llu\n",
+            (unsigned long long)ipc_stats.depth_messages);
+    fprintf(file, "# TYPE mqtt_publish_queue_depth gauge\nmqtt_publish_queue_depth %d\n", pub_stats.queue_depth);
+    fprintf(file, "# TYPE mqtt_publish_inflight gauge\nmqtt_publish_inflight %d\n", pub_stats.inflight);
+    fprintf(file, "# TYPE mqtt_compress_ratio gauge\nmqtt_compress_ratio %.3f\n", metrics_compress_ratio());
+
+    fprintf(file, "# TYPE mqtt_stage_latency_seconds histogram\n");
+    for (int i = 0; i < METRIC_STAGE_COUNT; i++) {
+        histogram_copy(&g_metrics->stages[i], &hist);
+        write_prometheus_histogram(file, "mqtt_stage_latency_seconds", "stage", g_stage_names[i], &hist);
+    }
+    fprintf(file, "# TYPE mqtt_device_handler_seconds histogram\n");
+    int device_count = __atomic_load_n(&g_metrics->device_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < device_count; i++) {
+        histogram_copy(&g_metrics->devices[i], &hist);
+        write_prometheus_histogram(file, "mqtt_device_handler_seconds", "device", g_metrics->device_names[i], &hist);
+    }
+
+    if (fclose(file) != 0 || rename(tmp_path, path) != 0) {
+        log_error("Metrics: Failed to write '%s'", path);
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// 주기 보고: metrics/<client_id> 토픽 발행 + Prometheus 파일 갱신
+void metrics_report(void) {
+    static char snapshot[METRICS_SNAPSHOT_SIZE];
+    if (!g_metrics || !g_metrics_reporting) {
+        return;
+    }
+    if (metrics_snapshot_json(snapshot, sizeof(snapshot)) > 0) {
+        send_result_to_topic(g_metrics_topic, snapshot);
+    } else {
+        log_warn("Metrics: Snapshot larger than %d bytes, not published", METRICS_SNAPSHOT_SIZE);
+    }
+    if (g_metrics_file[0] != '\0') {
+        metrics_write_prometheus(g_metrics_file);
+    }
+}
@@ -0,0 +1,127 @@
+#include "../mqtt.h"
+
+// 우선순위 규칙 (device/command 패턴 -> 레인), "*"는 모든 값과 일치
+typedef struct {
+    char device[64];
+    char command[64];
+    int lane;
+} PriorityRule;
+
+static PriorityRule g_rules[MAX_PRIORITY_RULES];
+static int g_rule_count = 0;
+static int g_defaults_loaded = 0;
+
+static const char *g_lane_names[IPC_LANE_COUNT] = { "high", "normal", "low" };
+
+// 레인 이름 -> 번호 (알 수 없으면 -1)
+int priority_lane_from_name(const char *name) {
+    for (int i = 0; i < IPC_LANE_COUNT; i++) {
+        if (strcmp(name, g_lane_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 레인 번호 -> 이름
+const char *priority_lane_name(int lane) {
+    if (lane < 0 || lane >= IPC_LANE_COUNT) {
+        return "unknown";
+    }
+    return g_lane_names[lane];
+}
+
+// 같은 패턴이 있으면 덮어쓰고 없으면 추가
+static int priority_set_rule(const char *device, const char *command, int lane) {
+    for (int i = 0; i < g_rule_count; i++) {
+        if (strcmp(g_rules[i].device, device) == 0 && strcmp(g_rules[i].command, command) == 0) {
+            g_rules[i].lane = lane;
+            return 0;
+        }
+    }
+    if (g_rule_count >= MAX_PRIORITY_RULES) {
+        log_warn("Warning: Too many priority rules (max %d)", MAX_PRIORITY_RULES);
+        return -1;
+    }
+
+    PriorityRule *rule = &g_rules[g_rule_count++];
+    strncpy(rule->device, device, sizeof(rule->device) - 1);
+    rule->device[sizeof(rule->device) - 1] = '\0';
+    strncpy(rule->command, command, sizeof(rule->command) - 1);
+    rule->command[sizeof(rule->command) - 1] = '\0';
+    rule->lane = lane;
+    return 0;
+}
+
+// 기본 규칙: 끄기 명령은 high, 오래 걸리는 test/calibrate는 low
+static void priority_load_defaults(void) {
+    if (g_defaults_loaded) {
+        return;
+    }
+    g_defaults_loaded = 1;
+    priority_set_rule("*", "off", IPC_LANE_HIGH);
+    priority_set_rule("s_segment", "clear", IPC_LANE_HIGH);
+    priority_set_rule("s_segment", "test", IPC_LANE_LOW);
+    priority_set_rule("photoresistor", "calibrate", IPC_LANE_LOW);
+}
+
+// 설정 파일 규칙 추가 (형식: <device>/<command>:<high|normal|low>)
+int priority_add_rule(const char *spec) {
+    char device[64];
+    char command[64];
+    char lane_name[16];
+
+    priority_load_defaults();
+
+    if (!spec || sscanf(spec, "%63[^/]/%63[^:]:%15s", device, command, lane_name) != 3) {
+        log_warn("Warning: Invalid priority rule '%s' (expected device/command:lane)", spec ? spec : "");
+        return -1;
+    }
+
+    int lane = priority_lane_from_name(lane_name);
+    if (lane < 0) {
+        log_warn("Warning: Unknown priority lane '%s' in rule '%s'", lane_name, spec);
+        return -1;
+    }
+    return priority_set_rule(device, command, lane);
+}
+
+// 명령의 레인 결정 (가장 구체적인 규칙 우선: device+command > device+* > *+command)
+// 토픽 뷰를 그대로 비교하므로 디바이스/명령 문자열을 따로 복사하지 않음
+int priority_classify(const ParsedTopic *topic_info) {
+    int best_lane = IPC_LANE_NORMAL;
+    int best_score = 0;
+
+    priority_load_defaults();
+
+    if (!topic_info || !topic_info->is_valid) {
+        return best_lane;
+    }
+
+    const char *topic = topic_info->topic;
+    for (int i = 0; i < g_rule_count; i++) {
+        const PriorityRule *rule = &g_rules[i];
+        int device_any = strcmp(rule->device, "*") == 0;
+        int command_any = strcmp(rule->command, "*") == 0;
+
+        if (!device_any && !topic_level_is(topic, topic_info->target_device, rule->device)) continue;
+        if (!command_any && !topic_level_is(topic, topic_info->command, rule->command)) continue;
+
+        int score = (device_any ? 0 : 2) + (command_any ? 0 : 1) + 1;
+        if (score > best_score) {
+            best_score = score;
+            best_lane = rule->lane;
+        }
+    }
+    return best_lane;
+}
+
+// 규칙 목록 출력
+void print_priority_rules(void) {
+    priority_load_defaults();
+    printf("Priority rules:\n");
+    for (int i = 0; i < g_rule_count; i++) {
+        printf("  - %s/%s -> %s\n", g_rules[i].device, g_rules[i].command,
+               priority_lane_name(g_rules[i].lane));
+    }
+}
@@ -0,0 +1,172 @@
+#include "../mqtt.h"
+
+// 리액터 초기화 (epoll 인스턴스 생성)
+int reactor_init(Reactor *reactor) {
+    if (!reactor) {
+        return -1;
+    }
+
+    memset(reactor, 0, sizeof(Reactor));
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epoll_fd == -1) {
+        perror("Reactor: epoll_create1 failed");
+        return -1;
+    }
+    return 0;
+}
+
+// 핸들러 등록 공통 처리 (owned이면 reactor_cleanup에서 fd를 닫음)
+static int reactor_register(Reactor *reactor, int fd, reactor_callback_t callback,
+                            void *context, int owned) {
+    if (!reactor || fd < 0 || !callback) {
+        return -1;
+    }
+    if (reactor->handler_count >= MAX_REACTOR_HANDLERS) {
+        log_error("Reactor: Too many handlers registered (max %d)", MAX_REACTOR_HANDLERS);
+        return -1;
+    }
+
+    ReactorHandler *handler = &reactor->handlers[reactor->handler_count];
+    handler->fd = fd;
+    handler->callback = callback;
+    handler->context = context;
+    handler->owned = owned;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = handler;
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("Reactor: epoll_ctl ADD failed");
+        return -1;
+    }
+
+    reactor->handler_count++;
+    return 0;
+}
+
+// 파일 디스크립터를 리액터에 등록 (fd는 호출자가 소유)
+int reactor_add_fd(Reactor *reactor, int fd, reactor_callback_t callback, void *context) {
+    return reactor_register(reactor, fd, callback, context, 0);
+}
+
+// 종료 시그널을 signalfd로 받도록 등록 (해당 시그널은 블록됨)
+int reactor_add_signals(Reactor *reactor, const int *signals, int count,
+                        reactor_callback_t callback, void *context) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int i = 0; i < count; i++) {
+        sigaddset(&mask, signals[i]);
+    }
+
+    // 비동기 시그널 핸들러 대신 signalfd로 전달되도록 블록
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1) {
+        perror("Reactor: sigprocmask failed");
+        return -1;
+    }
+
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (sfd == -1) {
+        perror("Reactor: signalfd failed");
+        return -1;
+    }
+
+    if (reactor_register(reactor, sfd, callback, context, 1) != 0) {
+        close(sfd);
+        return -1;
+    }
+    return sfd;
+}
+
+// 주기 타이머를 timerfd로 등록 (interval_ms 마다 콜백 호출)
+int reactor_add_timer(Reactor *reactor, long interval_ms,
+                      reactor_callback_t callback, void *context) {
+    if (interval_ms <= 0) {
+        return -1;
+    }
+
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd == -1) {
+        perror("Reactor: timerfd_create failed");
+        return -1;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(tfd, 0, &spec, NULL) == -1) {
+        perror("Reactor: timerfd_settime failed");
+        close(tfd);
+        return -1;
+    }
+
+    if (reactor_register(reactor, tfd, callback, context, 1) != 0) {
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+// 이벤트 루프 실행 (reactor_stop 호출 전까지 블록)
+int reactor_run(Reactor *reactor) {
+    struct epoll_event events[MAX_REACTOR_HANDLERS];
+
+    reactor->running = 1;
+    while (reactor->running) {
+        // 이벤트가 없으면 타임아웃 없이 대기 (유휴 시 CPU 사용 없음)
+        int n = epoll_wait(reactor->epoll_fd, events, MAX_REACTOR_HANDLERS, -1);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Reactor: epoll_wait failed");
+            return -1;
+        }
+
+        for (int i = 0; i < n && reactor->running; i++) {
+            ReactorHandler *handler = events[i].data.ptr;
+            handler->callback(handler->fd, events[i].events, handler->context);
+        }
+    }
+    return 0;
+}
+
+// 이벤트 루프 종료 요청
+void reactor_stop(Reactor *reactor) {
+    if (reactor) {
+        reactor->running = 0;
+    }
+}
+
+// 리액터 정리 (reactor가 만든 signalfd/timerfd만 닫음)
+void reactor_cleanup(Reactor *reactor) {
+    if (!reactor || reactor->epoll_fd < 0) {
+        return;
+    }
+    for (int i = 0; i < reactor->handler_count; i++) {
+        epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, reactor->handlers[i].fd, NULL);
+        if (reactor->handlers[i].owned) {
+            close(reactor->handlers[i].fd);
+        }
+    }
+    close(reactor->epoll_fd);
+    reactor->epoll_fd = -1;
+    reactor->handler_count = 0;
+}
+
+// eventfd/timerfd 카운터 소비 (콜백에서 호출하여 레벨 트리거 해제)
+uint64_t reactor_drain_fd(int fd) {
+    uint64_t value = 0;
+    if (read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+    }
+    return value;
+}
+
+// 단조 증가 시각 (ns), fork된 프로세스 사이에서도 비교 가능
+uint64_t monotonic_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,283 @@
+#include "../mqtt.h"
+
+// 센서 샘플 링 버퍼와 구간 통계
+// 샘플을 넣을 때 링 전체의 히스토그램과 EWMA를 바로 갱신해 두므로, 질의는 구간을 커널로
+// 한 번 훑어 합/제곱합/최소/최대를 구하고 백분위는 버킷 수만큼의 누적으로 끝남
+// 한 링은 한 스레드(디바이스의 샤드 워커)만 쓰고 읽으므로 잠금 없음
+
+#define WINDOW_KERNEL_LANES 16      // 커널 레인 수 (고정 길이 안쪽 루프라 -O2에서도 SIMD로 펴짐)
+
+struct SampleWindow {
+    int capacity;               // 2의 거듭제곱
+    int count;
+    uint32_t head;              // 다음에 쓸 칸
+    int32_t range_min;          // 히스토그램 범위 (밖의 값은 양 끝 버킷에 넣음)
+    int bucket_shift;           // 버킷 폭 = 2^bucket_shift (나눗셈 대신 시프트)
+    uint64_t base_ms;           // times[]의 기준 시각 (첫 샘플)
+    uint64_t total;             // 지금까지 넣은 샘플 수
+    double ewma;
+    uint32_t hist[SAMPLE_WINDOW_BUCKETS];
+    int32_t *values;
+    uint32_t *times;            // base_ms 기준 ms
+    int32_t data[];
+};
+
+// 구간 커널 누적값
+typedef struct {
+    int64_t sum;
+    int64_t sum_sq;
+    int32_t min;
+    int32_t max;
+} WindowAccumulator;
+
+// 연속 구간 하나의 합/제곱합/최소/최대 (레인별로 따로 모은 뒤 합침)
+static void window_kernel(const int32_t *restrict values, int n, WindowAccumulator *acc) {
+    int64_t sum[WINDOW_KERNEL_LANES] = { 0 };
+    int64_t sum_sq[WINDOW_KERNEL_LANES] = { 0 };
+    int32_t min[WINDOW_KERNEL_LANES];
+    int32_t max[WINDOW_KERNEL_LANES];
+    for (int j = 0; j < WINDOW_KERNEL_LANES; j++) {
+        min[j] = INT32_MAX;
+        max[j] = INT32_MIN;
+    }
+
+    int i = 0;
+    for (; i + WINDOW_KERNEL_LANES <= n; i += WINDOW_KERNEL_LANES) {
+        for (int j = 0; j < WINDOW_KERNEL_LANES; j++) {
+            int32_t x = values[i + j];
+            sum[j] += x;
+            sum_sq[j] += (int64_t)x * x;
+            min[j] = x < min[j] ? x : min[j];
+            max[j] = x > max[j] ? x : max[j];
+        }
+    }
+    for (int j = 0; j < WINDOW_KERNEL_LANES; j++) {
+        acc->sum += sum[j];
+        acc->sum_sq += sum_sq[j];
+        acc->min = min[j] < acc->min ? min[j] : acc->min;
+        acc->max = max[j] > acc->max ? max[j] : acc->max;
+    }
+    for (; i < n; i++) {
+        int32_t x = values[i];
+        acc->sum += x;
+        acc->sum_sq += (int64_t)x * x;
+        acc->min = x < acc->min ? x : acc->min;
+        acc->max = x > acc->max ? x : acc->max;
+    }
+}
+
+static int window_bucket(const SampleWindow *w, int32_t value) {
+    if (value < w->range_min) {
+        return 0;
+    }
+    uint32_t bucket = (uint32_t)(value - w->range_min) >> w->bucket_shift;
+    return bucket < SAMPLE_WINDOW_BUCKETS ? (int)bucket : SAMPLE_WINDOW_BUCKETS - 1;
+}
+
+// capacity는 2의 거듭제곱으로 올림, [range_min, range_max]는 백분위 히스토그램 범위
+// 구조체와 배열을 한 번에 할당하므로 free()로 해제
+SampleWindow *sample_window_create(int capacity, int32_t range_min, int32_t range_max) {
+    if (capacity < WINDOW_KERNEL_LANES) {
+        capacity = WINDOW_KERNEL_LANES;
+    }
+    if (capacity > SAMPLE_WINDOW_MAX_CAPACITY) {
+        capacity = SAMPLE_WINDOW_MAX_CAPACITY;
+    }
+    int size = WINDOW_KERNEL_LANES;
+    while (size < capacity) {
+        size *= 2;
+    }
+    if (range_max < range_min) {
+        range_max = range_min;
+    }
+
+    SampleWindow *w = calloc(1, sizeof(SampleWindow) + (size_t)size * (sizeof(int32_t) + sizeof(uint32_t)));
+    if (!w) {
+        return NULL;
+    }
+    w->capacity = size;
+    w->range_min = range_min;
+    while ((((int64_t)range_max - range_min) >> w->bucket_shift) >= SAMPLE_WINDOW_BUCKETS) {
+        w->bucket_shift++;
+    }
+    w->values = w->data;
+    w->times = (uint32_t *)(w->data + size);
+    return w;
+}
+
+// 샘플 추가 (링이 차 있으면 가장 오래된 샘플을 집계에서 빼고 덮어씀)
+void sample_window_push(SampleWindow *w, int32_t value, uint64_t now_ms) {
+    uint32_t slot = w->head & (uint32_t)(w->capacity - 1);
+    if (w->total == 0) {
+        w->base_ms = now_ms;
+        w->ewma = value;
+    }
+    if (w->count == w->capacity) {
+        w->hist[window_bucket(w, w->values[slot])]--;
+    } else {
+        w->count++;
+    }
+
+    w->values[slot] = value;
+    w->times[slot] = (uint32_t)(now_ms - w->base_ms);
+    w->head++;
+    w->total++;
+    w->hist[window_bucket(w, value)]++;
+    w->ewma += SAMPLE_WINDOW_EWMA_ALPHA * (value - w->ewma);
+}
+
+int sample_window_count(const SampleWindow *w) {
+    return w ? w->count : 0;
+}
+
+// 히스토그램에서 백분위 근사 (버킷 안에서는 선형 보간, 실제 최소/최대 밖으로는 나가지 않음)
+static double window_percentile(const SampleWindow *w, const uint32_t *hist, int count,
+                                double q, int32_t min, int32_t max) {
+    double rank = q * count;
+    uint32_t seen = 0;
+    for (int b = 0; b < SAMPLE_WINDOW_BUCKETS; b++) {
+        if (hist[b] == 0 || seen + hist[b] < rank) {
+            seen += hist[b];
+            continue;
+        }
+        double width = (double)(1u << w->bucket_shift);
+        double value = w->range_min + (b + (rank - seen) / hist[b]) * width;
+        if (value < min) {
+            return min;
+        }
+        return value > max ? max : value;
+    }
+    return max;
+}
+
+// 물리 위치 first부터 n개 샘플을 히스토그램에 더하거나(sign 1) 뺌(sign -1)
+static void window_hist_scan(const SampleWindow *w, uint32_t first, int n, uint32_t *hist, int sign) {
+    int first_len = w->capacity - (int)first < n ? w->capacity - (int)first : n;
+    for (int i = 0; i < first_len; i++) {
+        hist[window_bucket(w, w->values[first + (uint32_t)i])] += (uint32_t)sign;
+    }
+    for (int i = 0; i < n - first_len; i++) {
+        hist[window_bucket(w, w->values[i])] += (uint32_t)sign;
+    }
+}
+
+// 논리 위치 start(0 = 가장 오래된 샘플)부터 끝까지의 통계
+static int window_stats_from(const SampleWindow *w, int start, WindowStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    int n = w->count - start;
+    if (n <= 0) {
+        return 0;
+    }
+
+    uint32_t mask = (uint32_t)(w->capacity - 1);
+    uint32_t first = (w->head - (uint32_t)w->count + (uint32_t)start) & mask;
+    uint32_t last = (w->head - 1) & mask;
+    int first_len = w->capacity - (int)first < n ? w->capacity - (int)first : n;
+
+    WindowAccumulator acc = { 0, 0, INT32_MAX, INT32_MIN };
+    window_kernel(w->values + first, first_len, &acc);
+    window_kernel(w->values, n - first_len, &acc);
+
+    // 링 전체면 넣을 때 갱신해 둔 히스토그램을 그대로 쓰고, 아니면 구간과 구간 밖 중
+    // 짧은 쪽만 훑음 (구간 밖을 훑었으면 전체 히스토그램에서 뺌)
+    const uint32_t *hist = w->hist;
+    uint32_t window_hist[SAMPLE_WINDOW_BUCKETS];
+    if (start > 0) {
+        uint32_t oldest = (w->head - (uint32_t)w->count) & mask;
+        if (start < n) {
+            memcpy(window_hist, w->hist, sizeof(window_hist));
+            window_hist_scan(w, oldest, start, window_hist, -1);
+        } else {
+            memset(window_hist, 0, sizeof(window_hist));
+            window_hist_scan(w, first, n, window_hist, 1);
+        }
+        hist = window_hist;
+    }
+
+    double mean = (double)acc.sum / n;
+    double variance = ((double)acc.sum_sq - (double)acc.sum * mean) / n;
+    stats->count = n;
+    stats->span_ms = w->times[last] - w->times[first];
+    stats->min = acc.min;
+    stats->max = acc.max;
+    stats->last = w->values[last];
+    stats->mean = mean;
+    stats->stddev = variance > 0.0 ? sqrt(variance) : 0.0;
+    stats->ewma = w->ewma;
+    stats->p50 = window_percentile(w, hist, n, 0.50, acc.min, acc.max);
+    stats->p90 = window_percentile(w, hist, n, 0.90, acc.min, acc.max);
+    stats->p99 = window_percentile(w, hist, n, 0.99, acc.min, acc.max);
+    return n;
+}
+
+// 최근 window_ms 동안의 통계 (0이면 링 전체). 반환: 구간 샘플 수
+// 링보다 긴 구간은 링에 남은 샘플만 집계되므로 span_ms로 실제 범위를 확인
+int sample_window_stats(const SampleWindow *w, uint64_t window_ms, uint64_t now_ms, WindowStats *stats) {
+    if (!w || w->count == 0) {
+        memset(stats, 0, sizeof(*stats));
+        return 0;
+    }
+
+    int start = 0;
+    if (window_ms > 0 && now_ms - w->base_ms > window_ms) {
+        // times[]는 넣은 순서대로 늘어나므로 구간 시작을 이진 탐색
+        uint32_t cutoff = (uint32_t)(now_ms - window_ms - w->base_ms);
+        uint32_t mask = (uint32_t)(w->capacity - 1);
+        uint32_t oldest = w->head - (uint32_t)w->count;
+        int low = 0;
+        int high = w->count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (w->times[(oldest + (uint32_t)mid) & mask] < cutoff) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        start = low;
+    }
+    return window_stats_from(w, start, stats);
+}
+
+// 최근 샘플 samples개의 통계
+int sample_window_stats_last(const SampleWindow *w, int samples, WindowStats *stats) {
+    if (!w || samples <= 0) {
+        memset(stats, 0, sizeof(*stats));
+        return 0;
+    }
+    return window_stats_from(w, samples < w->count ? w->count - samples : 0, stats);
+}
+
+// "60s", "500ms", "5m", "1h", 숫자만 있으면 초, "all"은 0 (링 전체). 형식 오류면 -1
+long sample_window_parse_duration(const char *text, size_t len) {
+    if (len == 3 && memcmp(text, "all", 3) == 0) {
+        return 0;
+    }
+    size_t i = 0;
+    long value = 0;
+    while (i < len && isdigit((unsigned char)text[i])) {
+        if (value > LONG_MAX / 10 / 3600000L) {
+            return -1;
+        }
+        value = value * 10 + (text[i++] - '0');
+    }
+    if (i == 0) {
+        return -1;
+    }
+
+    const char *unit = text + i;
+    size_t unit_len = len - i;
+    if (unit_len == 2 && memcmp(unit, "ms", 2) == 0) {
+        return value;
+    }
+    if (unit_len == 0 || (unit_len == 1 && unit[0] == 's')) {
+        return value * 1000L;
+    }
+    if (unit_len == 1 && unit[0] == 'm') {
+        return value * 60000L;
+    }
+    if (unit_len == 1 && unit[0] == 'h') {
+        return value * 3600000L;
+    }
+    return -1;
+}
@@ -0,0 +1,322 @@
+#include "../mqtt.h"
+
+// 예약 작업 (최소 힙의 원소)
+typedef struct {
+    char id[64];                    // 같은 owner 안에서만 의미 있음
+    const void *owner;              // 예약한 주체 (보통 VirtualDevice), 취소는 (owner, id)가 모두 맞아야 함
+    uint64_t due_ns;                // 다음 실행 시각 (CLOCK_MONOTONIC)
+    uint64_t interval_ns;           // 0이면 1회성
+    int remaining;                  // 남은 실행 횟수 (-1이면 무제한)
+    scheduler_callback_t callback;
+    void *context;
+    void (*free_context)(void *context);
+} ScheduledTask;
+
+// 단일 timerfd가 힙의 가장 이른 작업 시각에 맞춰 깨움
+static ScheduledTask **g_heap = NULL;
+static int g_heap_size = 0;
+static int g_heap_capacity = 0;
+static int g_timer_fd = -1;
+static uint64_t g_next_auto_id = 1;
+
+static void heap_swap(int a, int b) {
+    ScheduledTask *tmp = g_heap[a];
+    g_heap[a] = g_heap[b];
+    g_heap[b] = tmp;
+}
+
+static void heap_sift_up(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (g_heap[parent]->due_ns <= g_heap[i]->due_ns) {
+            break;
+        }
+        heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(int i) {
+    while (1) {
+        int left = 2 * i + 1;
+        int right = left + 1;
+        int smallest = i;
+        if (left < g_heap_size && g_heap[left]->due_ns < g_heap[smallest]->due_ns) smallest = left;
+        if (right < g_heap_size && g_heap[right]->due_ns < g_heap[smallest]->due_ns) smallest = right;
+        if (smallest == i) {
+            break;
+        }
+        heap_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+// i번째 원소를 힙에서 꺼냄
+static ScheduledTask *heap_remove(int i) {
+    ScheduledTask *task = g_heap[i];
+    g_heap_size--;
+    if (i != g_heap_size) {
+        g_heap[i] = g_heap[g_heap_size];
+        heap_sift_down(i);
+        heap_sift_up(i);
+    }
+    return task;
+}
+
+static int heap_push(ScheduledTask *task) {
+    if (g_heap_size == g_heap_capacity) {
+        if (g_heap_capacity >= MAX_SCHEDULED_TASKS) {
+            return -1;
+        }
+        int new_capacity = g_heap_capacity ? g_heap_capacity * 2 : 64;
+        ScheduledTask **grown = realloc(g_heap, sizeof(ScheduledTask *) * new_capacity);
+        if (!grown) {
+            return -1;
+        }
+        g_heap = grown;
+        g_heap_capacity = new_capacity;
+    }
+    g_heap[g_heap_size] = task;
+    heap_sift_up(g_heap_size);
+    g_heap_size++;
+    return 0;
+}
+
+static void task_free(ScheduledTask *task) {
+    if (task->free_context) {
+        task->free_context(task->context);
+    }
+    free(task);
+}
+
+// 가장 이른 작업 시각으로 timerfd 재설정 (작업이 없으면 해제)
+static void scheduler_rearm(void) {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (g_heap_size > 0) {
+        uint64_t due = g_heap[0]->due_ns;
+        spec.it_value.tv_sec = due / 1000000000ULL;
+        spec.it_value.tv_nsec = due % 1000000000ULL;
+        // 0은 타이머 해제를 뜻하므로 최소 1ns
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    if (timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        perror("Scheduler: timerfd_settime failed");
+    }
+}
+
+// timerfd 콜백: 만기된 작업 실행 후 주기 작업은 다시 넣음
+static void scheduler_on_timer(int fd, uint32_t events, void *context) {
+    (void)events;
+    (void)context;
+    reactor_drain_fd(fd);
+
+    uint64_t now = monotonic_time_ns();
+    while (g_heap_size > 0 && g_heap[0]->due_ns <= now) {
+        ScheduledTask *task = heap_remove(0);
+        task->callback(task->context);
+
+        if (task->remaining > 0) {
+            task->remaining--;
+        }
+        if (task->interval_ns > 0 && task->remaining != 0) {
+            // 실행 지연이 누적되지 않도록 원래 예정 시각 기준으로 다음 시각 계산
+            task->due_ns += task->interval_ns;
+            if (task->due_ns <= now) {
+                task->due_ns = now + task->interval_ns;
+            }
+            if (heap_push(task) == 0) {
+                continue;
+            }
+        }
+        task_free(task);
+    }
+    scheduler_rearm();
+}
+
+// 스케줄러 초기화 (reactor 스레드에서만 사용)
+int scheduler_init(Reactor *reactor) {
+    g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_timer_fd == -1) {
+        perror("Scheduler: timerfd_create failed");
+        return -1;
+    }
+    if (reactor_add_fd(reactor, g_timer_fd, scheduler_on_timer, NULL) != 0) {
+        close(g_timer_fd);
+        g_timer_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+// 작업 예약: delay_ns 후 실행, interval_ns > 0 이면 count회(-1 무제한) 반복
+// id가 NULL/빈 문자열이면 자동 생성, owner는 취소 범위 (다른 owner의 같은 id는 건드리지 않음). 성공 시 0
+int scheduler_add(const void *owner, const char *id, uint64_t delay_ns, uint64_t interval_ns, int count,
+                  scheduler_callback_t callback, void *context, void (*free_context)(void *context)) {
+    if (g_timer_fd == -1 || !callback || count == 0) {
+        return -1;
+    }
+
+    ScheduledTask *task = calloc(1, sizeof(ScheduledTask));
+    if (!task) {
+        return -1;
+    }
+    if (id && id[0] != '\0') {
+        strncpy(task->id, id, sizeof(task->id) - 1);
+    } else {
+        snprintf(task->id, sizeof(task->id), "task-%llu", (unsigned long long)g_next_auto_id++);
+    }
+    task->owner = owner;
+    task->due_ns = monotonic_time_ns() + delay_ns;
+    task->interval_ns = interval_ns;
+    task->remaining = interval_ns > 0 ? count : 1;
+    task->callback = callback;
+    task->context = context;
+    task->free_context = free_context;
+
+    if (heap_push(task) != 0) {
+        log_error("Scheduler: Too many pending tasks (max %d)", MAX_SCHEDULED_TASKS);
+        free(task);
+        return -1;
+    }
+
+    // 새 작업이 가장 이르면 timerfd 재설정
+    if (g_heap[0] == task) {
+        scheduler_rearm();
+    }
+    return 0;
+}
+
+// owner와 id가 같은 예약 작업 모두 취소. 취소된 개수 반환
+int scheduler_cancel(const void *owner, const char *id) {
+    int cancelled = 0;
+    if (!id) {
+        return 0;
+    }
+
+    for (int i = 0; i < g_heap_size; ) {
+        if (g_heap[i]->owner == owner && strcmp(g_heap[i]->id, id) == 0) {
+            task_free(heap_remove(i));
+            cancelled++;
+            // 제거 위치에 다른 원소가 들어왔으므로 i 그대로 재검사
+            continue;
+        }
+        i++;
+    }
+    if (cancelled > 0) {
+        scheduler_rearm();
+    }
+    return cancelled;
+}
+
+// 대기 중인 작업 수
+int scheduler_pending(void) {
+    return g_heap_size;
+}
+
+// 모든 작업 폐기 및 timerfd 닫기 (reactor_cleanup 이후 호출)
+void scheduler_cleanup(void) {
+    for (int i = 0; i < g_heap_size; i++) {
+        task_free(g_heap[i]);
+    }
+    free(g_heap);
+    g_heap = NULL;
+    g_heap_size = 0;
+    g_heap_capacity = 0;
+    if (g_timer_fd != -1) {
+        close(g_timer_fd);
+        g_timer_fd = -1;
+    }
+}
+
+// 페이로드에서 예약 지시 추출
+// {"after_ms":N} / {"every_ms":N,"count":K} / {"at":<unix ms>} / {"cancel":"<id>"}, "id"는 선택
+// '@'로 시작하는 id/cancel은 내부 작업용이라 reserved_id로 표시 (호출자가 거부)
+int scheduler_parse_spec(const char *payload, ScheduleSpec *spec) {
+    memset(spec, 0, sizeof(ScheduleSpec));
+    spec->count = -1;
+
+    if (!payload || payload[0] != '{') {
+        return 0;
+    }
+
+    enum { F_CANCEL, F_AFTER, F_AT, F_EVERY, F_COUNT, F_ID, F_VALUE, F_TOTAL };
+    JsonField fields[F_TOTAL] = {
+        { .key = "cancel" }, { .key = "after_ms" }, { .key = "at" }, { .key = "every_ms" },
+        { .key = "count" }, { .key = "id" }, { .key = "value" },
+    };
+    if (json_extract_fields(payload, (int)strlen(payload), fields, F_TOTAL) <= 0) {
+        return 0;
+    }
+
+    double number;
+    if (fields[F_CANCEL].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[F_CANCEL], spec->cancel_id, sizeof(spec->cancel_id));
+        spec->has_cancel = 1;
+        // 내부 작업(스트리밍 등)은 원격 취소 대상이 아님
+        if (spec->cancel_id[0] == SCHEDULE_INTERNAL_PREFIX) {
+            spec->reserved_id = 1;
+        }
+    }
+
+    // 원격 값이므로 정수로 바꾸기 전에 상한을 확인 (큰 double의 변환과 ns 환산 곱셈이 넘치지 않도록)
+    if (json_field_number(&fields[F_AFTER], &number) == 0 && number >= 0) {
+        if (number > (double)SCHEDULE_MAX_DELAY_MS) {
+            spec->out_of_range = 1;
+        } else {
+            spec->delay_ms = (uint64_t)number;
+        }
+        spec->has_schedule = 1;
+    }
+
+    if (json_field_number(&fields[F_AT], &number) == 0) {
+        // 벽시계 기준 시각을 지금부터의 지연으로 변환 (이미 지난 시각이면 즉시)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        double now_ms = (double)ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+        if (number - now_ms > (double)SCHEDULE_MAX_DELAY_MS) {
+            spec->out_of_range = 1;
+        } else {
+            spec->delay_ms = number > now_ms ? (uint64_t)(number - now_ms) : 0;
+        }
+        spec->has_schedule = 1;
+    }
+
+    if (json_field_number(&fields[F_EVERY], &number) == 0 && number >= 1) {
+        if (number > (double)SCHEDULE_MAX_DELAY_MS) {
+            spec->out_of_range = 1;
+            number = 0;
+        }
+        spec->interval_ms = (uint64_t)number;
+        spec->has_schedule = 1;
+        // 시작 지연이 없으면 첫 실행도 한 주기 뒤
+        if (fields[F_AFTER].type == JSON_FIELD_NONE && fields[F_AT].type == JSON_FIELD_NONE) {
+            spec->delay_ms = spec->interval_ms;
+        }
+    }
+
+    int count;
+    if (json_field_int(&fields[F_COUNT], &count) == 0 && count > 0) {
+        spec->count = count;
+    }
+
+    if (fields[F_ID].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[F_ID], spec->id, sizeof(spec->id));
+        if (spec->id[0] == SCHEDULE_INTERNAL_PREFIX) {
+            spec->reserved_id = 1;
+        }
+    }
+
+    int value;
+    if (fields[F_VALUE].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[F_VALUE], spec->value, sizeof(spec->value));
+        spec->has_value = 1;
+    } else if (json_field_int(&fields[F_VALUE], &value) == 0) {
+        snprintf(spec->value, sizeof(spec->value), "%d", value);
+        spec->has_value = 1;
+    }
+
+    return spec->has_schedule || spec->has_cancel;
+}
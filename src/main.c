@@ -19,40 +19,490 @@ void signal_handler(int signal) {
     }
 }
 
-// 수정된 messageArrived 콜백 (Subscriber용) - 기존 구조 활용
-int messageArrived_subscriber(void *context, char *topicName, int topicLen, MQTTClient_message *message) {
-    printf("Subscriber: Message arrived on topic '%s': %.*s\n", 
-           topicName, message->payloadlen, (char*)message->payload);
-    
-    // 기존 토픽 파싱 함수 활용
-    ParsedTopic topic_info = parse_topic_hierarchy(topicName);
-    ParsedMessage msg_info = parse_message_payload(message->payload, message->payloadlen);
-    
-    // control 토픽인지 확인 (prefix가 "control"인지)
-    if (topic_info.is_valid && strcmp(topic_info.prefix, "control") == 0) {
-        // 페이로드를 문자열로 변환
-        char payload[MAX_STRING_LEN] = {0};
-        int payload_len = message->payloadlen;
-        if (payload_len >= MAX_STRING_LEN) {
-            payload_len = MAX_STRING_LEN - 1;
+// 구독 필터 → 처리기 트라이 (fork 전에 만들고 Subscriber 쪽에서 읽기 전용으로 사용)
+static TopicTrie *topic_routes = NULL;
+
+// 일반 메시지 파싱/출력 (워커 스레드에서 실행)
+static void print_local_message(const char *topic, const char *payload, int payload_len) {
+    ParsedTopic topic_info;
+    parse_topic_view(topic, &topic_info);
+    ParsedMessage msg_info = parse_message_payload(payload, payload_len);
+    print_message_info(&topic_info, &msg_info);
+}
+
+// control 외 필터 처리기: 복사해서 워커에 넘기고 바로 반환
+// device_id 단계로 샤드를 정하므로 같은 디바이스의 메시지는 받은 순서대로 출력됨
+static void route_local_message(const char *topic, void *message, void *context) {
+    MQTTClient_message *msg = message;
+    (void)context;
+    
+    ParsedTopic topic_info;
+    const char *key = topic;
+    size_t key_len = strlen(topic);
+    if (parse_topic_view(topic, &topic_info) == 0) {
+        key = topic + topic_info.device_id.offset;
+        key_len = topic_info.device_id.len;
+    }
+    executor_submit_message(key, key_len, print_local_message, topic, msg->payload, msg->payloadlen);
+}
+
+// control 필터 처리기: 우선순위 레인을 정해 IPC로 Publisher에게 전달
+static void route_control_message(const char *topic, void *message, void *context) {
+    MQTTClient_message *msg = message;
+    
+    // 토픽 파싱 (원본 토픽을 가리키는 뷰, 복사 없음)
+    ParsedTopic topic_info;
+    if (parse_topic_view(topic, &topic_info) != 0) {
+        // control/# 같은 필터로 들어온 4단계 미만 토픽은 일반 메시지로 출력
+        route_local_message(topic, message, context);
+        return;
+    }
+    
+    // 디바이스/명령별 우선순위 레인 결정
+    int lane = priority_classify(&topic_info);
+    
+    // IPC를 통해 Publisher에게 제어 명령 전달 (길이 제한 없이 원본 페이로드 전달)
+    // 페이로드는 Publisher가 해석하므로 여기서는 파싱하지 않음
+    if (ipc_send_control_message(msg_queue_id, lane, topic, (const char *)msg->payload, msg->payloadlen) != 0) {
+        log_error("Subscriber: Failed to send control message via IPC");
+        metrics_count(METRIC_IPC_SEND_FAILED);
+    } else {
+        metrics_count(METRIC_CONTROL_FORWARDED);
+    }
+    print_message_info(&topic_info, NULL);
+}
+
+// 받은 토픽의 prefix로 처리기 선택
+static topic_route_t route_for_topic(const char *topic) {
+    return strncmp(topic, "control/", 8) == 0 ? route_control_message : route_local_message;
+}
+
+// 첫 단계가 와일드카드인 필터 처리기: 받은 토픽의 prefix로 판단
+static void route_by_prefix(const char *topic, void *message, void *context) {
+    route_for_topic(topic)(topic, message, context);
+}
+
+// 구독 토픽 목록의 필터마다 처리기를 연결 (첫 단계로 결정)
+static int build_topic_routes(const TopicList *topic_list) {
+    topic_routes = topic_trie_create();
+    if (!topic_routes) {
+        log_error("Failed to allocate topic routes");
+        return -1;
+    }
+    
+    for (int i = 0; i < topic_list->count; i++) {
+        const char *filter = topic_list->topics[i];
+        topic_route_t handler = route_local_message;
+        if (filter[0] == '+' || filter[0] == '#') {
+            handler = route_by_prefix;
+        } else if (strncmp(filter, "control/", 8) == 0 || strcmp(filter, "control") == 0) {
+            handler = route_control_message;
         }
-        memcpy(payload, message->payload, payload_len);
-        payload[payload_len] = '\0';
-        
-        // IPC를 통해 Publisher에게 제어 명령 전달
-        if (ipc_send_control_message(msg_queue_id, topicName, payload) != 0) {
-            printf("Subscriber: Failed to send control message via IPC\n");
+        if (topic_trie_insert(topic_routes, filter, handler, NULL) != 0) {
+            log_warn("Warning: Topic filter not routable: %s", filter);
         }
     }
+    log_info("Routing: %d subscription filters bound", topic_trie_count(topic_routes));
+    return 0;
+}
+
+// 수정된 messageArrived 콜백 (Subscriber용) - 구독 필터 트라이로 처리기 선택
+int messageArrived_subscriber(void *context, char *topicName, int topicLen, MQTTClient_message *message) {
+    uint64_t start_ns = monotonic_time_ns();
+    metrics_count(METRIC_MESSAGES_RECEIVED);
+    log_debug("Subscriber: Message arrived on topic '%s': %.*s", 
+              topicName, message->payloadlen, (char*)message->payload);
     
-    // 기존 메시지 정보 출력 함수 활용
-    print_message_info(&topic_info, &msg_info);
+    // 겹치는 필터가 같은 처리기로 이어지면 한 번만 실행 (제어 명령 중복 전달 방지)
+    const TopicRoute *routes[MAX_TOPIC_ROUTES];
+    topic_route_t handlers[MAX_TOPIC_ROUTES];
+    int matched = topic_trie_match(topic_routes, topicName, routes, MAX_TOPIC_ROUTES);
+    if (matched > MAX_TOPIC_ROUTES) {
+        matched = MAX_TOPIC_ROUTES;
+    }
+    for (int i = 0; i < matched; i++) {
+        handlers[i] = routes[i]->handler == route_by_prefix ? route_for_topic(topicName) : routes[i]->handler;
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = handlers[j] == handlers[i] && routes[j]->context == routes[i]->context;
+        }
+        if (!seen) {
+            handlers[i](topicName, message, routes[i]->context);
+        }
+    }
+    if (matched == 0) {
+        // 구독 목록 밖의 토픽 (브로커 재전송 등)은 이전처럼 prefix로 판단
+        log_debug("Subscriber: No subscription filter matches '%s'", topicName);
+        route_by_prefix(topicName, message, NULL);
+    }
     
     MQTTClient_freeMessage(&message);
     MQTTClient_free(topicName);
+    metrics_record(METRIC_STAGE_RECEIVE, monotonic_time_ns() - start_ns);
     return 1;
 }
 
+// 예약된 제어 명령 (스케줄러가 만기 시 디바이스 실행기로 넘김)
+typedef struct {
+    char device[64];
+    device_handler_t handler;
+    VirtualDevice *target;      // 명령을 받은 디바이스 ID
+    int lane;
+    int encoding;               // 결과 인코딩 (명령을 받을 때 정함)
+    char arg[];
+} ScheduledCommand;
+
+static uint64_t schedule_seq = 0;
+
+static void run_scheduled_command(void *context) {
+    ScheduledCommand *cmd = context;
+    result_set_encoding(cmd->encoding);
+    if (executor_submit(cmd->device, cmd->lane, cmd->handler, cmd->target, cmd->arg) != 0) {
+        log_error("Publisher: Failed to queue scheduled command for device: %s", cmd->device);
+    }
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+}
+
+// 예약/취소 결과 응답
+// 수신 토픽의 device_id 기준 상태 토픽으로 결과 발행
+static void publish_status_result(ResultBuilder *rb, const ParsedTopic *topic_info) {
+    const char *received = topic_info->topic;
+    TopicLevel device_id = topic_info->device_id;
+    TopicLevel target = topic_info->target_device;
+    
+    char target_name[64];
+    topic_level_copy(received, target, target_name, sizeof(target_name));
+    if (topic_level_is(received, device_id, status_device_id())) {
+        result_publish(rb, target_name);
+        return;
+    }
+    char topic[MAX_TOPIC_LEN];
+    if (status_topic_format(received + device_id.offset, device_id.len, target_name, topic, sizeof(topic)) < 0) {
+        return;
+    }
+    result_publish_to(rb, topic);
+}
+
+static void send_schedule_result(const ParsedTopic *topic_info, const char *id, const char *status) {
+    ResultBuilder rb;
+    
+    result_init(&rb);
+    result_add_strn(&rb, "device", topic_info->topic + topic_info->target_device.offset,
+                    topic_info->target_device.len);
+    result_add_strn(&rb, "command", topic_info->topic + topic_info->command.offset,
+                    topic_info->command.len);
+    result_add_str(&rb, "id", id);
+    result_add_str(&rb, "status", status);
+    result_add_int(&rb, "pending", scheduler_pending());
+    publish_status_result(&rb, topic_info);
+}
+
+// 제어 명령 하나를 디바이스 실행기로 분배 (블록하지 않음)
+static void dispatch_decoded_command(const char *received_topic, const char *received_payload, int lane) {
+    log_debug("Publisher: Processing control command for topic '%s'", received_topic);
+    
+    // 토픽 파싱 (원본 토픽을 가리키는 뷰, 복사 없음)
+    ParsedTopic topic_info;
+    if (parse_topic_view(received_topic, &topic_info) != 0) {
+        log_warn("Publisher: Invalid topic format: %s", received_topic);
+        return;
+    }
+    
+    // 토픽의 device_id로 이 게이트웨이가 맡은 디바이스를 찾음 (모르는 ID는 응답 없이 버림)
+    VirtualDevice *target = device_table_find(received_topic + topic_info.device_id.offset,
+                                              topic_info.device_id.len);
+    if (!target) {
+        log_warn("Publisher: Unknown device id: %.*s", topic_info.device_id.len,
+                 received_topic + topic_info.device_id.offset);
+        metrics_count(METRIC_UNKNOWN_DEVICE_ID);
+        return;
+    }
+    
+    // 실행기 이름과 핸들러 인자로 쓸 두 단계만 스택에 꺼냄
+    char device[64];
+    char command[64];
+    topic_level_copy(received_topic, topic_info.target_device, device, sizeof(device));
+    topic_level_copy(received_topic, topic_info.command, command, sizeof(command));
+    
+    // 예약 취소 요청 ({"cancel":"<id>"}, 이 디바이스가 예약한 작업만)
+    ScheduleSpec spec;
+    scheduler_parse_spec(received_payload, &spec);
+    if (spec.has_cancel) {
+        if (spec.reserved_id) {
+            log_warn("Publisher: Refused to cancel internal task '%s'", spec.cancel_id);
+            send_schedule_result(&topic_info, spec.cancel_id, "rejected");
+            return;
+        }
+        int cancelled = scheduler_cancel(target, spec.cancel_id);
+        log_info("Publisher: Cancelled %d scheduled task(s) with id '%s' on %s", cancelled, spec.cancel_id, target->id);
+        send_schedule_result(&topic_info, spec.cancel_id, cancelled > 0 ? "cancelled" : "not_found");
+        return;
+    }
+    
+    // 레지스트리에서 (디바이스, 명령) 핸들러 조회 (토픽 뷰를 그대로 해시)
+    const DispatchEntry *entry = dispatch_lookup(&topic_info);
+    device_handler_t handler = entry ? entry->handler : NULL;
+    const char *arg = command;
+    if (entry && (entry->flags & DISPATCH_ARG_PAYLOAD)) {
+        // 페이로드를 값으로 쓰는 디바이스 (예: s_segment)
+        if (spec.has_schedule) {
+            // 예약 페이로드면 JSON 안의 value 사용
+            if (spec.has_value) {
+                arg = spec.value;
+            }
+        } else if (strlen(received_payload) > 0) {
+            arg = received_payload;
+        }
+    }
+    
+    if (entry && (entry->flags & DISPATCH_INLINE)) {
+        // 가벼운 설정 명령은 디스패치 스레드에서 바로 실행 (스케줄러를 직접 씀, 예약 지시는 무시)
+        device_set_current(target);
+        handler(arg);
+        device_set_current(NULL);
+        metrics_count(METRIC_COMMANDS_DISPATCHED);
+    } else if (handler && spec.has_schedule) {
+        // 지연/주기 실행 예약 ({"after_ms":N}, {"every_ms":N,"count":K}, {"at":<unix ms>})
+        size_t arg_len = strlen(arg);
+        ScheduledCommand *cmd = malloc(sizeof(ScheduledCommand) + arg_len + 1);
+        if (!cmd) {
+            return;
+        }
+        strncpy(cmd->device, device, sizeof(cmd->device) - 1);
+        cmd->device[sizeof(cmd->device) - 1] = '\0';
+        cmd->handler = handler;
+        cmd->target = target;
+        cmd->lane = lane;
+        cmd->encoding = result_encoding();
+        memcpy(cmd->arg, arg, arg_len + 1);
+        
+        if (spec.id[0] == '\0') {
+            snprintf(spec.id, sizeof(spec.id), "%.40s-%llu", device,
+                     (unsigned long long)++schedule_seq);
+        }
+        if (spec.out_of_range || spec.reserved_id ||
+            scheduler_add(target, spec.id, spec.delay_ms * 1000000ULL, spec.interval_ms * 1000000ULL,
+                          spec.count, run_scheduled_command, cmd, free) != 0) {
+            free(cmd);
+            send_schedule_result(&topic_info, spec.id, "rejected");
+            return;
+        }
+        log_info("Publisher: Scheduled '%s' for %s on %s (delay %llu ms, every %llu ms)", spec.id,
+                 device, target->id, (unsigned long long)spec.delay_ms, (unsigned long long)spec.interval_ms);
+        metrics_count(METRIC_COMMANDS_SCHEDULED);
+        send_schedule_result(&topic_info, spec.id, "scheduled");
+    } else if (handler) {
+        // (device_id, 디바이스) 샤드 워커에 넘기고 바로 반환 (같은 디바이스 명령은 순서 유지)
+        if (executor_submit(device, lane, handler, target, arg) != 0) {
+            log_error("Publisher: Failed to queue command for device: %s", device);
+        } else {
+            metrics_count(METRIC_COMMANDS_DISPATCHED);
+        }
+    } else {
+        log_warn("Publisher: Unknown device: %s", device);
+        metrics_count(METRIC_UNKNOWN_DEVICE);
+        
+        // 알 수 없는 디바이스에 대한 에러 응답
+        ResultBuilder rb;
+        result_init(&rb);
+        result_add_str(&rb, "error", "unknown device");
+        result_add_str(&rb, "device", device);
+        publish_status_result(&rb, &topic_info);
+    }
+}
+
+// 수신 토픽에 대한 상태 토픽이 cbor_topic 필터에 맞으면 CBOR로 답함
+static int status_topic_encoding(const char *received_topic) {
+    ParsedTopic topic_info;
+    char target[64];
+    char topic[MAX_TOPIC_LEN];
+    if (parse_topic_view(received_topic, &topic_info) != 0) {
+        return PAYLOAD_ENCODING_JSON;
+    }
+    topic_level_copy(received_topic, topic_info.target_device, target, sizeof(target));
+    if (status_topic_format(received_topic + topic_info.device_id.offset, topic_info.device_id.len,
+                            target, topic, sizeof(topic)) < 0 || !cbor_wants(topic)) {
+        return PAYLOAD_ENCODING_JSON;
+    }
+    return PAYLOAD_ENCODING_CBOR;
+}
+
+// gzip 명령은 먼저 풀고, CBOR 명령은 JSON 텍스트로 바꿔 기존 해석 경로로 넘기고 결과도 CBOR로 답함
+// 정한 결과 인코딩은 스레드에 두고, 실행기/스케줄러가 작업과 함께 넘겨 핸들러의 result_init이 씀
+static void dispatch_control_command(const char *received_topic, const char *received_payload,
+                                     int payload_len, int lane) {
+    char *inflated = NULL;
+    char *decoded = NULL;
+    int encoding = PAYLOAD_ENCODING_JSON;
+    if (compress_is_marked(received_payload, payload_len)) {
+        payload_len = compress_inflate(received_payload, payload_len, &inflated);
+        if (payload_len < 0) {
+            log_warn("Publisher: Invalid gzip payload on topic '%s'", received_topic);
+            return;
+        }
+        received_payload = inflated;
+    }
+    if (cbor_is_marked(received_payload, payload_len)) {
+        int json_len = cbor_to_json_alloc(received_payload, payload_len, &decoded);
+        if (json_len < 0) {
+            if (json_len == CBOR_TOO_LARGE) {
+                log_warn("Publisher: CBOR payload on topic '%s' exceeds %d bytes as JSON", received_topic,
+                         MAX_PAYLOAD_SIZE);
+                metrics_count(METRIC_CBOR_OVERSIZE);
+            } else {
+                log_warn("Publisher: Invalid CBOR payload on topic '%s'", received_topic);
+                metrics_count(METRIC_CBOR_INVALID);
+            }
+            free(inflated);
+            return;
+        }
+        metrics_count(METRIC_CBOR_COMMANDS);
+        received_payload = decoded;
+        encoding = PAYLOAD_ENCODING_CBOR;
+    } else if (cbor_topic_count() > 0) {
+        encoding = status_topic_encoding(received_topic);
+    }
+    result_set_encoding(encoding);
+    dispatch_decoded_command(received_topic, received_payload, lane);
+    result_set_encoding(PAYLOAD_ENCODING_JSON);
+    free(decoded);
+    free(inflated);
+}
+
+// IPC eventfd 콜백: 큐에 쌓인 제어 명령을 모두 처리
+static void on_ipc_event(int fd, uint32_t events, void *context) {
+    (void)events;
+    (void)context;
+    
+    reactor_drain_fd(fd);
+    
+    // 매번 높은 레인부터 꺼내므로 긴급 명령은 처리 중인 명령 하나만 기다림
+    // 공유 링이면 링 메모리를 그대로 핸들러에 전달 (복사 없음)
+    IPCRecordView view;
+    while (running && ipc_receive_control_view(msg_queue_id, &view) == 0) {
+        uint64_t start_ns = monotonic_time_ns();
+        dispatch_control_command(view.topic, view.payload, view.payload_len, view.lane);
+        metrics_record(METRIC_STAGE_DISPATCH, monotonic_time_ns() - start_ns);
+        ipc_release_control_view(&view);
+    }
+}
+
+// signalfd 콜백: 종료 시그널 수신 시 이벤트 루프 종료
+static void on_shutdown_signal(int fd, uint32_t events, void *context) {
+    (void)events;
+    Reactor *reactor = context;
+    
+    struct signalfd_siginfo info;
+    if (read(fd, &info, sizeof(info)) == sizeof(info)) {
+        log_info("Publisher: Received signal %u, shutting down...", info.ssi_signo);
+    }
+    running = 0;
+    reactor_stop(reactor);
+}
+
+// 현재 프로세스 상주 메모리 (kB, 실패 시 -1)
+static long read_rss_kb(void) {
+    FILE *file = fopen("/proc/self/status", "r");
+    if (!file) {
+        return -1;
+    }
+    char line[128];
+    long rss_kb = -1;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "VmRSS: %ld", &rss_kb) == 1) {
+            break;
+        }
+    }
+    fclose(file);
+    return rss_kb;
+}
+
+// 연결 준비 시간과 메모리 사용량 출력 (fork 모드는 두 프로세스 값을 합산해 비교)
+static void print_startup_report(const char *role, uint64_t start_ns) {
+    log_info("%s: Connection setup took %.1f ms, resident memory %ld kB", role,
+             (monotonic_time_ns() - start_ns) / 1000000.0, read_rss_kb());
+}
+
+// 디스패치 리액터 준비: 종료 시그널은 signalfd로 받음
+// MQTT 스레드 생성 전에 블록해야 모든 스레드에 상속됨
+static int init_dispatch_reactor(Reactor *reactor) {
+    if (reactor_init(reactor) != 0) {
+        return -1;
+    }
+    const int shutdown_signals[] = { SIGINT, SIGTERM };
+    if (reactor_add_signals(reactor, shutdown_signals, 2, on_shutdown_signal, reactor) < 0) {
+        reactor_cleanup(reactor);
+        return -1;
+    }
+    return 0;
+}
+
+// 통계 보고 타이머: metrics 토픽 발행과 Prometheus 파일 갱신
+static void on_metrics_timer(int fd, uint32_t events, void *context) {
+    (void)events;
+    (void)context;
+    reactor_drain_fd(fd);
+    metrics_report();
+}
+
+// 발행 파이프라인, 스케줄러, IPC 도착 알림 등록 후 먼저 쌓인 명령이 있으면 바로 처리
+static int start_dispatch(Reactor *reactor, const MQTTConfig *config) {
+    batcher_configure(config);
+    cbor_configure(config);
+    compress_configure(config);
+    photoresistor_configure(config);
+    if (executor_start(config->worker_threads) < 0) {
+        log_error("Publisher: Failed to start command workers");
+        return -1;
+    }
+    if (publisher_start(config->publish_max_inflight, config->publish_queue_size) != 0) {
+        log_error("Publisher: Failed to start publish pipeline");
+        return -1;
+    }
+    // 지연/주기 명령용 스케줄러 (같은 리액터에서 timerfd로 구동)
+    if (scheduler_init(reactor) != 0) {
+        log_error("Publisher: Failed to initialize scheduler");
+        return -1;
+    }
+    if (reactor_add_fd(reactor, ipc_get_event_fd(), on_ipc_event, NULL) != 0) {
+        log_error("Publisher: Failed to register IPC event");
+        return -1;
+    }
+    if (config->metrics_interval_ms > 0 &&
+        reactor_add_timer(reactor, config->metrics_interval_ms, on_metrics_timer, NULL) < 0) {
+        log_error("Publisher: Failed to register metrics timer");
+        return -1;
+    }
+    on_ipc_event(ipc_get_event_fd(), EPOLLIN, NULL);
+    return 0;
+}
+
+// 디스패치 종료: 통계 출력 후 스케줄러/실행기/발행 파이프라인 정리
+static void stop_dispatch(Reactor *reactor) {
+    IPCStats stats;
+    ipc_get_stats(msg_queue_id, &stats);
+    log_info("Publisher: IPC stats - received %llu, dropped %llu, pending %llu",
+             (unsigned long long)stats.dequeued, (unsigned long long)stats.dropped,
+             (unsigned long long)stats.depth_messages);
+    for (int lane = 0; lane < IPC_LANE_COUNT; lane++) {
+        IPCLaneStats lane_stats;
+        ipc_get_lane_stats(lane, &lane_stats);
+        log_info("Publisher: Lane %-6s - received %llu, dropped %llu, avg wait %llu us, max wait %llu us",
+                 priority_lane_name(lane), (unsigned long long)lane_stats.received,
+                 (unsigned long long)lane_stats.dropped,
+                 (unsigned long long)(lane_stats.received ? lane_stats.total_wait_ns / lane_stats.received / 1000 : 0),
+                 (unsigned long long)(lane_stats.max_wait_ns / 1000));
+    }
+    // 마지막 스냅샷은 발행 파이프라인이 살아 있을 때 보냄
+    metrics_report();
+    
+    reactor_cleanup(reactor);
+    scheduler_cleanup();
+    executor_shutdown_all();
+    device_table_cleanup();
+    publisher_stop(5000);
+}
+
 // Publisher 프로세스 함수
 void run_publisher_process(const MQTTConfig *config, const char *url) {
     char pub_client_id[MAX_STRING_LEN];
@@ -61,12 +511,19 @@ void run_publisher_process(const MQTTConfig *config, const char *url) {
     MQTTClient pub_client;
     MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer;
     MQTTClient_SSLOptions ssl_opts = MQTTClient_SSLOptions_initializer;
+    Reactor reactor;
+    uint64_t start_ns = monotonic_time_ns();
     int rc;
     
+    if (init_dispatch_reactor(&reactor) != 0) {
+        log_error("Publisher: Failed to initialize reactor");
+        exit(EXIT_FAILURE);
+    }
+    
     // Publisher 클라이언트 생성
     if ((rc = MQTTClient_create(&pub_client, url, pub_client_id,
             MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTCLIENT_SUCCESS) {
-        printf("Publisher: Failed to create client, return code %d\n", rc);
+        log_error("Publisher: Failed to create client, return code %d", rc);
         exit(EXIT_FAILURE);
     }
 
@@ -78,12 +535,16 @@ void run_publisher_process(const MQTTConfig *config, const char *url) {
 
     // 연결 옵션 설정
     conn_opts.keepAliveInterval = config->keep_alive_interval;
-    conn_opts.cleansession = 1;
-    conn_opts.ssl = &ssl_opts;
+    conn_opts.cleansession = config->clean_session;
+    conn_opts.ssl = config->use_tls ? &ssl_opts : NULL;
+    // Paho 동기 클라이언트는 reliable=1이면 in-flight 1개, 아니면 maxInflightMessages(기본 10)까지만
+    // 허용하고 넘는 발행은 실패시키므로 발행 윈도우와 같게 맞춤
+    conn_opts.reliable = 0;
+    conn_opts.maxInflightMessages = publisher_inflight_limit(config->publish_max_inflight);
 
     // Publisher 콜백 함수 설정 (기존 pubMessageHandler 활용)
-    if ((rc = MQTTClient_setCallbacks(pub_client, NULL, connectionLost, pubMessageHandler, NULL)) != MQTTCLIENT_SUCCESS) {
-        printf("Publisher: Failed to set callbacks, return code %d\n", rc);
+    if ((rc = MQTTClient_setCallbacks(pub_client, NULL, connectionLost, pubMessageHandler, publish_delivery_complete)) != MQTTCLIENT_SUCCESS) {
+        log_error("Publisher: Failed to set callbacks, return code %d", rc);
         cleanup_resources(&pub_client);
         exit(EXIT_FAILURE);
     }
@@ -93,61 +554,26 @@ void run_publisher_process(const MQTTConfig *config, const char *url) {
 
     // Publisher 연결
     if ((rc = MQTTClient_connect(pub_client, &conn_opts)) != MQTTCLIENT_SUCCESS) {
-        printf("Publisher: Failed to connect, return code %d\n", rc);
+        log_error("Publisher: Failed to connect, return code %d", rc);
         cleanup_resources(&pub_client);
         exit(EXIT_FAILURE);
     }
-    printf("Publisher connected successfully\n");
+    log_info("Publisher connected successfully");
+    print_startup_report("Publisher", start_ns);
 
-    // 이벤트 기반 Publisher 루프
-    while (running) {
-        char received_topic[MAX_TOPIC_LEN];
-        char received_payload[MAX_STRING_LEN];
-        
-        // IPC에서 제어 명령 수신
-        if (ipc_receive_control_message(msg_queue_id, received_topic, received_payload, sizeof(received_payload)) == 0) {
-            printf("Publisher: Processing control command for topic '%s'\n", received_topic);
-            
-            // 기존 토픽 파싱 함수 활용
-            ParsedTopic topic_info = parse_topic_hierarchy(received_topic);
-            if (topic_info.is_valid) {
-                // 기존 handle 함수들 활용
-                if (strcmp(topic_info.target_device, "led") == 0) {
-                    handle_led(topic_info.command);
-                } else if (strcmp(topic_info.target_device, "buzzer") == 0) {
-                    handle_buzzer(topic_info.command);
-                } else if (strcmp(topic_info.target_device, "s_segment") == 0) {
-                    // s_segment는 payload 값을 사용
-                    if (strlen(received_payload) > 0) {
-                        handle_s_segment(received_payload);
-                    } else {
-                        handle_s_segment(topic_info.command);
-                    }
-                } else if (strcmp(topic_info.target_device, "photoresistor") == 0) {
-                    handle_photoresistor(topic_info.command);
-                } else {
-                    printf("Publisher: Unknown device: %s\n", topic_info.target_device);
-                    
-                    // 알 수 없는 디바이스에 대한 에러 응답
-                    char error_topic[MAX_TOPIC_LEN];
-                    char error_result[MAX_STRING_LEN];
-                    
-                    snprintf(error_topic, sizeof(error_topic), "status/%s/%s/return", 
-                             topic_info.device_id, topic_info.target_device);
-                    snprintf(error_result, sizeof(error_result), 
-                             "{\"error\":\"unknown device\",\"device\":\"%s\",\"timestamp\":%ld}", 
-                             topic_info.target_device, time(NULL));
-                    
-                    send_result_to_topic(error_topic, error_result);
-                }
-            } else {
-                printf("Publisher: Invalid topic format: %s\n", received_topic);
-            }
-        }
-        
-        usleep(100000); // 100ms 대기
+    if (start_dispatch(&reactor, config) != 0 ||
+        reconnect_init(&reactor, "Publisher", pub_client, &conn_opts, config, NULL) != 0) {
+        // 발행 스레드/워커/스케줄러가 클라이언트를 쓰지 않도록 먼저 멈춤
+        stop_dispatch(&reactor);
+        cleanup_resources(&pub_client);
+        exit(EXIT_FAILURE);
     }
+
+    // 이벤트 기반 Publisher 루프 (IPC 도착/시그널/타이머/연결 끊김이 즉시 깨움)
+    reactor_run(&reactor);
     
+    stop_dispatch(&reactor);
+    reconnect_cleanup();
     cleanup_resources(&pub_client);
     exit(EXIT_SUCCESS);
 }
@@ -157,12 +583,21 @@ int run_subscriber_process(const MQTTConfig *config, const char *url, const Topi
     MQTTClient client;
     MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer;
     MQTTClient_SSLOptions ssl_opts = MQTTClient_SSLOptions_initializer;
+    Reactor reactor;
+    uint64_t start_ns = monotonic_time_ns();
     int rc;
     
+    // 종료 시그널과 재연결 이벤트를 받는 리액터 (MQTT 스레드 생성 전에 시그널 블록)
+    if (init_dispatch_reactor(&reactor) != 0) {
+        log_error("Subscriber: Failed to initialize reactor");
+        return EXIT_FAILURE;
+    }
+    
     // Subscriber 클라이언트 생성
     if ((rc = MQTTClient_create(&client, url, config->client_id,
             MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTCLIENT_SUCCESS) {
-        printf("Subscriber: Failed to create client, return code %d\n", rc);
+        log_error("Subscriber: Failed to create client, return code %d", rc);
+        reactor_cleanup(&reactor);
         return EXIT_FAILURE;
     }
     global_client = client;
@@ -175,52 +610,136 @@ int run_subscriber_process(const MQTTConfig *config, const char *url, const Topi
 
     // 연결 옵션 설정
     conn_opts.keepAliveInterval = config->keep_alive_interval;
-    conn_opts.cleansession = 1;
-    conn_opts.ssl = &ssl_opts;
+    conn_opts.cleansession = config->clean_session;
+    conn_opts.ssl = config->use_tls ? &ssl_opts : NULL;
+    
+    // 일반 메시지 파싱/출력용 워커 (콜백 스레드는 복사만 하고 바로 반환)
+    if (executor_start(config->worker_threads) < 0) {
+        log_warn("Subscriber: Failed to start workers, handling messages on the callback thread");
+    }
     
     // 콜백 함수 설정 (기존 함수명 변경)
     if ((rc = MQTTClient_setCallbacks(client, NULL, connectionLost, messageArrived_subscriber, NULL)) != MQTTCLIENT_SUCCESS) {
-        printf("Subscriber: Failed to set callbacks, return code %d\n", rc);
+        log_error("Subscriber: Failed to set callbacks, return code %d", rc);
         cleanup_resources(&client);
+        reactor_cleanup(&reactor);
         return EXIT_FAILURE;
     }
     
     // Subscriber 연결
     if ((rc = MQTTClient_connect(client, &conn_opts)) != MQTTCLIENT_SUCCESS) {
-        printf("Subscriber: Failed to connect, return code %d\n", rc);
+        log_error("Subscriber: Failed to connect, return code %d", rc);
         cleanup_resources(&client);
+        reactor_cleanup(&reactor);
         return EXIT_FAILURE;
     }
-    printf("Subscriber connected successfully\n");
+    log_info("Subscriber connected successfully");
 
     // 토픽 구독 시작
-    int subscribed_count = subscribe_to_topics(client, sub_topic_list, config->qos);
-    printf("Subscribed to %d out of %d topics\n", subscribed_count, sub_topic_list->count);
+    int subscribed_count = subscribe_to_topics(client, sub_topic_list, config->qos, config->subscribe_batch_size);
     
     if (subscribed_count == 0) {
-        printf("No topics were successfully subscribed. Exiting...\n");
+        log_error("No topics were successfully subscribed. Exiting...");
         cleanup_resources(&client);
+        reactor_cleanup(&reactor);
         return EXIT_FAILURE;
     }
+    print_startup_report("Subscriber", start_ns);
     
-    printf("Waiting for messages... (Press Ctrl+C to exit)\n");
+    if (reconnect_init(&reactor, "Subscriber", client, &conn_opts, config, sub_topic_list) != 0) {
+        cleanup_resources(&client);
+        reactor_cleanup(&reactor);
+        return EXIT_FAILURE;
+    }
+    
+    // 메시지는 Paho 스레드가 받아 워커에 넘기고, 이 스레드는 종료 시그널과 재연결만 처리
+    log_info("Waiting for messages... (Press Ctrl+C to exit)");
+    reactor_run(&reactor);
+    
+    log_info("Cleaning up subscriber resources...");
+    reactor_cleanup(&reactor);
+    reconnect_cleanup();
+    cleanup_resources(&client);
+    executor_shutdown_all();
+    return EXIT_SUCCESS;
+}
 
-    // 메시지 수신 대기 루프
-    while (running) {
-        sleep(1);
-        if (!MQTTClient_isConnected(client)) {
-            printf("Subscriber: Connection lost, attempting reconnection...\n");
-            if ((rc = MQTTClient_connect(client, &conn_opts)) == MQTTCLIENT_SUCCESS) {
-                printf("Subscriber: Reconnected successfully\n");
-                subscribe_to_topics(client, sub_topic_list, config->qos);
-            } else {
-                printf("Subscriber: Reconnection failed, return code %d\n", rc);
-                sleep(5);
-            }
-        }
+// 단일 프로세스 모드: 연결 하나로 구독과 발행을 모두 처리
+// Paho 콜백 스레드가 받은 명령은 프로세스 내 링을 거쳐 리액터 스레드에서 디스패치됨
+int run_single_process(const MQTTConfig *config, const char *url, const TopicList *sub_topic_list) {
+    MQTTClient client;
+    MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer;
+    MQTTClient_SSLOptions ssl_opts = MQTTClient_SSLOptions_initializer;
+    Reactor reactor;
+    uint64_t start_ns = monotonic_time_ns();
+    int rc;
+    
+    if (init_dispatch_reactor(&reactor) != 0) {
+        log_error("Gateway: Failed to initialize reactor");
+        return EXIT_FAILURE;
     }
     
-    printf("Cleaning up subscriber resources...\n");
+    // 클라이언트 생성
+    if ((rc = MQTTClient_create(&client, url, config->client_id,
+            MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTCLIENT_SUCCESS) {
+        log_error("Gateway: Failed to create client, return code %d", rc);
+        reactor_cleanup(&reactor);
+        return EXIT_FAILURE;
+    }
+
+    // SSL 옵션 설정
+    ssl_opts.trustStore = config->root_ca_file;
+    ssl_opts.keyStore = config->cert_file;
+    ssl_opts.privateKey = config->private_key_file;
+    ssl_opts.enableServerCertAuth = 1;
+
+    // 연결 옵션 설정
+    conn_opts.keepAliveInterval = config->keep_alive_interval;
+    conn_opts.cleansession = config->clean_session;
+    conn_opts.ssl = config->use_tls ? &ssl_opts : NULL;
+    conn_opts.reliable = 0;
+    conn_opts.maxInflightMessages = publisher_inflight_limit(config->publish_max_inflight);
+    
+    // 수신은 Subscriber 콜백, 발행은 같은 클라이언트 사용
+    if ((rc = MQTTClient_setCallbacks(client, NULL, connectionLost, messageArrived_subscriber, publish_delivery_complete)) != MQTTCLIENT_SUCCESS) {
+        log_error("Gateway: Failed to set callbacks, return code %d", rc);
+        cleanup_resources(&client);
+        reactor_cleanup(&reactor);
+        return EXIT_FAILURE;
+    }
+    set_pub_client(client);
+    
+    if ((rc = MQTTClient_connect(client, &conn_opts)) != MQTTCLIENT_SUCCESS) {
+        log_error("Gateway: Failed to connect, return code %d", rc);
+        cleanup_resources(&client);
+        reactor_cleanup(&reactor);
+        return EXIT_FAILURE;
+    }
+    log_info("Gateway connected successfully (single connection)");
+
+    int subscribed_count = subscribe_to_topics(client, sub_topic_list, config->qos, config->subscribe_batch_size);
+    if (subscribed_count == 0) {
+        log_error("No topics were successfully subscribed. Exiting...");
+        cleanup_resources(&client);
+        reactor_cleanup(&reactor);
+        return EXIT_FAILURE;
+    }
+    print_startup_report("Gateway", start_ns);
+    
+    if (start_dispatch(&reactor, config) != 0 ||
+        reconnect_init(&reactor, "Gateway", client, &conn_opts, config, sub_topic_list) != 0) {
+        stop_dispatch(&reactor);
+        cleanup_resources(&client);
+        return EXIT_FAILURE;
+    }
+    
+    log_info("Waiting for messages... (Press Ctrl+C to exit)");
+    reactor_run(&reactor);
+    
+    // 남은 결과를 발행한 뒤 연결 정리
+    log_info("Cleaning up gateway resources...");
+    stop_dispatch(&reactor);
+    reconnect_cleanup();
     cleanup_resources(&client);
     return EXIT_SUCCESS;
 }
@@ -236,29 +755,69 @@ int main(int argc, char* argv[]) {
     // IPC 초기화
     msg_queue_id = ipc_init();
     if (msg_queue_id == -1) {
-        printf("Failed to initialize IPC. Exiting...\n");
+        log_error("Failed to initialize IPC. Exiting...");
         return EXIT_FAILURE;
     }
 
     // 설정 파일 로드
     const char *config_file = (argc > 1) ? argv[1] : "config.conf";
     if (load_config_from_file(&config, config_file) <= 0) {
-        printf("Failed to load configuration. Exiting...\n");
+        log_error("Failed to load configuration. Exiting...");
         ipc_cleanup(msg_queue_id);
         return EXIT_FAILURE;
     }
     print_config(&config);
+    log_set_level(config.log_level);
+
+    // 단계별 통계는 공유 메모리에 두어 fork 후 두 프로세스가 함께 기록
+    metrics_init(&config, msg_queue_id);
+
+    // 상태 토픽은 fork 전에 만들어 두고 양쪽 프로세스가 읽기 전용으로 사용
+    status_topics_init(&config);
+    if (device_table_init(&config) < 0) {
+        ipc_cleanup(msg_queue_id);
+        return EXIT_FAILURE;
+    }
+
+    // 제어 모듈이 등록한 명령 테이블로 완전 해시 생성 (스레드 시작 전)
+    if (dispatch_build() < 0) {
+        ipc_cleanup(msg_queue_id);
+        return EXIT_FAILURE;
+    }
+    print_dispatch_table();
+
+    // 공유 메모리 링은 fork 전에 만들어야 양쪽 프로세스가 공유함
+    if (strcmp(config.ipc_transport, "msgqueue") != 0) {
+        ipc_enable_shm_ring((size_t)config.ipc_ring_size);
+    }
 
     // 구독용 토픽 목록 로드
     if (load_topics_from_file(&sub_topic_list, config.topic_file) <= 0) {
-        printf("No subscriber topics loaded. Exiting...\n");
+        log_error("No subscriber topics loaded. Exiting...");
+        ipc_cleanup(msg_queue_id);
+        return EXIT_FAILURE;
+    }
+
+    // 구독 필터별 처리기 연결
+    if (build_topic_routes(&sub_topic_list) != 0) {
+        topic_list_free(&sub_topic_list);
         ipc_cleanup(msg_queue_id);
         return EXIT_FAILURE;
     }
 
     // MQTT 브로커 URL 생성
-    snprintf(url, sizeof(url), "ssl://%s:%d", config.endpoint, config.port);
-    printf("Connecting to: %s\n", url);
+    snprintf(url, sizeof(url), "%s://%s:%d", config.use_tls ? "ssl" : "tcp", config.endpoint, config.port);
+    log_info("Connecting to: %s", url);
+
+    // 단일 프로세스 모드: fork 없이 연결 하나로 처리
+    if (strcmp(config.process_mode, "single") == 0) {
+        // 로거 스레드 시작 (fork 모드는 스레드가 복제되지 않으므로 fork 후 각 프로세스에서 시작)
+        log_start();
+        int result = run_single_process(&config, url, &sub_topic_list);
+        topic_list_free(&sub_topic_list);
+        ipc_cleanup(msg_queue_id);
+        return result;
+    }
 
     // fork()를 사용해 Publisher와 Subscriber 분리
     pid_t pid = fork();
@@ -270,15 +829,18 @@ int main(int argc, char* argv[]) {
     
     if (pid == 0) {
         // 자식 프로세스: Publisher 역할
+        log_start();
         run_publisher_process(&config, url);
     } else {
         // 부모 프로세스: Subscriber 역할
+        log_start();
         int result = run_subscriber_process(&config, url, &sub_topic_list);
         
         // 자식 프로세스 종료 대기
-        printf("Waiting for publisher process to terminate...\n");
+        log_info("Waiting for publisher process to terminate...");
         wait(NULL);
         
+        topic_list_free(&sub_topic_list);
         ipc_cleanup(msg_queue_id);
         return result;
     }
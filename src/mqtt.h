@@ -12,20 +12,176 @@
 #include <sys/msg.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <ctype.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <pthread.h>
 
 // 추가 프로그램
 #include "MQTTClient.h"
 #include <cjson/cJSON.h>
 
-#define MAX_TOPICS 100
 #define MAX_TOPIC_LEN 256
+#define TOPIC_CHUNK_SIZE 8192       // 토픽 문자열 저장소 블록 크기
+#define SUBSCRIBE_DEFAULT_BATCH_SIZE 1000  // SUBSCRIBE 패킷 하나에 담는 토픽 수
+#define RECONNECT_DEFAULT_MIN_MS 500       // 첫 재연결 대기 (시도마다 두 배)
+#define RECONNECT_DEFAULT_MAX_MS 30000     // 재연결 대기 상한
 #define MAX_STRING_LEN 512
 #define MAX_PAYLOAD_SIZE (1024 * 1024)
+#define MAX_REACTOR_HANDLERS 16
+#define IPC_RING_DEFAULT_SIZE (4 * 1024 * 1024)
+#define MAX_PRIORITY_RULES 64
+#define MAX_EXECUTOR_WORKERS 64
+#define MAX_EXECUTOR_QUEUE 4096     // 워커 하나에 쌓일 수 있는 최대 작업 수
+#define MAX_SCHEDULED_TASKS 65536
+#define SCHEDULE_MAX_DELAY_MS (30ULL * 24 * 3600 * 1000)  // 예약 지연/주기 상한 (30일, 넘으면 거부)
+#define SCHEDULE_INTERNAL_PREFIX '@'                       // 내부 작업 id 접두사 (원격 id/cancel에는 쓸 수 없음)
+#define PUBLISH_DEFAULT_MAX_INFLIGHT 64
+#define PUBLISH_MAX_INFLIGHT 65535          // QoS 1 패킷 ID 수 (Paho maxInflightMessages로도 넘김)
+#define PUBLISH_RETRY_DELAY_NS (100ULL * 1000000ULL)  // 일시 실패(연결 끊김/Paho 한도) 후 재시도 간격
+#define PUBLISH_DEFAULT_QUEUE_SIZE 4096
+#define PUBLISH_EARLY_ACKS 16
+#define PUBLISH_INFLIGHT_TIMEOUT_NS (30ULL * 1000000000ULL)
+#define MAX_TOPIC_LEVELS 16         // TopicTokens에 위치를 저장하는 최대 단계 수
+#define MAX_TOPIC_ROUTES 8          // 토픽 하나에 대해 한 번에 꺼내는 최대 필터 수
+#define JSON_EXTRACT_MAX_DEPTH 64     // 이보다 깊게 중첩된 문서는 cJSON으로 처리
+#define JSON_EXTRACT_INVALID (-1)
+#define JSON_EXTRACT_COMPLEX (-2)
+#define MAX_STATUS_TOPICS 64
+#define MAX_DISPATCH_ENTRIES 1024
+#define DISPATCH_ANY_COMMAND "*"        // 디바이스의 나머지 명령 전부
+#define DISPATCH_ARG_PAYLOAD 0x01       // 명령 대신 페이로드(예약이면 value)를 인자로 전달
+#define DISPATCH_INLINE 0x02            // 워커 대신 디스패치 스레드에서 바로 실행 (스케줄러를 쓰는 설정 명령)
+#define DEFAULT_DEVICE_ID "raspberry_001"
+#define MAX_DEVICE_ID_LEN 64
+#define TELEMETRY_DEFAULT_SAMPLE_MS 1000      // 스트리밍 샘플 주기
+#define TELEMETRY_DEFAULT_DEADBAND 16         // 마지막 발행 값과 이만큼 넘게 달라져야 발행 (ADC 단위)
+#define TELEMETRY_DEFAULT_HEARTBEAT_MS 60000  // 변화가 없어도 이 주기로 한 번 발행
+#define TELEMETRY_MIN_SAMPLE_MS 10
+#define SAMPLE_WINDOW_DEFAULT_CAPACITY 1024   // 센서별 링에 남기는 최근 샘플 수
+#define SAMPLE_WINDOW_MAX_CAPACITY (1 << 24)
+#define SAMPLE_WINDOW_BUCKETS 64              // 백분위 근사 히스토그램 칸 수 (ADC 0-1023이면 16단위)
+#define SAMPLE_WINDOW_EWMA_ALPHA 0.1
+#define MAX_CBOR_FILTERS 32
+#define CBOR_MARKER "\xd9\xd9\xf7"      // 자기 기술 태그 55799 (CBOR 페이로드 표시)
+#define CBOR_MARKER_LEN 3
+#define CBOR_MAX_DEPTH 32
+#define CBOR_INVALID (-1)               // cbor_to_json: 형식 오류
+#define CBOR_TOO_LARGE (-2)             // cbor_to_json: 출력 버퍼 부족 (alloc 판은 MAX_PAYLOAD_SIZE 초과)
+#define MAX_COMPRESS_FILTERS 32
+#define COMPRESS_MARKER "\x1f\x8b\x08"  // gzip 헤더 (ID1 ID2 CM=deflate, 압축 페이로드 표시)
+#define COMPRESS_MARKER_LEN 3
+#define COMPRESS_DEFAULT_MIN_BYTES 512    // 이보다 작은 페이로드는 압축하지 않음 (결과 하나는 거의 줄지 않음)
+#define COMPRESS_DEFAULT_LEVEL 6
+#define RESULT_BUFFER_SIZE MAX_STRING_LEN
+#define RESULT_RESERVE 40           // ,"timestamp":<20자리>} + 널 문자
+#define MAX_BATCH_FILTERS 32
+#define MAX_BATCH_TOPICS 64
+#define BATCH_DEFAULT_MAX_DELAY_MS 50
+#define BATCH_DEFAULT_MAX_BYTES (64 * 1024)
+#define METRIC_HIST_SUB_BITS 4       // 히스토그램 2배 구간당 16칸
+#define METRIC_HIST_BUCKETS 592     // 최대 약 2^40 ns (18분), 넘으면 마지막 칸
+#define MAX_METRIC_DEVICES 32
+#define METRICS_DEFAULT_INTERVAL_MS 10000
+#define METRICS_SNAPSHOT_SIZE 16384
+#define LOG_RECORD_SIZE 256         // 로그 레코드 고정 크기 (인자 + 인라인 문자열)
+#define LOG_MAX_ARGS 8
+#define LOG_RING_RECORDS 1024       // 스레드별 링 크기 (2의 거듭제곱)
 
-// 토픽 저장 구조체
+// 로그 레벨 (번호가 클수록 자세함)
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+// 컴파일 시 남길 최대 레벨 (make LOG_LEVEL=1 이면 info/debug 호출이 코드에서 빠짐)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// 배치 플러시 사유
+enum {
+    BATCH_FLUSH_COUNT = 0,
+    BATCH_FLUSH_BYTES,
+    BATCH_FLUSH_TIMEOUT,
+    BATCH_FLUSH_SHUTDOWN
+};
+
+// 지연 측정 단계 (metrics.c)
+enum {
+    METRIC_STAGE_RECEIVE = 0,   // 구독 콜백 (수신 → IPC 전달)
+    METRIC_STAGE_IPC_WAIT,      // IPC 대기 (전달 → 발행 측 수신)
+    METRIC_STAGE_DISPATCH,      // 명령 분배 (토픽 해석 → 실행기 등록)
+    METRIC_STAGE_EXECUTOR_WAIT, // 실행기 대기열
+    METRIC_STAGE_HANDLER,       // 디바이스 핸들러 실행
+    METRIC_STAGE_PUBLISH,       // 결과 대기열 → 발행 호출 완료
+    METRIC_STAGE_PUBACK,        // 발행 → PUBACK
+    METRIC_STAGE_RECONNECT,     // 연결 끊김 → 재연결/재구독 완료
+    METRIC_STAGE_COMPRESS,      // 발행 페이로드 압축 (CPU 비용)
+    METRIC_STAGE_DECOMPRESS,    // 수신 페이로드 압축 해제
+    METRIC_STAGE_COUNT
+};
+
+// 카운터 (metrics.c)
+enum {
+    METRIC_MESSAGES_RECEIVED = 0,
+    METRIC_CONTROL_FORWARDED,
+    METRIC_IPC_SEND_FAILED,
+    METRIC_COMMANDS_DISPATCHED,
+    METRIC_COMMANDS_SCHEDULED,
+    METRIC_UNKNOWN_DEVICE,
+    METRIC_UNKNOWN_DEVICE_ID,
+    METRIC_EXECUTOR_REJECTED,
+    METRIC_CONNECTIONS_LOST,
+    METRIC_RECONNECT_ATTEMPTS,
+    METRIC_SESSIONS_RESUMED,
+    METRIC_TELEMETRY_SAMPLES,
+    METRIC_TELEMETRY_PUBLISHED,
+    METRIC_CBOR_COMMANDS,
+    METRIC_CBOR_INVALID,
+    METRIC_CBOR_OVERSIZE,           // JSON으로 바꾸면 MAX_PAYLOAD_SIZE를 넘는 CBOR 명령
+    METRIC_PAYLOADS_COMPRESSED,
+    METRIC_COMPRESS_SKIPPED,        // 문턱값은 넘었지만 압축해도 줄지 않아 원본 발행
+    METRIC_COMPRESS_BYTES_IN,       // 압축 전/후 바이트 합 (압축률 = in / out)
+    METRIC_COMPRESS_BYTES_OUT,
+    METRIC_PAYLOADS_INFLATED,
+    METRIC_INFLATE_INVALID,
+    METRIC_COUNTER_COUNT
+};
+
+// 페이로드 인코딩 (cbor.c)
+enum {
+    PAYLOAD_ENCODING_JSON = 0,
+    PAYLOAD_ENCODING_CBOR
+};
+
+// 제어 명령 우선순위 레인 (번호가 작을수록 먼저 처리)
+enum {
+    IPC_LANE_HIGH = 0,
+    IPC_LANE_NORMAL,
+    IPC_LANE_LOW,
+    IPC_LANE_COUNT
+};
+
+// 토픽 문자열 저장소 블록 (topic_manager.c)
+typedef struct TopicChunk TopicChunk;
+
+// 토픽 저장 구조체 (개수 제한 없음, 같은 토픽은 한 번만 저장)
+// topics[i]는 topic_list_free 전까지 주소가 바뀌지 않음
 typedef struct {
-    char topics[MAX_TOPICS][MAX_TOPIC_LEN];
+    char **topics;
+    int *qos;                   // 토픽별 QoS (-1이면 구독 시 기본값 사용)
     int count;
+    int capacity;
+    uint32_t *index;            // 중복 확인용 해시 (항목 번호 + 1, 0은 빈 칸)
+    uint32_t index_mask;
+    TopicChunk *chunks;
 } TopicList;
 
 // MQTT 설정 구조체
@@ -37,17 +193,65 @@ typedef struct {
     char root_ca_file[MAX_STRING_LEN];
     char client_id[MAX_STRING_LEN];
     char topic_file[MAX_STRING_LEN];
+    char pub_topic_file[MAX_STRING_LEN];  // 상태(발행) 토픽 목록
+    char device_id[64];         // 상태 토픽에 쓰는 게이트웨이 디바이스 ID
+    int use_tls;                // 0이면 평문 TCP (로컬 벤치마크 브로커용)
     int qos;
+    int subscribe_batch_size;   // SUBSCRIBE 요청 하나에 담는 최대 토픽 수
+    int clean_session;          // 0이면 지속 세션 (재연결 시 브로커가 구독과 QoS 1 메시지 유지)
+    int reconnect_min_ms;       // 재연결 백오프 시작/상한
+    int reconnect_max_ms;
+    int telemetry_sample_ms;    // 조도 스트리밍 기본값 (stream 명령 페이로드로 디바이스별 변경)
+    int telemetry_deadband;
+    int telemetry_heartbeat_ms; // 0이면 하트비트 없음
+    int telemetry_min_publish_ms;  // 발행 간 최소 간격 (최대 발행률 제한, 0이면 제한 없음)
+    int sensor_window_samples;  // 센서별 통계 링 크기 (stats 명령이 보는 최근 샘플 수)
     int keep_alive_interval;
     int timeout;
+    char ipc_transport[16];     // "shm" (공유 메모리 링) 또는 "msgqueue"
+    long ipc_ring_size;         // 공유 메모리 링 크기 (바이트)
+    char process_mode[16];      // "fork" (구독/발행 프로세스 분리) 또는 "single"
+    int worker_threads;         // 명령/메시지 워커 수 (0이면 CPU 수)
+    int publish_max_inflight;   // PUBACK 대기 중 허용 메시지 수
+    int publish_queue_size;     // 발행 대기열 크기
+    int batch_max_messages;     // 배치당 최대 결과 수 (1 이하면 배치 안 함)
+    int batch_max_delay_ms;     // 첫 결과부터 플러시까지 최대 지연
+    long batch_max_bytes;       // 배치 페이로드 최대 크기
+    char batch_topics[MAX_BATCH_FILTERS][MAX_TOPIC_LEN];  // 배치를 허용한 토픽 필터
+    int batch_topic_count;
+    char cbor_topics[MAX_CBOR_FILTERS][MAX_TOPIC_LEN];  // 결과를 CBOR로 보낼 토픽 필터
+    int cbor_topic_count;
+    char compress_topics[MAX_COMPRESS_FILTERS][MAX_TOPIC_LEN];  // 결과를 gzip으로 압축할 토픽 필터
+    int compress_topic_count;
+    int compress_min_bytes;     // 압축 문턱값 (바이트)
+    int compress_level;         // deflate 수준 1-9
+    int log_level;              // 실행 시 로그 레벨 (LOG_LEVEL_*)
+    int metrics_interval_ms;    // 통계 보고 주기 (0이면 보고 안 함)
+    char metrics_topic[MAX_TOPIC_LEN];    // 비어 있으면 metrics/<client_id>
+    char metrics_file[MAX_STRING_LEN];    // Prometheus 텍스트 파일 (비어 있으면 쓰지 않음)
 } MQTTConfig;
 
-// 파싱된 토픽 정보 구조체
+// 토픽 한 단계 (원본 토픽 문자열 안의 위치와 길이)
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} TopicLevel;
+
+// 토큰화된 토픽 (원본을 복사하지 않고 가리키기만 함)
 typedef struct {
-    char prefix[64];
-    char device_id[64];
-    char target_device[64];
-    char command[64];
+    const char *topic;
+    int level_count;            // 전체 단계 수 (MAX_TOPIC_LEVELS보다 클 수 있음)
+    TopicLevel levels[MAX_TOPIC_LEVELS];
+} TopicTokens;
+
+// 파싱된 토픽 정보 구조체 (prefix/device_id/target_device/command 뷰)
+// topic이 가리키는 원본 문자열이 살아 있는 동안만 유효
+typedef struct {
+    const char *topic;
+    TopicLevel prefix;
+    TopicLevel device_id;
+    TopicLevel target_device;
+    TopicLevel command;
     int is_valid;
 } ParsedTopic;
 
@@ -62,21 +266,255 @@ typedef struct {
     int is_json;
 } ParsedMessage;
 
+// JSON 값 종류 (json_extract.c)
+enum {
+    JSON_FIELD_NONE = 0,
+    JSON_FIELD_STRING,
+    JSON_FIELD_NUMBER,
+    JSON_FIELD_BOOL,
+    JSON_FIELD_NULL,
+    JSON_FIELD_OBJECT,
+    JSON_FIELD_ARRAY
+};
+
+// 추출할 JSON 필드 (값은 원본 페이로드를 가리킴, 문자열이면 따옴표 안쪽)
+typedef struct {
+    const char *key;
+    const char *value;
+    int value_len;
+    int type;
+    int escaped;                // 문자열에 이스케이프가 있음 (json_field_copy로 풀어서 사용)
+} JsonField;
+
 // 메시지 큐를 위한 구조체
 typedef struct {
-    long msg_type;
+    long msg_type;              // 레인 + 1 (msgrcv 음수 타입으로 우선순위 수신)
+    uint64_t enqueue_ns;
+    int payload_len;            // CBOR 페이로드는 중간에 0 바이트가 있을 수 있음
     char topic[MAX_TOPIC_LEN];
     char payload[MAX_STRING_LEN];
 } control_message_t;
 
+// IPC로 받은 제어 명령 (공유 링 사용 시 링 메모리를 직접 가리킴, 널 종료 보장)
+typedef struct {
+    const char *topic;
+    int topic_len;
+    const char *payload;
+    int payload_len;
+    int lane;
+    uint64_t stamp;             // 송신 시각 (CLOCK_MONOTONIC ns)
+    uint64_t release_pos;
+} IPCRecordView;
+
+// IPC 큐 통계
+typedef struct {
+    uint64_t enqueued;
+    uint64_t dequeued;
+    uint64_t dropped;
+    uint64_t depth_messages;
+    uint64_t depth_bytes;
+    uint64_t capacity_bytes;
+} IPCStats;
+
+// 레인별 대기 지연/드롭 통계
+typedef struct {
+    uint64_t received;
+    uint64_t dropped;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+} IPCLaneStats;
+
+// fork() 사이에 공유되는 SPSC 링 버퍼 (shm_ring.c)
+typedef struct ShmRing ShmRing;
+
+// 구독 필터에 연결하는 처리기 (message는 호출자가 넘긴 수신 메시지)
+typedef void (*topic_route_t)(const char *topic, void *message, void *context);
+
+// 토픽 필터 → 처리기 항목 (topic_trie.c)
+typedef struct {
+    char *filter;
+    topic_route_t handler;
+    void *context;
+} TopicRoute;
+
+// MQTT 와일드카드 토픽 트라이 (topic_trie.c)
+typedef struct TopicTrie TopicTrie;
+
+// 디바이스 핸들러 (명령 문자열 하나를 받음)
+typedef void (*device_handler_t)(const char *command);
+
+// 일반 메시지 처리기 (워커 풀에서 실행, payload는 payload_len 바이트)
+typedef void (*message_handler_t)(const char *topic, const char *payload, int payload_len);
+
+// (디바이스, 명령) → 핸들러 등록 항목 (dispatch.c)
+typedef struct {
+    const char *device;
+    const char *command;        // DISPATCH_ANY_COMMAND면 정확히 일치하는 항목이 없을 때 사용
+    device_handler_t handler;
+    int flags;
+} DispatchEntry;
+
+// 제어 모듈 등록: control/*.c에서 명령 테이블을 선언하고 이 매크로를 쓰면
+// main 실행 전에 레지스트리에 올라감 (main.c 수정 불필요)
+#define DISPATCH_MODULE(table) \
+    __attribute__((constructor)) static void table##_register(void) { \
+        dispatch_register_table(table, (int)(sizeof(table) / sizeof(table[0]))); \
+    }
+
+// 디바이스별 조도 스트리밍 상태 (photoresistor.c)
+typedef struct TelemetryStream TelemetryStream;
+
+// 센서 샘플 링 버퍼 (sample_window.c)
+typedef struct SampleWindow SampleWindow;
+
+// 구간 통계 결과 (백분위는 히스토그램 근사)
+typedef struct {
+    int count;
+    uint32_t span_ms;           // 구간 첫 샘플부터 마지막 샘플까지
+    int32_t min;
+    int32_t max;
+    int32_t last;
+    double mean;
+    double stddev;
+    double ewma;                // 구간과 관계없이 지금까지의 지수 이동 평균
+    double p50;
+    double p90;
+    double p99;
+} WindowStats;
+
+// 게이트웨이가 맡은 디바이스 하나의 상태 (device_table.c)
+// physical이면 실제 하드웨어를 구동하고, 아니면 아래 상태 값만 바꾸는 가상 디바이스
+typedef struct {
+    char id[MAX_DEVICE_ID_LEN];
+    uint32_t hash;
+    uint8_t id_len;
+    uint8_t physical;
+    uint8_t led_on;
+    uint8_t buzzer_on;
+    int8_t segment_value;       // -1이면 꺼짐
+    int16_t light_value;        // 포토레지스터 시뮬레이션 기준값 (0-1023)
+    time_t light_time;          // 기준값을 마지막으로 바꾼 시각
+    uint64_t commands;          // 처리한 명령 수
+    TelemetryStream *stream;    // 처음 stream 명령을 받을 때 할당
+    SampleWindow *light_window; // 처음 조도를 읽을 때 할당 (포토레지스터 워커 전용)
+} VirtualDevice;
+
+// 상태 결과 생성기 (스택에 두고 재사용, 힙 할당 없음)
+// encoding이 CBOR면 buf는 널 종료 문자열이 아니므로 len을 함께 써야 함
+typedef struct {
+    char buf[RESULT_BUFFER_SIZE];
+    size_t len;
+    int fields;
+    int truncated;
+    int encoding;               // PAYLOAD_ENCODING_* (result_init 때 스레드의 현재 인코딩)
+} ResultBuilder;
+
+// 발행 대기열 항목 (topic\0 payload\0 를 구조체 뒤에 이어서 할당)
+typedef struct {
+    int payload_len;
+    char *payload;
+    uint64_t enqueue_ns;        // 대기열 진입 시각 (배치면 첫 결과 기준)
+    char topic[];
+} PublishItem;
+
+// 배치 단계 통계 (플러시 사유별)
+typedef struct {
+    uint64_t batches;
+    uint64_t batched_messages;
+    uint64_t flush_count;
+    uint64_t flush_bytes;
+    uint64_t flush_timeout;
+    uint64_t flush_shutdown;
+    uint64_t dropped;
+} BatchStats;
+
+// 발행 파이프라인 통계
+typedef struct {
+    uint64_t enqueued;
+    uint64_t published;
+    uint64_t delivered;
+    uint64_t failed;
+    uint64_t dropped;
+    uint64_t expired;
+    uint64_t retried;           // 일시 실패로 되돌려 다시 보낸 횟수
+    int queue_depth;
+    int inflight;
+    BatchStats batch;
+} PublishStats;
+
+// 로거 통계 (logger.c)
+typedef struct {
+    uint64_t written;
+    uint64_t dropped;           // 스레드 링이 가득 차 버린 레코드
+} LogStats;
+
+// 예약 작업 콜백
+typedef void (*scheduler_callback_t)(void *context);
+
+// 페이로드로 전달된 예약 지시
+typedef struct {
+    char id[64];
+    char cancel_id[64];
+    char value[MAX_STRING_LEN];
+    uint64_t delay_ms;
+    uint64_t interval_ms;
+    int count;                  // 반복 횟수 (-1이면 취소 전까지 무제한)
+    int has_schedule;
+    int has_cancel;
+    int has_value;
+    int out_of_range;           // 지연/주기가 SCHEDULE_MAX_DELAY_MS를 넘음 (예약 거부)
+    int reserved_id;            // id/cancel이 SCHEDULE_INTERNAL_PREFIX로 시작 (예약/취소 거부)
+} ScheduleSpec;
+
+// 리액터 이벤트 콜백 (fd, epoll 이벤트, 등록 시 전달한 context)
+typedef void (*reactor_callback_t)(int fd, uint32_t events, void *context);
+
+// 리액터에 등록된 핸들러
+typedef struct {
+    int fd;
+    reactor_callback_t callback;
+    void *context;
+    int owned;
+} ReactorHandler;
+
+// epoll 기반 이벤트 루프
+typedef struct {
+    int epoll_fd;
+    volatile int running;
+    ReactorHandler handlers[MAX_REACTOR_HANDLERS];
+    int handler_count;
+} Reactor;
+
 // topic_manager.c 함수들
 int load_config_from_file(MQTTConfig *config, const char *filename);
+int topic_list_init(TopicList *topic_list);
+void topic_list_free(TopicList *topic_list);
+int topic_list_add(TopicList *topic_list, const char *topic, int qos);
 int load_topics_from_file(TopicList *topic_list, const char *filename);
 int validate_topic_format(const char *topic);
-int subscribe_to_topics(MQTTClient client, TopicList *topic_list, int qos);
+int topic_matches_filter(const char *filter, const char *topic);
+int subscribe_to_topics(MQTTClient client, const TopicList *topic_list, int qos, int batch_size);
+
+// 토픽 트라이 (topic_trie.c)
+TopicTrie *topic_trie_create(void);
+void topic_trie_destroy(TopicTrie *trie);
+int topic_trie_insert(TopicTrie *trie, const char *filter, topic_route_t handler, void *context);
+int topic_trie_remove(TopicTrie *trie, const char *filter);
+int topic_trie_count(const TopicTrie *trie);
+int topic_trie_match(const TopicTrie *trie, const char *topic, const TopicRoute **routes, int max_routes);
+
+// 재연결 (reconnect.c)
+int reconnect_init(Reactor *reactor, const char *role, MQTTClient client,
+                   MQTTClient_connectOptions *conn_opts, const MQTTConfig *config, const TopicList *topics);
+void reconnect_connection_lost(void);
+void reconnect_cleanup(void);
 
 // message_handler.c 함수들
-ParsedTopic parse_topic_hierarchy(const char *topic_name);
+int topic_next_level(const char *topic, size_t *pos, TopicLevel *level);
+int topic_tokenize(const char *topic, TopicTokens *tokens);
+int parse_topic_view(const char *topic, ParsedTopic *parsed);
+int topic_level_is(const char *topic, TopicLevel level, const char *literal);
+size_t topic_level_copy(const char *topic, TopicLevel level, char *buf, size_t size);
 ParsedMessage parse_message_payload(const char *payload, int payload_len);
 void print_message_info(const ParsedTopic *topic_info, const ParsedMessage *msg_info);
 int messageArrived(void *context, char *topicName, int topicLen, MQTTClient_message *message);
@@ -86,24 +524,199 @@ void connectionLost(void *context, char *cause);
 int pubMessageHandler(void *context, char *topicName, int topicLen, MQTTClient_message *message);
 void set_pub_client(MQTTClient client);
 void send_result_to_topic(const char *topic, const char *value);
+void send_result_payload(const char *topic, const char *payload, int payload_len);
+void publish_delivery_complete(void *context, MQTTClient_deliveryToken dt);
+int publisher_inflight_limit(int requested);
+int publisher_start(int max_inflight, int queue_size);
+void publisher_stop(int timeout_ms);
+void publisher_get_stats(PublishStats *stats);
+
+// CBOR 인코딩 (cbor.c)
+void cbor_configure(const MQTTConfig *config);
+int cbor_topic_count(void);
+int cbor_wants(const char *topic);
+int cbor_is_marked(const void *payload, int len);
+int cbor_key_id(const char *key, size_t len);
+size_t cbor_put_head(uint8_t *out, int major, uint64_t value);
+int cbor_to_json(const void *payload, int len, char *out, size_t size);
+int cbor_to_json_alloc(const void *payload, int len, char **out);
+
+// 페이로드 압축 (compress.c)
+void compress_configure(const MQTTConfig *config);
+int compress_wants(const char *topic);
+int compress_is_marked(const void *payload, int len);
+int compress_payload(const char *payload, int len, char **out);
+int compress_inflate(const void *payload, int len, char **out);
+
+// JSON 필드 추출 (json_extract.c)
+int json_extract_fields(const char *json, int json_len, JsonField *fields, int field_count);
+size_t json_field_copy(const JsonField *field, char *buf, size_t size);
+int json_field_number(const JsonField *field, double *out);
+int json_field_int(const JsonField *field, int *out);
+
+// 상태 결과 생성 (result_builder.c)
+int status_topics_init(const MQTTConfig *config);
+const char *status_device_id(void);
+const char *status_topic_for(const char *target);
+int status_topic_format(const char *device_id, size_t id_len, const char *target, char *buf, size_t size);
+void result_set_encoding(int encoding);
+int result_encoding(void);
+void result_init(ResultBuilder *rb);
+void result_begin(ResultBuilder *rb, const char *device_label, const char *command);
+void result_add_str(ResultBuilder *rb, const char *key, const char *value);
+void result_add_strn(ResultBuilder *rb, const char *key, const char *value, size_t len);
+void result_add_int(ResultBuilder *rb, const char *key, long value);
+void result_add_double(ResultBuilder *rb, const char *key, double value);
+const char *result_finish(ResultBuilder *rb);
+void result_publish(ResultBuilder *rb, const char *target);
+void result_publish_to(ResultBuilder *rb, const char *topic);
+
+// 발행 배치 단계 (publish_batcher.c)
+void batcher_configure(const MQTTConfig *config);
+int batcher_wants(const char *topic);
+PublishItem *batcher_append(PublishItem *item, uint64_t now);
+PublishItem *batcher_take_expired(uint64_t now);
+PublishItem *batcher_take_any(void);
+uint64_t batcher_next_deadline(void);
+void batcher_get_stats(BatchStats *stats);
+void batcher_cleanup(void);
 
 // IPC 통신 관련 함수들
 int ipc_init(void);
 void ipc_cleanup(int msg_queue_id);
-int ipc_send_control_message(int msg_queue_id, const char *topic, const char *payload);
+int ipc_enable_shm_ring(size_t capacity);
+int ipc_send_control_message(int msg_queue_id, int lane, const char *topic, const char *payload, int payload_len);
 int ipc_receive_control_message(int msg_queue_id, char *topic, char *payload, size_t payload_size);
+int ipc_receive_control_view(int msg_queue_id, IPCRecordView *view);
+void ipc_release_control_view(const IPCRecordView *view);
+void ipc_get_stats(int msg_queue_id, IPCStats *stats);
+void ipc_get_lane_stats(int lane, IPCLaneStats *stats);
+int ipc_get_event_fd(void);
+
+// 공유 메모리 SPSC 링 함수들
+ShmRing *shm_ring_create(size_t capacity);
+void shm_ring_destroy(ShmRing *ring);
+int shm_ring_push(ShmRing *ring, const char *topic, size_t topic_len,
+                  const char *payload, size_t payload_len, uint64_t stamp);
+int shm_ring_peek(ShmRing *ring, IPCRecordView *view);
+void shm_ring_release(ShmRing *ring, const IPCRecordView *view);
+void shm_ring_get_stats(ShmRing *ring, IPCStats *stats);
 
-// device_control.c 함수들
-int photoresistor_read(void);
+// 리액터(이벤트 루프) 관련 함수들
+int reactor_init(Reactor *reactor);
+int reactor_add_fd(Reactor *reactor, int fd, reactor_callback_t callback, void *context);
+int reactor_add_signals(Reactor *reactor, const int *signals, int count,
+                        reactor_callback_t callback, void *context);
+int reactor_add_timer(Reactor *reactor, long interval_ms,
+                      reactor_callback_t callback, void *context);
+int reactor_run(Reactor *reactor);
+void reactor_stop(Reactor *reactor);
+void reactor_cleanup(Reactor *reactor);
+uint64_t reactor_drain_fd(int fd);
+uint64_t monotonic_time_ns(void);
+
+// 명령 분배 레지스트리 관련 함수들
+int dispatch_register(const char *device, const char *command, device_handler_t handler, int flags);
+int dispatch_register_table(const DispatchEntry *entries, int count);
+int dispatch_build(void);
+const DispatchEntry *dispatch_lookup(const ParsedTopic *topic_info);
+const DispatchEntry *dispatch_lookup_name(const char *device, size_t device_len, const char *command, size_t command_len);
+int dispatch_entry_count(void);
+void print_dispatch_table(void);
+
+// 디바이스 실행기 관련 함수들
+int executor_start(int workers);
+int executor_worker_count(void);
+int executor_submit(const char *device, int lane, device_handler_t handler, VirtualDevice *target, const char *arg);
+int executor_submit_message(const char *key, size_t key_len, message_handler_t handler,
+                            const char *topic, const char *payload, int payload_len);
+void executor_shutdown_all(void);
+
+// 디바이스 ID 테이블 관련 함수들
+int device_table_add(const char *id, int physical);
+int device_table_add_range(const char *spec);
+int device_table_init(const MQTTConfig *config);
+VirtualDevice *device_table_find(const char *id, size_t len);
+VirtualDevice *device_table_primary(void);
+int device_table_count(void);
+size_t device_table_memory(void);
+void device_table_cleanup(void);
+void device_set_current(VirtualDevice *device);
+VirtualDevice *device_current(void);
+
+// 센서 샘플 링/구간 통계 관련 함수들
+SampleWindow *sample_window_create(int capacity, int32_t range_min, int32_t range_max);
+void sample_window_push(SampleWindow *w, int32_t value, uint64_t now_ms);
+int sample_window_count(const SampleWindow *w);
+int sample_window_stats(const SampleWindow *w, uint64_t window_ms, uint64_t now_ms, WindowStats *stats);
+int sample_window_stats_last(const SampleWindow *w, int samples, WindowStats *stats);
+long sample_window_parse_duration(const char *text, size_t len);
+
+// 예약 실행 스케줄러 관련 함수들
+int scheduler_init(Reactor *reactor);
+int scheduler_add(const void *owner, const char *id, uint64_t delay_ns, uint64_t interval_ns, int count,
+                  scheduler_callback_t callback, void *context, void (*free_context)(void *context));
+int scheduler_cancel(const void *owner, const char *id);
+int scheduler_pending(void);
+void scheduler_cleanup(void);
+int scheduler_parse_spec(const char *payload, ScheduleSpec *spec);
+
+// 명령 우선순위 관련 함수들
+int priority_add_rule(const char *spec);
+int priority_classify(const ParsedTopic *topic_info);
+int priority_lane_from_name(const char *name);
+const char *priority_lane_name(int lane);
+void print_priority_rules(void);
+
+// 장치 하드웨어 제어 함수들 (명령 핸들러는 각 control/*.c가 DISPATCH_MODULE로 등록)
+int photoresistor_read(VirtualDevice *device);
+void photoresistor_configure(const MQTTConfig *config);
 void led_control(int on_off);
 void buzzer_control(int on_off);
 void seven_segment_display(int value);
 
-// 라즈베리파이 장치 컨트롤 관련 함수들
-void handle_led(const char *command);
-void handle_buzzer(const char *command);
-void handle_s_segment(const char *command);
-void handle_photoresistor(const char *command);
+// 단계별 지연/카운터 통계 관련 함수들
+int metrics_init(const MQTTConfig *config, int msg_queue_id);
+void metrics_record(int stage, uint64_t elapsed_ns);
+void metrics_record_device(int slot, uint64_t elapsed_ns);
+void metrics_count(int counter);
+void metrics_add(int counter, uint64_t value);
+int metrics_device_slot(const char *device);
+int metrics_snapshot_json(char *buf, size_t size);
+int metrics_write_prometheus(const char *path);
+void metrics_report(void);
+
+// 비동기 로거 관련 함수들 (log_* 매크로로 호출)
+// 컴파일에서 뺀 레벨도 서식 검사는 하되 호출 코드는 생성하지 않음
+void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int log_start(void);
+void log_stop(void);
+void log_flush(void);
+void log_set_level(int level);
+int log_get_level(void);
+int log_level_from_name(const char *name);
+void log_get_stats(LogStats *stats);
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define log_error(...) log_write(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define log_error(...) ((void)(0 && (log_write(LOG_LEVEL_ERROR, __VA_ARGS__), 0)))
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define log_warn(...) log_write(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define log_warn(...) ((void)(0 && (log_write(LOG_LEVEL_WARN, __VA_ARGS__), 0)))
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define log_info(...) log_write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define log_info(...) ((void)(0 && (log_write(LOG_LEVEL_INFO, __VA_ARGS__), 0)))
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define log_debug(...) log_write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define log_debug(...) ((void)(0 && (log_write(LOG_LEVEL_DEBUG, __VA_ARGS__), 0)))
+#endif
 
 // 유틸리티 함수들
 void print_config(const MQTTConfig *config);
@@ -0,0 +1,406 @@
+#include "../mqtt.h"
+
+// CBOR(RFC 8949) 페이로드 인코딩
+// 모든 CBOR 페이로드는 자기 기술 태그 55799(D9 D9 F7)로 시작하고, 이 표시로 JSON과 구분함
+// 명령 페이로드는 받는 즉시 JSON 텍스트로 바꿔 기존 해석 경로(json_extract, 예약 지시)를 그대로 쓰고,
+// 결과는 ResultBuilder가 처음부터 CBOR로 씀 (result_builder.c)
+
+// 자주 쓰는 결과 필드 이름 → 정수 키 (번호를 바꾸면 수신 측과 어긋나므로 뒤에만 추가)
+// 23번까지는 1바이트, 그 뒤는 2바이트. 표에 없는 이름은 텍스트 키로 보냄
+#define CBOR_KEY(name) { name, sizeof(name) - 1 }
+static const struct {
+    const char *name;
+    size_t len;
+} g_cbor_keys[] = {
+    { NULL, 0 }, CBOR_KEY("device"), CBOR_KEY("command"), CBOR_KEY("status"), CBOR_KEY("timestamp"),
+    CBOR_KEY("value"), CBOR_KEY("message"), CBOR_KEY("error"), CBOR_KEY("id"), CBOR_KEY("pending"),
+    CBOR_KEY("count"), CBOR_KEY("window_ms"), CBOR_KEY("span_ms"), CBOR_KEY("mean"), CBOR_KEY("min"),
+    CBOR_KEY("max"), CBOR_KEY("stddev"), CBOR_KEY("ewma"), CBOR_KEY("p50"), CBOR_KEY("p90"),
+    CBOR_KEY("p99"), CBOR_KEY("last"), CBOR_KEY("samples"), CBOR_KEY("reason"), CBOR_KEY("topic"),
+    CBOR_KEY("sample_ms"), CBOR_KEY("deadband"), CBOR_KEY("heartbeat_ms"), CBOR_KEY("min_publish_ms"),
+    CBOR_KEY("published"), CBOR_KEY("calibrated_value"), CBOR_KEY("source"),
+};
+#define CBOR_KEY_COUNT ((int)(sizeof(g_cbor_keys) / sizeof(g_cbor_keys[0])))
+
+// 필드 이름의 정수 키 (표에 없으면 -1). 길이와 첫 글자로 먼저 거름
+int cbor_key_id(const char *key, size_t len) {
+    for (int i = 1; i < CBOR_KEY_COUNT; i++) {
+        if (g_cbor_keys[i].len == len && g_cbor_keys[i].name[0] == key[0] &&
+            memcmp(g_cbor_keys[i].name, key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 결과를 CBOR로 보낼 토픽 필터 (시작 시 설정, 이후 읽기 전용)
+static struct {
+    char filters[MAX_CBOR_FILTERS][MAX_TOPIC_LEN];
+    int filter_count;
+} g_cbor;
+
+void cbor_configure(const MQTTConfig *config) {
+    g_cbor.filter_count = 0;
+    for (int i = 0; i < config->cbor_topic_count && i < MAX_CBOR_FILTERS; i++) {
+        strcpy(g_cbor.filters[g_cbor.filter_count++], config->cbor_topics[i]);
+    }
+    if (g_cbor.filter_count > 0) {
+        log_info("Publisher: CBOR results on %d topic filter(s)", g_cbor.filter_count);
+    }
+}
+
+int cbor_topic_count(void) {
+    return g_cbor.filter_count;
+}
+
+// 결과를 CBOR로 보낼 토픽인지 확인
+int cbor_wants(const char *topic) {
+    for (int i = 0; i < g_cbor.filter_count; i++) {
+        if (topic_matches_filter(g_cbor.filters[i], topic)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 자기 기술 태그로 시작하는지 확인
+int cbor_is_marked(const void *payload, int len) {
+    return payload && len >= CBOR_MARKER_LEN && memcmp(payload, CBOR_MARKER, CBOR_MARKER_LEN) == 0;
+}
+
+// 항목 머리 (major type + 길이/값) 쓰기. 반환: 쓴 바이트 수 (최대 9)
+size_t cbor_put_head(uint8_t *out, int major, uint64_t value) {
+    uint8_t type = (uint8_t)(major << 5);
+    if (value < 24) {
+        out[0] = type | (uint8_t)value;
+        return 1;
+    }
+    int bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFULL ? 4 : 8;
+    out[0] = type | (uint8_t)(bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27);
+    for (int i = 0; i < bytes; i++) {
+        out[1 + i] = (uint8_t)(value >> (8 * (bytes - 1 - i)));
+    }
+    return (size_t)bytes + 1;
+}
+
+// --- CBOR → JSON 변환 ---
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} CborReader;
+
+typedef struct {
+    char *out;
+    size_t size;
+    size_t len;
+    int overflow;               // 버퍼가 모자라 실패함 (형식 오류와 구분)
+} JsonWriter;
+
+static int jw_put(JsonWriter *w, const char *data, size_t len) {
+    if (w->len + len >= w->size) {
+        w->overflow = 1;
+        return -1;
+    }
+    memcpy(w->out + w->len, data, len);
+    w->len += len;
+    return 0;
+}
+
+static int jw_printf(JsonWriter *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static int jw_printf(JsonWriter *w, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->out + w->len, w->size - w->len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= w->size - w->len) {
+        w->overflow = n >= 0;
+        return -1;
+    }
+    w->len += (size_t)n;
+    return 0;
+}
+
+// 텍스트 조각을 JSON 문자열 안쪽으로 (따옴표/역슬래시/제어문자 이스케이프)
+static int jw_put_escaped(JsonWriter *w, const uint8_t *text, size_t len) {
+    size_t run = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        if (jw_put(w, (const char *)text + run, i - run) != 0) {
+            return -1;
+        }
+        int rc = c == '"' ? jw_put(w, "\\\"", 2) : c == '\\' ? jw_put(w, "\\\\", 2) :
+                 c == '\n' ? jw_put(w, "\\n", 2) : jw_printf(w, "\\u%04x", c);
+        if (rc != 0) {
+            return -1;
+        }
+        run = i + 1;
+    }
+    return jw_put(w, (const char *)text + run, len - run);
+}
+
+// 실수를 다시 읽었을 때 같은 값이 되는 가장 짧은 표기로 (NaN/무한대는 null)
+static int jw_put_double(JsonWriter *w, double value, int single) {
+    if (!isfinite(value)) {
+        return jw_put(w, "null", 4);
+    }
+    char buf[32];
+    for (int precision = single ? 6 : 15; precision <= 17; precision++) {
+        snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        double back = strtod(buf, NULL);
+        if (single ? (float)back == (float)value : back == value) {
+            break;
+        }
+    }
+    return jw_put(w, buf, strlen(buf));
+}
+
+// 머리 읽기. info가 31이면 길이 없음(indefinite)이고 value는 0
+static int cbor_read_head(CborReader *r, int *major, int *info, uint64_t *value) {
+    if (r->p >= r->end) {
+        return -1;
+    }
+    uint8_t b = *r->p++;
+    *major = b >> 5;
+    *info = b & 31;
+    *value = 0;
+    if (*info < 24) {
+        *value = (uint64_t)*info;
+        return 0;
+    }
+    if (*info == 31) {
+        return 0;
+    }
+    if (*info > 27) {
+        return -1;
+    }
+    int bytes = 1 << (*info - 24);
+    if (r->end - r->p < bytes) {
+        return -1;
+    }
+    for (int i = 0; i < bytes; i++) {
+        *value = (*value << 8) | *r->p++;
+    }
+    return 0;
+}
+
+static int cbor_is_break(const CborReader *r) {
+    return r->p < r->end && *r->p == 0xFF;
+}
+
+// 문자열 본문 (major 2면 16진수, 3이면 텍스트). 길이 없는 문자열은 같은 종류 조각의 연속
+static int cbor_string_to_json(CborReader *r, JsonWriter *w, int major, int info, uint64_t len) {
+    if (info == 31) {
+        while (!cbor_is_break(r)) {
+            int chunk_major;
+            int chunk_info;
+            uint64_t chunk_len;
+            if (cbor_read_head(r, &chunk_major, &chunk_info, &chunk_len) != 0 || chunk_major != major ||
+                chunk_info == 31 || cbor_string_to_json(r, w, major, chunk_info, chunk_len) != 0) {
+                return -1;
+            }
+        }
+        r->p++;
+        return 0;
+    }
+    if ((uint64_t)(r->end - r->p) < len) {
+        return -1;
+    }
+    const uint8_t *data = r->p;
+    r->p += len;
+    if (major == 3) {
+        return jw_put_escaped(w, data, (size_t)len);
+    }
+    for (uint64_t i = 0; i < len; i++) {
+        if (jw_printf(w, "%02x", data[i]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int cbor_item_to_json(CborReader *r, JsonWriter *w, int depth);
+
+// 맵 키 (텍스트면 그대로, 표에 있는 정수 키는 필드 이름으로, 그 밖의 값은 JSON 표기를 문자열로 감쌈)
+static int cbor_key_to_json(CborReader *r, JsonWriter *w, int depth) {
+    if (r->p < r->end && (*r->p >> 5) == 3) {
+        return cbor_item_to_json(r, w, depth);
+    }
+    if (r->p < r->end && (*r->p >> 5) == 0) {
+        CborReader peek = *r;
+        int major;
+        int info;
+        uint64_t id;
+        if (cbor_read_head(&peek, &major, &info, &id) == 0 && id > 0 && id < (uint64_t)CBOR_KEY_COUNT) {
+            *r = peek;
+            return jw_put(w, "\"", 1) || jw_put(w, g_cbor_keys[id].name, g_cbor_keys[id].len) || jw_put(w, "\"", 1) ? -1 : 0;
+        }
+    }
+    if (jw_put(w, "\"", 1) != 0) {
+        return -1;
+    }
+    size_t start = w->len;
+    if (cbor_item_to_json(r, w, depth) != 0) {
+        return -1;
+    }
+    // 키 안의 따옴표는 JSON 문자열을 깨므로 허용하지 않음 (문자열/컨테이너 키)
+    if (memchr(w->out + start, '"', w->len - start) != NULL) {
+        return -1;
+    }
+    return jw_put(w, "\"", 1);
+}
+
+// 배열(major 4)/맵(major 5) 본문
+static int cbor_container_to_json(CborReader *r, JsonWriter *w, int major, int info, uint64_t count, int depth) {
+    int is_map = major == 5;
+    if (jw_put(w, is_map ? "{" : "[", 1) != 0) {
+        return -1;
+    }
+    for (uint64_t i = 0; info == 31 ? !cbor_is_break(r) : i < count; i++) {
+        if (r->p >= r->end || (i > 0 && jw_put(w, ",", 1) != 0)) {
+            return -1;
+        }
+        if (is_map) {
+            if (cbor_key_to_json(r, w, depth + 1) != 0 || jw_put(w, ":", 1) != 0) {
+                return -1;
+            }
+        }
+        if (cbor_item_to_json(r, w, depth + 1) != 0) {
+            return -1;
+        }
+    }
+    if (info == 31) {
+        r->p++;
+    }
+    return jw_put(w, is_map ? "}" : "]", 1);
+}
+
+// 반정밀도(16비트) 실수 값
+static double cbor_half_to_double(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent == 31) {
+        value = mantissa == 0 ? INFINITY : NAN;
+    } else {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+static int cbor_item_to_json(CborReader *r, JsonWriter *w, int depth) {
+    if (depth > CBOR_MAX_DEPTH) {
+        return -1;
+    }
+    int major;
+    int info;
+    uint64_t value;
+    if (cbor_read_head(r, &major, &info, &value) != 0) {
+        return -1;
+    }
+    if (info == 31 && (major == 0 || major == 1 || major == 6)) {
+        return -1;
+    }
+
+    switch (major) {
+    case 0:
+        return jw_printf(w, "%llu", (unsigned long long)value);
+    case 1:
+        // -1 - value (value가 최댓값이면 2^64)
+        if (value == UINT64_MAX) {
+            return jw_put(w, "-18446744073709551616", 21);
+        }
+        return jw_printf(w, "-%llu", (unsigned long long)value + 1);
+    case 2:
+    case 3:
+        if (jw_put(w, "\"", 1) != 0 || cbor_string_to_json(r, w, major, info, value) != 0) {
+            return -1;
+        }
+        return jw_put(w, "\"", 1);
+    case 4:
+    case 5:
+        return cbor_container_to_json(r, w, major, info, value, depth);
+    case 6:
+        // 태그는 버리고 내용만 (자기 기술 태그, 날짜 태그 등)
+        return cbor_item_to_json(r, w, depth + 1);
+    default:
+        break;
+    }
+
+    // major 7: 단순 값과 실수
+    switch (info) {
+    case 20:
+        return jw_put(w, "false", 5);
+    case 21:
+        return jw_put(w, "true", 4);
+    case 22:
+    case 23:
+        return jw_put(w, "null", 4);
+    case 25:
+        return jw_put_double(w, cbor_half_to_double((uint16_t)value), 1);
+    case 26: {
+        uint32_t bits = (uint32_t)value;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return jw_put_double(w, f, 1);
+    }
+    case 27: {
+        double d;
+        memcpy(&d, &value, sizeof(d));
+        return jw_put_double(w, d, 0);
+    }
+    default:
+        return -1;
+    }
+}
+
+// CBOR 페이로드 하나를 JSON 텍스트로 변환 (널 종료)
+// 반환: JSON 길이, 형식 오류/남는 바이트면 CBOR_INVALID, 버퍼 부족이면 CBOR_TOO_LARGE
+int cbor_to_json(const void *payload, int len, char *out, size_t size) {
+    if (!payload || len <= 0 || size == 0) {
+        return CBOR_INVALID;
+    }
+    CborReader reader = { payload, (const uint8_t *)payload + len };
+    JsonWriter writer = { out, size, 0, 0 };
+    if (cbor_item_to_json(&reader, &writer, 0) != 0 || reader.p != reader.end) {
+        out[0] = '\0';
+        return writer.overflow ? CBOR_TOO_LARGE : CBOR_INVALID;
+    }
+    out[writer.len] = '\0';
+    return (int)writer.len;
+}
+
+// cbor_to_json을 malloc 버퍼로 (모자라면 두 배씩 늘려 MAX_PAYLOAD_SIZE까지 다시 변환)
+// 정수 키 하나(1바이트)가 긴 필드 이름이 되기도 하므로 입력 길이로 크기를 정해 둘 수 없음
+// 반환: JSON 길이 (*out은 호출자가 해제), 실패면 CBOR_INVALID / CBOR_TOO_LARGE
+int cbor_to_json_alloc(const void *payload, int len, char **out) {
+    *out = NULL;
+    if (len <= 0) {
+        return CBOR_INVALID;
+    }
+    size_t size = (size_t)len * 4 + 64;
+    while (1) {
+        if (size > MAX_PAYLOAD_SIZE + 1) {
+            size = MAX_PAYLOAD_SIZE + 1;
+        }
+        char *buf = malloc(size);
+        if (!buf) {
+            return CBOR_TOO_LARGE;
+        }
+        int json_len = cbor_to_json(payload, len, buf, size);
+        if (json_len >= 0) {
+            *out = buf;
+            return json_len;
+        }
+        free(buf);
+        if (json_len != CBOR_TOO_LARGE || size > MAX_PAYLOAD_SIZE) {
+            return json_len;
+        }
+        size *= 2;
+    }
+}
@@ -0,0 +1,223 @@
+#include "../mqtt.h"
+#include <zlib.h>
+
+// 페이로드 압축 (gzip = deflate + 10바이트 헤더/8바이트 꼬리)
+// 압축 페이로드는 gzip 헤더(1F 8B 08)로 시작하므로 JSON 텍스트나 CBOR 표시와 겹치지 않음
+// 발행은 compress_topic 필터에 맞고 문턱값 이상인 결과만 압축하고 (배치는 묶은 뒤에 압축),
+// 수신은 표시만 보고 어느 토픽이든 풀어서 기존 해석 경로로 넘김
+// deflate 상태는 약 256KB라 호출마다 만들지 않고 스레드마다 하나를 재설정해 쓰고, 스레드가 끝나면 해제
+
+// 압축할 토픽 필터 (시작 시 설정, 이후 읽기 전용)
+static struct {
+    char filters[MAX_COMPRESS_FILTERS][MAX_TOPIC_LEN];
+    int filter_count;
+    int min_bytes;
+    int level;
+} g_compress = {
+    .min_bytes = COMPRESS_DEFAULT_MIN_BYTES,
+    .level = COMPRESS_DEFAULT_LEVEL,
+};
+
+// 스레드별 deflate/inflate 상태 (처음 쓸 때 만들고, 스레드 종료 시 키 소멸자가 해제)
+typedef struct {
+    z_stream deflate;
+    int deflate_level;          // 0이면 아직 만들지 않음
+    z_stream inflate;
+    int inflate_ready;
+} CompressState;
+
+static pthread_once_t g_state_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_state_key;
+static int g_state_key_ready = 0;
+static __thread CompressState *t_state = NULL;
+
+static void release_state(void *arg) {
+    CompressState *state = arg;
+    if (state->deflate_level) {
+        deflateEnd(&state->deflate);
+    }
+    if (state->inflate_ready) {
+        inflateEnd(&state->inflate);
+    }
+    free(state);
+}
+
+static void create_state_key(void) {
+    g_state_key_ready = pthread_key_create(&g_state_key, release_state) == 0;
+}
+
+// 현재 스레드의 상태 (처음 쓸 때 만들어 키에 등록, 실패하면 NULL)
+static CompressState *thread_state(void) {
+    if (t_state) {
+        return t_state;
+    }
+    pthread_once(&g_state_once, create_state_key);
+    if (!g_state_key_ready) {
+        return NULL;
+    }
+    CompressState *state = calloc(1, sizeof(CompressState));
+    if (!state) {
+        return NULL;
+    }
+    if (pthread_setspecific(g_state_key, state) != 0) {
+        free(state);
+        return NULL;
+    }
+    t_state = state;
+    return state;
+}
+
+void compress_configure(const MQTTConfig *config) {
+    g_compress.filter_count = 0;
+    for (int i = 0; i < config->compress_topic_count && i < MAX_COMPRESS_FILTERS; i++) {
+        strcpy(g_compress.filters[g_compress.filter_count++], config->compress_topics[i]);
+    }
+    g_compress.min_bytes = config->compress_min_bytes > 0 ? config->compress_min_bytes : 0;
+    g_compress.level = config->compress_level >= 1 && config->compress_level <= 9 ?
+                       config->compress_level : COMPRESS_DEFAULT_LEVEL;
+    if (g_compress.filter_count > 0) {
+        log_info("Publisher: gzip results on %d topic filter(s), %d bytes and up, level %d",
+                 g_compress.filter_count, g_compress.min_bytes, g_compress.level);
+    }
+}
+
+// 결과를 압축할 토픽인지 확인
+int compress_wants(const char *topic) {
+    for (int i = 0; i < g_compress.filter_count; i++) {
+        if (topic_matches_filter(g_compress.filters[i], topic)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// gzip 헤더로 시작하는지 확인
+int compress_is_marked(const void *payload, int len) {
+    return payload && len >= COMPRESS_MARKER_LEN && memcmp(payload, COMPRESS_MARKER, COMPRESS_MARKER_LEN) == 0;
+}
+
+// payload를 gzip으로 압축 (반환: 압축 길이, 문턱값 미만이거나 줄지 않으면 0, 실패 -1)
+// 압축했으면 *out은 malloc 버퍼이고 호출자가 해제
+int compress_payload(const char *payload, int len, char **out) {
+    *out = NULL;
+    if (!payload || len <= 0 || len < g_compress.min_bytes) {
+        return 0;
+    }
+    CompressState *state = thread_state();
+    if (!state) {
+        return -1;
+    }
+    z_stream *zs = &state->deflate;
+    if (state->deflate_level != g_compress.level) {
+        if (state->deflate_level) {
+            deflateEnd(zs);
+            state->deflate_level = 0;
+        }
+        memset(zs, 0, sizeof(*zs));
+        // windowBits 15 + 16: zlib 대신 gzip 헤더/꼬리
+        if (deflateInit2(zs, g_compress.level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            log_error("Compress: deflateInit2 failed");
+            return -1;
+        }
+        state->deflate_level = g_compress.level;
+    } else {
+        deflateReset(zs);
+    }
+
+    // 원본보다 작아야만 보내므로 출력 버퍼는 원본 크기까지만
+    char *buf = malloc((size_t)len);
+    if (!buf) {
+        return -1;
+    }
+    uint64_t start_ns = monotonic_time_ns();
+    zs->next_in = (Bytef *)payload;
+    zs->avail_in = (uInt)len;
+    zs->next_out = (Bytef *)buf;
+    zs->avail_out = (uInt)len;
+    int rc = deflate(zs, Z_FINISH);
+    metrics_record(METRIC_STAGE_COMPRESS, monotonic_time_ns() - start_ns);
+    if (rc != Z_STREAM_END || zs->avail_out == 0) {
+        free(buf);
+        metrics_count(METRIC_COMPRESS_SKIPPED);
+        return 0;
+    }
+
+    int out_len = len - (int)zs->avail_out;
+    metrics_count(METRIC_PAYLOADS_COMPRESSED);
+    metrics_add(METRIC_COMPRESS_BYTES_IN, (uint64_t)len);
+    metrics_add(METRIC_COMPRESS_BYTES_OUT, (uint64_t)out_len);
+    *out = buf;
+    return out_len;
+}
+
+// gzip 페이로드 풀기 (반환: 원본 길이, 형식 오류이거나 MAX_PAYLOAD_SIZE를 넘으면 -1)
+// *out은 널 종료된 malloc 버퍼이고 호출자가 해제
+int compress_inflate(const void *payload, int len, char **out) {
+    *out = NULL;
+    if (!compress_is_marked(payload, len) || len < 18) {
+        metrics_count(METRIC_INFLATE_INVALID);
+        return -1;
+    }
+    CompressState *state = thread_state();
+    if (!state) {
+        return -1;
+    }
+    z_stream *zs = &state->inflate;
+    if (!state->inflate_ready) {
+        memset(zs, 0, sizeof(*zs));
+        if (inflateInit2(zs, 15 + 16) != Z_OK) {
+            log_error("Compress: inflateInit2 failed");
+            return -1;
+        }
+        state->inflate_ready = 1;
+    } else {
+        inflateReset(zs);
+    }
+
+    // 꼬리의 ISIZE(원본 길이 mod 2^32)로 처음 크기를 잡음 (보낸 쪽 값이므로 상한으로 자르고 모자라면 늘림)
+    const uint8_t *tail = (const uint8_t *)payload + len - 4;
+    uint32_t isize = (uint32_t)tail[0] | (uint32_t)tail[1] << 8 | (uint32_t)tail[2] << 16 | (uint32_t)tail[3] << 24;
+    size_t size = (isize < 64 ? 64 : isize < MAX_PAYLOAD_SIZE ? isize : MAX_PAYLOAD_SIZE) + 1;
+    char *buf = malloc(size);
+    if (!buf) {
+        return -1;
+    }
+
+    uint64_t start_ns = monotonic_time_ns();
+    zs->next_in = (Bytef *)payload;
+    zs->avail_in = (uInt)len;
+    zs->next_out = (Bytef *)buf;
+    zs->avail_out = (uInt)(size - 1);
+    int rc;
+    while ((rc = inflate(zs, Z_NO_FLUSH)) == Z_OK) {
+        if (zs->avail_out > 0) {
+            continue;
+        }
+        size_t used = size - 1;
+        if (used >= MAX_PAYLOAD_SIZE) {
+            break;
+        }
+        size_t grown = used * 2 < MAX_PAYLOAD_SIZE ? used * 2 : MAX_PAYLOAD_SIZE;
+        char *bigger = realloc(buf, grown + 1);
+        if (!bigger) {
+            break;
+        }
+        buf = bigger;
+        size = grown + 1;
+        zs->next_out = (Bytef *)buf + used;
+        zs->avail_out = (uInt)(grown - used);
+    }
+    metrics_record(METRIC_STAGE_DECOMPRESS, monotonic_time_ns() - start_ns);
+
+    // 스트림 끝까지 정확히 풀려야 성공 (뒤에 남은 바이트나 잘린 입력은 오류)
+    if (rc != Z_STREAM_END || zs->avail_in != 0) {
+        free(buf);
+        metrics_count(METRIC_INFLATE_INVALID);
+        return -1;
+    }
+    int out_len = (int)zs->total_out;
+    buf[out_len] = '\0';
+    metrics_count(METRIC_PAYLOADS_INFLATED);
+    *out = buf;
+    return out_len;
+}
@@ -0,0 +1,371 @@
+#include "../mqtt.h"
+
+// 스트리밍 JSON 필드 추출기
+// 페이로드를 복사하거나 DOM을 만들지 않고 최상위 객체만 한 번 훑어서
+// 요청한 키의 값 위치를 돌려줌. 요청한 키를 모두 찾으면 나머지는 보지 않음
+
+static const char *skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+// 문자열 끝 찾기 (p는 여는 따옴표), 닫는 따옴표 다음 위치 반환 (잘못되면 NULL)
+static const char *scan_string(const char *p, const char *end, int *escaped) {
+    *escaped = 0;
+    for (p++; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"') {
+            return p + 1;
+        }
+        if (c == '\\') {
+            *escaped = 1;
+            if (++p >= end) {
+                return NULL;
+            }
+            if (*p == 'u') {
+                if (end - p < 5) {
+                    return NULL;
+                }
+                for (int i = 1; i <= 4; i++) {
+                    if (!isxdigit((unsigned char)p[i])) {
+                        return NULL;
+                    }
+                }
+                p += 4;
+            } else if (!strchr("\"\\/bfnrt", *p)) {
+                return NULL;
+            }
+        } else if (c < 0x20) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static const char *scan_number(const char *p, const char *end) {
+    const char *start = p;
+    int digits = 0;
+    if (p < end && *p == '-') {
+        p++;
+    }
+    while (p < end && (isdigit((unsigned char)*p) || *p == '.' || *p == 'e' || *p == 'E' ||
+                       *p == '+' || *p == '-')) {
+        digits += isdigit((unsigned char)*p) != 0;
+        p++;
+    }
+    return digits > 0 && p > start ? p : NULL;
+}
+
+static const char *scan_literal(const char *p, const char *end, const char *literal) {
+    size_t len = strlen(literal);
+    if ((size_t)(end - p) < len || memcmp(p, literal, len) != 0) {
+        return NULL;
+    }
+    return p + len;
+}
+
+// 객체/배열 건너뛰기 (괄호 짝을 비트 스택으로 확인, 너무 깊으면 *too_deep 설정)
+static const char *skip_container(const char *p, const char *end, int *too_deep) {
+    uint64_t stack = 0;     // 비트 1 = 객체, 0 = 배열
+    int depth = 0;
+
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            int escaped;
+            p = scan_string(p, end, &escaped);
+            if (!p) {
+                return NULL;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            if (depth >= JSON_EXTRACT_MAX_DEPTH) {
+                *too_deep = 1;
+                return NULL;
+            }
+            stack = (stack << 1) | (c == '{');
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || (int)(stack & 1) != (c == '}')) {
+                return NULL;
+            }
+            stack >>= 1;
+            if (--depth == 0) {
+                return p + 1;
+            }
+        }
+        p++;
+    }
+    return NULL;
+}
+
+// 값 하나 건너뛰고 종류 반환
+static const char *skip_value(const char *p, const char *end, int *type, int *escaped, int *too_deep) {
+    *escaped = 0;
+    if (p >= end) {
+        return NULL;
+    }
+    switch (*p) {
+    case '"':
+        *type = JSON_FIELD_STRING;
+        return scan_string(p, end, escaped);
+    case '{':
+        *type = JSON_FIELD_OBJECT;
+        return skip_container(p, end, too_deep);
+    case '[':
+        *type = JSON_FIELD_ARRAY;
+        return skip_container(p, end, too_deep);
+    case 't':
+        *type = JSON_FIELD_BOOL;
+        return scan_literal(p, end, "true");
+    case 'f':
+        *type = JSON_FIELD_BOOL;
+        return scan_literal(p, end, "false");
+    case 'n':
+        *type = JSON_FIELD_NULL;
+        return scan_literal(p, end, "null");
+    default:
+        *type = JSON_FIELD_NUMBER;
+        return scan_number(p, end);
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+// 코드 포인트를 UTF-8로 기록 (공간이 없으면 0)
+static size_t put_utf8(unsigned long cp, char *out, size_t room) {
+    if (cp < 0x80 && room >= 1) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800 && room >= 2) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000 && cp >= 0x800 && room >= 3) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    if (cp >= 0x10000 && room >= 4) {
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        return 4;
+    }
+    return 0;
+}
+
+// 이스케이프를 풀어 널 종료 문자열로 복사 (scan_string을 통과한 원문 기준, 반환: 길이)
+static size_t json_unescape(const char *raw, size_t raw_len, char *out, size_t size) {
+    const char *p = raw;
+    const char *end = raw + raw_len;
+    size_t len = 0;
+
+    if (size == 0) {
+        return 0;
+    }
+    while (p < end && len < size - 1) {
+        if (*p != '\\') {
+            out[len++] = *p++;
+            continue;
+        }
+        p++;
+        char c = *p++;
+        char plain = 0;
+        switch (c) {
+        case 'b': plain = '\b'; break;
+        case 'f': plain = '\f'; break;
+        case 'n': plain = '\n'; break;
+        case 'r': plain = '\r'; break;
+        case 't': plain = '\t'; break;
+        case 'u': {
+            unsigned long cp = 0;
+            for (int i = 0; i < 4; i++) {
+                cp = (cp << 4) | (unsigned long)hex_value(p[i]);
+            }
+            p += 4;
+            // 서로게이트 쌍 결합
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                unsigned long low = 0;
+                for (int i = 0; i < 4; i++) {
+                    low = (low << 4) | (unsigned long)hex_value(p[2 + i]);
+                }
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+            }
+            size_t n = put_utf8(cp, out + len, size - 1 - len);
+            if (n == 0) {
+                out[len] = '\0';
+                return len;
+            }
+            len += n;
+            continue;
+        }
+        default: plain = c; break;     // \" \\ \/
+        }
+        out[len++] = plain;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static int key_matches(const char *raw, size_t raw_len, int escaped, const char *key) {
+    if (!escaped) {
+        return strlen(key) == raw_len && memcmp(raw, key, raw_len) == 0;
+    }
+    char decoded[64];
+    size_t len = json_unescape(raw, raw_len, decoded, sizeof(decoded));
+    return len < sizeof(decoded) - 1 && strcmp(decoded, key) == 0;
+}
+
+// 최상위 객체에서 요청한 키들의 값 위치 찾기
+// 반환: 찾은 키 수, 객체가 아닌 올바른 JSON 값이면 0, JSON이 아니면 JSON_EXTRACT_INVALID,
+//       중첩이 JSON_EXTRACT_MAX_DEPTH를 넘으면 JSON_EXTRACT_COMPLEX (호출자가 cJSON으로 처리)
+// 키가 여러 번 나오면 처음 것을 사용 (cJSON_GetObjectItem과 같음)
+int json_extract_fields(const char *json, int json_len, JsonField *fields, int field_count) {
+    const char *p;
+    const char *end;
+    int found = 0;
+    int too_deep = 0;
+
+    for (int i = 0; i < field_count; i++) {
+        fields[i].value = NULL;
+        fields[i].value_len = 0;
+        fields[i].type = JSON_FIELD_NONE;
+        fields[i].escaped = 0;
+    }
+    if (!json || json_len <= 0) {
+        return JSON_EXTRACT_INVALID;
+    }
+    end = json + json_len;
+    p = skip_ws(json, end);
+
+    if (p < end && *p != '{') {
+        // 최상위가 객체가 아닌 값 (숫자, 문자열, 배열 등): 값 전체가 올바른지만 확인
+        int type;
+        int escaped;
+        const char *next = skip_value(p, end, &type, &escaped, &too_deep);
+        if (!next) {
+            return too_deep ? JSON_EXTRACT_COMPLEX : JSON_EXTRACT_INVALID;
+        }
+        return skip_ws(next, end) == end ? 0 : JSON_EXTRACT_INVALID;
+    }
+    if (p >= end) {
+        return JSON_EXTRACT_INVALID;
+    }
+
+    p = skip_ws(p + 1, end);
+    if (p < end && *p == '}') {
+        return 0;
+    }
+    while (p < end) {
+        int key_escaped;
+        const char *key = p;
+        if (*p != '"' || !(p = scan_string(p, end, &key_escaped))) {
+            return JSON_EXTRACT_INVALID;
+        }
+        size_t key_len = (size_t)(p - key) - 2;
+
+        p = skip_ws(p, end);
+        if (p >= end || *p != ':') {
+            return JSON_EXTRACT_INVALID;
+        }
+        p = skip_ws(p + 1, end);
+
+        int type;
+        int value_escaped;
+        const char *value = p;
+        if (!(p = skip_value(p, end, &type, &value_escaped, &too_deep))) {
+            return too_deep ? JSON_EXTRACT_COMPLEX : JSON_EXTRACT_INVALID;
+        }
+
+        for (int i = 0; i < field_count; i++) {
+            if (fields[i].type == JSON_FIELD_NONE && key_matches(key + 1, key_len, key_escaped, fields[i].key)) {
+                fields[i].type = type;
+                fields[i].escaped = value_escaped;
+                if (type == JSON_FIELD_STRING) {
+                    fields[i].value = value + 1;
+                    fields[i].value_len = (int)(p - value) - 2;
+                } else {
+                    fields[i].value = value;
+                    fields[i].value_len = (int)(p - value);
+                }
+                // 요청한 키를 모두 찾으면 나머지는 보지 않음
+                if (++found == field_count) {
+                    return found;
+                }
+                break;
+            }
+        }
+
+        p = skip_ws(p, end);
+        if (p < end && *p == ',') {
+            p = skip_ws(p + 1, end);
+            continue;
+        }
+        if (p < end && *p == '}') {
+            return found;
+        }
+        return JSON_EXTRACT_INVALID;
+    }
+    return JSON_EXTRACT_INVALID;
+}
+
+// 필드 값을 널 종료 문자열로 복사 (문자열은 이스케이프를 풀고, 나머지는 원문 그대로)
+size_t json_field_copy(const JsonField *field, char *buf, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    if (field->type == JSON_FIELD_NONE) {
+        buf[0] = '\0';
+        return 0;
+    }
+    if (field->type == JSON_FIELD_STRING && field->escaped) {
+        return json_unescape(field->value, (size_t)field->value_len, buf, size);
+    }
+    size_t len = (size_t)field->value_len < size - 1 ? (size_t)field->value_len : size - 1;
+    memcpy(buf, field->value, len);
+    buf[len] = '\0';
+    return len;
+}
+
+// 숫자 필드 값 (숫자가 아니면 -1)
+int json_field_number(const JsonField *field, double *out) {
+    char digits[64];
+    if (field->type != JSON_FIELD_NUMBER || field->value_len >= (int)sizeof(digits)) {
+        return -1;
+    }
+    memcpy(digits, field->value, field->value_len);
+    digits[field->value_len] = '\0';
+    *out = strtod(digits, NULL);
+    return 0;
+}
+
+// 숫자 필드를 int로 (cJSON의 valueint처럼 범위를 넘으면 포화)
+int json_field_int(const JsonField *field, int *out) {
+    double number;
+    if (json_field_number(field, &number) != 0) {
+        return -1;
+    }
+    if (number >= INT_MAX) {
+        *out = INT_MAX;
+    } else if (number <= (double)INT_MIN) {
+        *out = INT_MIN;
+    } else {
+        *out = (int)number;
+    }
+    return 0;
+}
@@ -2,25 +2,437 @@
 
 static MQTTClient g_pub_client = NULL;
 
+// 전송 후 PUBACK을 기다리는 메시지
+typedef struct {
+    MQTTClient_deliveryToken token;
+    uint64_t sent_ns;
+    int in_use;
+} InflightSlot;
+
+// 발행 파이프라인: 핸들러는 대기열에 넣고 바로 반환, 전용 스레드가 윈도우 범위 안에서 전송
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;            // 대기열/윈도우 상태 변화 알림
+    PublishItem **queue;
+    int queue_size;
+    int queue_head;
+    int queue_count;
+    PublishItem *retry;             // 일시 실패로 되돌린 항목 (대기열 맨 앞보다 먼저 보냄)
+    uint64_t retry_at_ns;
+    InflightSlot *inflight;
+    int max_inflight;
+    int inflight_count;
+    MQTTClient_deliveryToken early_acks[PUBLISH_EARLY_ACKS];  // 슬롯 등록 전에 도착한 PUBACK
+    int early_ack_next;
+    int started;
+    int stopping;
+    PublishStats stats;
+} g_pipeline = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
 void set_pub_client(MQTTClient client) {
     g_pub_client = client;
 }
 
-// 토픽으로 결과 메시지 발행
-void send_result_to_topic(const char *topic, const char *value) {
-    if (!g_pub_client || !topic || !value) return;
+// 발행 호출 한 번 (compress_topic에 맞는 토픽이면 문턱값 이상인 페이로드를 gzip으로 바꿔 보냄)
+// 배치 결과도 묶은 뒤 여기서 압축하므로 비슷한 결과가 모인 큰 페이로드일수록 잘 줄어듦
+// 실패 로그는 재시도 여부를 아는 호출자가 남김
+static int publish_payload(const char *topic, const char *payload, int payload_len,
+                           MQTTClient_deliveryToken *token) {
+    char *compressed = NULL;
+    int compressed_len = compress_wants(topic) ? compress_payload(payload, payload_len, &compressed) : 0;
+
     MQTTClient_message pubmsg = MQTTClient_message_initializer;
-    pubmsg.payload = (void *)value;
-    pubmsg.payloadlen = (int)strlen(value);
+    pubmsg.payload = compressed_len > 0 ? compressed : (void *)payload;
+    pubmsg.payloadlen = compressed_len > 0 ? compressed_len : payload_len;
     pubmsg.qos = 1;
     pubmsg.retained = 0;
+    int rc = MQTTClient_publishMessage(g_pub_client, topic, &pubmsg, token);
+    if (rc == MQTTCLIENT_SUCCESS) {
+        if (compressed_len > 0) {
+            log_debug("Publisher: Sent %d byte result as %d byte gzip to topic '%s'", payload_len, compressed_len, topic);
+        } else if (cbor_is_marked(payload, payload_len)) {
+            log_debug("Publisher: Sent %d byte CBOR result to topic '%s'", payload_len, topic);
+        } else {
+            log_debug("Publisher: Sent result '%s' to topic '%s'", payload, topic);
+        }
+    }
+    free(compressed);
+    return rc;
+}
+
+// 토픽으로 결과 메시지 즉시 발행 (파이프라인 미사용 시)
+static void publish_now(const char *topic, const char *value, int value_len) {
     MQTTClient_deliveryToken token;
-    int rc = MQTTClient_publishMessage(g_pub_client, topic, &pubmsg, &token);
+    int rc = publish_payload(topic, value, value_len, &token);
     if (rc != MQTTCLIENT_SUCCESS) {
-        printf("Publisher: Failed to publish result to topic '%s', return code %d\n", topic, rc);
-    } else {
-        printf("Publisher: Sent result '%s' to topic '%s'\n", value, topic);
+        log_error("Publisher: Failed to publish result to topic '%s', return code %d", topic, rc);
+    }
+}
+
+// 토픽으로 JSON 결과 메시지 발행
+void send_result_to_topic(const char *topic, const char *value) {
+    if (!value) return;
+    send_result_payload(topic, value, (int)strlen(value));
+}
+
+// 토픽으로 결과 메시지 발행 (파이프라인 사용 시 대기열에 넣고 즉시 반환)
+// payload는 payload_len 바이트 (CBOR는 중간에 0 바이트가 있을 수 있음)
+void send_result_payload(const char *topic, const char *payload, int payload_len) {
+    if (!g_pub_client || !topic || !payload || payload_len < 0) return;
+
+    pthread_mutex_lock(&g_pipeline.lock);
+    if (!g_pipeline.started) {
+        pthread_mutex_unlock(&g_pipeline.lock);
+        publish_now(topic, payload, payload_len);
+        return;
+    }
+    if (g_pipeline.stopping || g_pipeline.queue_count >= g_pipeline.queue_size) {
+        g_pipeline.stats.dropped++;
+        pthread_mutex_unlock(&g_pipeline.lock);
+        log_warn("Publisher: Publish queue full, result for topic '%s' dropped", topic);
+        return;
+    }
+    pthread_mutex_unlock(&g_pipeline.lock);
+
+    // 복사는 락 밖에서 수행
+    size_t topic_len = strlen(topic);
+    PublishItem *item = malloc(sizeof(PublishItem) + topic_len + 1 + (size_t)payload_len + 1);
+    if (!item) {
+        return;
+    }
+    memcpy(item->topic, topic, topic_len + 1);
+    item->payload = item->topic + topic_len + 1;
+    memcpy(item->payload, payload, (size_t)payload_len);
+    item->payload[payload_len] = '\0';
+    item->payload_len = payload_len;
+    item->enqueue_ns = monotonic_time_ns();
+
+    pthread_mutex_lock(&g_pipeline.lock);
+    if (g_pipeline.queue_count >= g_pipeline.queue_size) {
+        g_pipeline.stats.dropped++;
+        pthread_mutex_unlock(&g_pipeline.lock);
+        free(item);
+        return;
+    }
+    int tail = (g_pipeline.queue_head + g_pipeline.queue_count) % g_pipeline.queue_size;
+    g_pipeline.queue[tail] = item;
+    g_pipeline.queue_count++;
+    g_pipeline.stats.enqueued++;
+    pthread_cond_broadcast(&g_pipeline.cond);
+    pthread_mutex_unlock(&g_pipeline.lock);
+}
+
+// 응답이 너무 늦은 in-flight 메시지 정리 (재연결 등으로 PUBACK이 오지 않는 경우)
+static void expire_inflight_locked(uint64_t now) {
+    for (int i = 0; i < g_pipeline.max_inflight; i++) {
+        InflightSlot *slot = &g_pipeline.inflight[i];
+        if (slot->in_use && now - slot->sent_ns > PUBLISH_INFLIGHT_TIMEOUT_NS) {
+            slot->in_use = 0;
+            g_pipeline.inflight_count--;
+            g_pipeline.stats.expired++;
+        }
+    }
+}
+
+// 절대 시각(CLOCK_MONOTONIC ns)을 조건변수 대기용 CLOCK_REALTIME 시각으로 변환
+static struct timespec realtime_deadline(uint64_t monotonic_deadline) {
+    uint64_t now = monotonic_time_ns();
+    uint64_t wait_ns = monotonic_deadline > now ? monotonic_deadline - now : 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += wait_ns / 1000000000ULL;
+    ts.tv_nsec += wait_ns % 1000000000ULL;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// 다음에 보낼 항목 선택 (락 보유 상태). 종료할 때가 되면 NULL
+// 배치 대상 결과는 배치 단계에 넣고, 플러시된 배치가 나오면 그것을 보냄
+static PublishItem *next_publish_item(void) {
+    while (1) {
+        uint64_t now = monotonic_time_ns();
+        int window_open = g_pipeline.inflight_count < g_pipeline.max_inflight;
+
+        if (window_open && g_pipeline.retry) {
+            // 되돌린 항목이 있으면 순서를 지키기 위해 그것부터 (재시도 시각까지는 대기)
+            if (now >= g_pipeline.retry_at_ns) {
+                PublishItem *retry = g_pipeline.retry;
+                g_pipeline.retry = NULL;
+                return retry;
+            }
+            struct timespec deadline = realtime_deadline(g_pipeline.retry_at_ns);
+            pthread_cond_timedwait(&g_pipeline.cond, &g_pipeline.lock, &deadline);
+            continue;
+        }
+        if (window_open) {
+            PublishItem *ready = batcher_take_expired(now);
+            if (ready) {
+                return ready;
+            }
+            if (g_pipeline.queue_count > 0) {
+                PublishItem *item = g_pipeline.queue[g_pipeline.queue_head];
+                g_pipeline.queue_head = (g_pipeline.queue_head + 1) % g_pipeline.queue_size;
+                g_pipeline.queue_count--;
+                // 배치는 JSON 배열로 묶으므로 CBOR 결과는 그대로 보냄
+                if (!batcher_wants(item->topic) || cbor_is_marked(item->payload, item->payload_len)) {
+                    return item;
+                }
+                ready = batcher_append(item, now);
+                if (ready) {
+                    return ready;
+                }
+                continue;
+            }
+            if (g_pipeline.stopping) {
+                // 대기열이 비었으면 남은 배치를 모두 내보낸 뒤 종료
+                return batcher_take_any();
+            }
+        } else if (g_pipeline.stopping) {
+            // 종료 중 윈도우가 가득 찬 경우: 남은 항목은 stop에서 폐기
+            return NULL;
+        }
+
+        if (!window_open) {
+            // 윈도우가 가득 차면 완료 콜백 또는 만료 검사 시점까지 대기
+            struct timespec deadline = realtime_deadline(now + 1000000000ULL);
+            pthread_cond_timedwait(&g_pipeline.cond, &g_pipeline.lock, &deadline);
+            expire_inflight_locked(monotonic_time_ns());
+        } else {
+            uint64_t batch_deadline = batcher_next_deadline();
+            if (batch_deadline) {
+                // 배치 지연 예산이 끝나는 시각까지만 대기
+                struct timespec deadline = realtime_deadline(batch_deadline);
+                pthread_cond_timedwait(&g_pipeline.cond, &g_pipeline.lock, &deadline);
+            } else {
+                pthread_cond_wait(&g_pipeline.cond, &g_pipeline.lock);
+            }
+        }
+    }
+}
+
+// 발행 스레드: 윈도우에 여유가 있는 동안 대기열을 연속 전송
+static void *publish_thread_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&g_pipeline.lock);
+    while (1) {
+        PublishItem *item = next_publish_item();
+        if (!item) {
+            break;
+        }
+        pthread_mutex_unlock(&g_pipeline.lock);
+
+        // 콜백이 설정된 클라이언트에서는 PUBACK을 기다리지 않고 반환
+        MQTTClient_deliveryToken token = 0;
+        int rc = publish_payload(item->topic, item->payload, item->payload_len, &token);
+        if (rc == MQTTCLIENT_SUCCESS) {
+            metrics_record(METRIC_STAGE_PUBLISH, monotonic_time_ns() - item->enqueue_ns);
+        }
+
+        pthread_mutex_lock(&g_pipeline.lock);
+        if ((rc == MQTTCLIENT_DISCONNECTED || rc == MQTTCLIENT_MAX_MESSAGES_INFLIGHT) && !g_pipeline.stopping) {
+            // 재연결 중이거나 Paho 한도에 걸린 일시 실패: 버리지 않고 맨 앞에 되돌려 잠시 뒤 다시 보냄
+            // (종료 중에는 끝나지 않을 수 있으므로 실패로 처리)
+            g_pipeline.retry = item;
+            g_pipeline.retry_at_ns = monotonic_time_ns() + PUBLISH_RETRY_DELAY_NS;
+            g_pipeline.stats.retried++;
+            log_debug("Publisher: Publish to topic '%s' deferred, return code %d", item->topic, rc);
+            continue;
+        }
+        if (rc != MQTTCLIENT_SUCCESS) {
+            log_error("Publisher: Failed to publish result to topic '%s', return code %d", item->topic, rc);
+        }
+        free(item);
+        if (rc != MQTTCLIENT_SUCCESS) {
+            g_pipeline.stats.failed++;
+            continue;
+        }
+        g_pipeline.stats.published++;
+
+        // 발행 호출이 반환되기 전에 PUBACK이 먼저 처리되었으면 슬롯을 잡지 않음
+        int acked = 0;
+        for (int i = 0; i < PUBLISH_EARLY_ACKS; i++) {
+            if (g_pipeline.early_acks[i] == token && token != 0) {
+                g_pipeline.early_acks[i] = 0;
+                g_pipeline.stats.delivered++;
+                acked = 1;
+                break;
+            }
+        }
+        for (int i = 0; !acked && i < g_pipeline.max_inflight; i++) {
+            InflightSlot *slot = &g_pipeline.inflight[i];
+            if (!slot->in_use) {
+                slot->in_use = 1;
+                slot->token = token;
+                slot->sent_ns = monotonic_time_ns();
+                g_pipeline.inflight_count++;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_pipeline.lock);
+    return NULL;
+}
+
+// 발행 완료(PUBACK) 콜백: in-flight 윈도우에서 제거
+void publish_delivery_complete(void *context, MQTTClient_deliveryToken dt) {
+    (void)context;
+
+    pthread_mutex_lock(&g_pipeline.lock);
+    if (g_pipeline.started) {
+        int found = 0;
+        for (int i = 0; i < g_pipeline.max_inflight; i++) {
+            InflightSlot *slot = &g_pipeline.inflight[i];
+            if (slot->in_use && slot->token == dt) {
+                metrics_record(METRIC_STAGE_PUBACK, monotonic_time_ns() - slot->sent_ns);
+                slot->in_use = 0;
+                g_pipeline.inflight_count--;
+                g_pipeline.stats.delivered++;
+                pthread_cond_broadcast(&g_pipeline.cond);
+                found = 1;
+                break;
+            }
+        }
+        if (!found) {
+            g_pipeline.early_acks[g_pipeline.early_ack_next] = dt;
+            g_pipeline.early_ack_next = (g_pipeline.early_ack_next + 1) % PUBLISH_EARLY_ACKS;
+        }
+    }
+    pthread_mutex_unlock(&g_pipeline.lock);
+}
+
+// 설정한 발행 윈도우를 쓸 수 있는 범위로 (연결 옵션의 maxInflightMessages와 파이프라인이 같은 값을 씀)
+int publisher_inflight_limit(int requested) {
+    if (requested <= 0) {
+        return PUBLISH_DEFAULT_MAX_INFLIGHT;
+    }
+    return requested < PUBLISH_MAX_INFLIGHT ? requested : PUBLISH_MAX_INFLIGHT;
+}
+
+// 발행 파이프라인 시작 (클라이언트 연결 후 호출)
+int publisher_start(int max_inflight, int queue_size) {
+    if (g_pipeline.started) {
+        return 0;
+    }
+    max_inflight = publisher_inflight_limit(max_inflight);
+    if (queue_size <= 0) queue_size = PUBLISH_DEFAULT_QUEUE_SIZE;
+
+    g_pipeline.queue = calloc(queue_size, sizeof(PublishItem *));
+    g_pipeline.inflight = calloc(max_inflight, sizeof(InflightSlot));
+    if (!g_pipeline.queue || !g_pipeline.inflight) {
+        free(g_pipeline.queue);
+        free(g_pipeline.inflight);
+        g_pipeline.queue = NULL;
+        g_pipeline.inflight = NULL;
+        return -1;
+    }
+    g_pipeline.queue_size = queue_size;
+    g_pipeline.max_inflight = max_inflight;
+    g_pipeline.queue_head = 0;
+    g_pipeline.queue_count = 0;
+    g_pipeline.inflight_count = 0;
+    memset(g_pipeline.early_acks, 0, sizeof(g_pipeline.early_acks));
+    g_pipeline.early_ack_next = 0;
+    g_pipeline.stopping = 0;
+    g_pipeline.retry = NULL;
+    memset(&g_pipeline.stats, 0, sizeof(g_pipeline.stats));
+
+    if (pthread_create(&g_pipeline.thread, NULL, publish_thread_main, NULL) != 0) {
+        log_error("Publisher: Failed to start publish thread");
+        free(g_pipeline.queue);
+        free(g_pipeline.inflight);
+        g_pipeline.queue = NULL;
+        g_pipeline.inflight = NULL;
+        return -1;
+    }
+    g_pipeline.started = 1;
+    log_info("Publisher: Publish pipeline started (max in-flight %d, queue %d)", max_inflight, queue_size);
+    return 0;
+}
+
+// 발행 파이프라인 종료: 대기열을 비우고 in-flight가 끝나길 최대 timeout_ms 기다림
+void publisher_stop(int timeout_ms) {
+    pthread_mutex_lock(&g_pipeline.lock);
+    if (!g_pipeline.started) {
+        pthread_mutex_unlock(&g_pipeline.lock);
+        return;
+    }
+    g_pipeline.stopping = 1;
+    pthread_cond_broadcast(&g_pipeline.cond);
+    pthread_mutex_unlock(&g_pipeline.lock);
+
+    pthread_join(g_pipeline.thread, NULL);
+
+    pthread_mutex_lock(&g_pipeline.lock);
+    uint64_t deadline = monotonic_time_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    while (g_pipeline.inflight_count > 0 && monotonic_time_ns() < deadline) {
+        struct timespec wait_until = realtime_deadline(deadline);
+        pthread_cond_timedwait(&g_pipeline.cond, &g_pipeline.lock, &wait_until);
+    }
+
+    // 전송하지 못한 항목 폐기
+    if (g_pipeline.retry) {
+        free(g_pipeline.retry);
+        g_pipeline.retry = NULL;
+        g_pipeline.stats.dropped++;
+    }
+    while (g_pipeline.queue_count > 0) {
+        free(g_pipeline.queue[g_pipeline.queue_head]);
+        g_pipeline.queue_head = (g_pipeline.queue_head + 1) % g_pipeline.queue_size;
+        g_pipeline.queue_count--;
+        g_pipeline.stats.dropped++;
+    }
+
+    // 윈도우가 닫힌 채 종료된 경우 남은 배치 폐기
+    PublishItem *leftover;
+    while ((leftover = batcher_take_any()) != NULL) {
+        free(leftover);
+        g_pipeline.stats.dropped++;
+    }
+
+    PublishStats stats = g_pipeline.stats;
+    batcher_get_stats(&stats.batch);
+    batcher_cleanup();
+    g_pipeline.started = 0;
+    free(g_pipeline.queue);
+    free(g_pipeline.inflight);
+    g_pipeline.queue = NULL;
+    g_pipeline.inflight = NULL;
+    pthread_mutex_unlock(&g_pipeline.lock);
+
+    log_info("Publisher: Publish pipeline stopped - enqueued %llu, published %llu, delivered %llu, "
+             "failed %llu, dropped %llu, expired %llu, retried %llu",
+             (unsigned long long)stats.enqueued, (unsigned long long)stats.published,
+             (unsigned long long)stats.delivered, (unsigned long long)stats.failed,
+             (unsigned long long)stats.dropped, (unsigned long long)stats.expired,
+             (unsigned long long)stats.retried);
+    if (stats.batch.batches > 0) {
+        log_info("Publisher: Batching - %llu batches / %llu results, flushed by count %llu, bytes %llu, "
+                 "timeout %llu, shutdown %llu",
+                 (unsigned long long)stats.batch.batches, (unsigned long long)stats.batch.batched_messages,
+                 (unsigned long long)stats.batch.flush_count, (unsigned long long)stats.batch.flush_bytes,
+                 (unsigned long long)stats.batch.flush_timeout, (unsigned long long)stats.batch.flush_shutdown);
+    }
+}
+
+// 발행 파이프라인 통계 조회
+void publisher_get_stats(PublishStats *stats) {
+    if (!stats) {
+        return;
     }
+    pthread_mutex_lock(&g_pipeline.lock);
+    *stats = g_pipeline.stats;
+    batcher_get_stats(&stats->batch);
+    stats->queue_depth = g_pipeline.queue_count;
+    stats->inflight = g_pipeline.inflight_count;
+    pthread_mutex_unlock(&g_pipeline.lock);
 }
 
 // publisher는 수신 메시지 처리 필요 없음
@@ -0,0 +1,195 @@
+#include "../mqtt.h"
+
+// 토픽별 배치 버퍼 ("[" + 결과1 + "," + 결과2 ... 형태로 누적)
+typedef struct {
+    char topic[MAX_TOPIC_LEN];
+    char *buf;
+    size_t len;
+    size_t cap;
+    int count;
+    uint64_t first_ns;          // 첫 결과가 들어온 시각 (지연 예산 기준)
+    uint64_t enqueue_ns;        // 첫 결과의 대기열 진입 시각 (발행 지연 측정용)
+} Batch;
+
+// 배치 단계는 발행 스레드(파이프라인 락 보유 상태)에서만 사용하므로 별도 락 없음
+static struct {
+    char filters[MAX_BATCH_FILTERS][MAX_TOPIC_LEN];
+    int filter_count;
+    int max_messages;
+    size_t max_bytes;
+    uint64_t max_delay_ns;
+    Batch batches[MAX_BATCH_TOPICS];
+    int batch_count;
+    BatchStats stats;
+} g_batcher;
+
+// 배치 설정 (발행 파이프라인 시작 전에 호출)
+void batcher_configure(const MQTTConfig *config) {
+    memset(&g_batcher, 0, sizeof(g_batcher));
+    g_batcher.max_messages = config->batch_max_messages;
+    g_batcher.max_bytes = config->batch_max_bytes > 0 ? (size_t)config->batch_max_bytes : BATCH_DEFAULT_MAX_BYTES;
+    g_batcher.max_delay_ns = (uint64_t)config->batch_max_delay_ms * 1000000ULL;
+
+    for (int i = 0; i < config->batch_topic_count && i < MAX_BATCH_FILTERS; i++) {
+        strcpy(g_batcher.filters[i], config->batch_topics[i]);
+        g_batcher.filter_count++;
+    }
+    if (g_batcher.filter_count > 0 && g_batcher.max_messages > 1) {
+        log_info("Publisher: Batching %d topic filter(s), up to %d messages / %d ms / %zu bytes",
+                 g_batcher.filter_count, g_batcher.max_messages, config->batch_max_delay_ms, g_batcher.max_bytes);
+    }
+}
+
+// 배치 대상 토픽인지 확인 (설정된 필터 중 하나와 일치)
+int batcher_wants(const char *topic) {
+    if (g_batcher.max_messages <= 1) {
+        return 0;
+    }
+    for (int i = 0; i < g_batcher.filter_count; i++) {
+        if (topic_matches_filter(g_batcher.filters[i], topic)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 배치를 발행 항목으로 변환하고 버퍼 비움
+static PublishItem *batch_take(Batch *batch, int reason) {
+    size_t topic_len = strlen(batch->topic);
+    PublishItem *item = malloc(sizeof(PublishItem) + topic_len + 1 + batch->len + 2);
+    if (!item) {
+        return NULL;
+    }
+    memcpy(item->topic, batch->topic, topic_len + 1);
+    item->payload = item->topic + topic_len + 1;
+    memcpy(item->payload, batch->buf, batch->len);
+    item->payload[batch->len] = ']';
+    item->payload[batch->len + 1] = '\0';
+    item->payload_len = (int)batch->len + 1;
+    item->enqueue_ns = batch->enqueue_ns;
+
+    g_batcher.stats.batches++;
+    g_batcher.stats.batched_messages += batch->count;
+    switch (reason) {
+    case BATCH_FLUSH_COUNT:    g_batcher.stats.flush_count++; break;
+    case BATCH_FLUSH_BYTES:    g_batcher.stats.flush_bytes++; break;
+    case BATCH_FLUSH_TIMEOUT:  g_batcher.stats.flush_timeout++; break;
+    default:                   g_batcher.stats.flush_shutdown++; break;
+    }
+
+    batch->len = 0;
+    batch->count = 0;
+    return item;
+}
+
+static Batch *batch_find_or_create(const char *topic) {
+    for (int i = 0; i < g_batcher.batch_count; i++) {
+        if (strcmp(g_batcher.batches[i].topic, topic) == 0) {
+            return &g_batcher.batches[i];
+        }
+    }
+    if (g_batcher.batch_count >= MAX_BATCH_TOPICS) {
+        return NULL;
+    }
+    Batch *batch = &g_batcher.batches[g_batcher.batch_count++];
+    strncpy(batch->topic, topic, sizeof(batch->topic) - 1);
+    return batch;
+}
+
+// 결과 하나를 배치에 추가 (item은 소비됨)
+// 배치가 가득 차면 발행할 항목을 반환, 아니면 NULL
+PublishItem *batcher_append(PublishItem *item, uint64_t now) {
+    Batch *batch = batch_find_or_create(item->topic);
+    if (!batch) {
+        // 배치 슬롯이 없으면 그대로 발행
+        return item;
+    }
+
+    // 이번 결과를 넣으면 바이트 한도를 넘는 경우 기존 배치를 먼저 내보냄
+    PublishItem *ready = NULL;
+    size_t needed = (size_t)item->payload_len + 1;
+    if (batch->count > 0 && batch->len + needed + 1 > g_batcher.max_bytes) {
+        ready = batch_take(batch, BATCH_FLUSH_BYTES);
+    }
+
+    if (batch->len + needed + 2 > batch->cap) {
+        size_t new_cap = batch->cap ? batch->cap : 1024;
+        while (new_cap < batch->len + needed + 2) {
+            new_cap *= 2;
+        }
+        char *grown = realloc(batch->buf, new_cap);
+        if (!grown) {
+            free(item);
+            g_batcher.stats.dropped++;
+            return ready;
+        }
+        batch->buf = grown;
+        batch->cap = new_cap;
+    }
+
+    if (batch->count == 0) {
+        batch->buf[batch->len++] = '[';
+        batch->first_ns = now;
+        batch->enqueue_ns = item->enqueue_ns;
+    } else {
+        batch->buf[batch->len++] = ',';
+    }
+    memcpy(batch->buf + batch->len, item->payload, item->payload_len);
+    batch->len += item->payload_len;
+    batch->count++;
+    free(item);
+
+    if (!ready && batch->count >= g_batcher.max_messages) {
+        ready = batch_take(batch, BATCH_FLUSH_COUNT);
+    }
+    return ready;
+}
+
+// 지연 예산을 넘긴 배치 하나를 꺼냄 (없으면 NULL)
+PublishItem *batcher_take_expired(uint64_t now) {
+    for (int i = 0; i < g_batcher.batch_count; i++) {
+        Batch *batch = &g_batcher.batches[i];
+        if (batch->count > 0 && now - batch->first_ns >= g_batcher.max_delay_ns) {
+            return batch_take(batch, BATCH_FLUSH_TIMEOUT);
+        }
+    }
+    return NULL;
+}
+
+// 종료 시 남은 배치 하나를 꺼냄 (없으면 NULL)
+PublishItem *batcher_take_any(void) {
+    for (int i = 0; i < g_batcher.batch_count; i++) {
+        if (g_batcher.batches[i].count > 0) {
+            return batch_take(&g_batcher.batches[i], BATCH_FLUSH_SHUTDOWN);
+        }
+    }
+    return NULL;
+}
+
+// 가장 이른 배치 마감 시각 (없으면 0)
+uint64_t batcher_next_deadline(void) {
+    uint64_t deadline = 0;
+    for (int i = 0; i < g_batcher.batch_count; i++) {
+        Batch *batch = &g_batcher.batches[i];
+        if (batch->count > 0) {
+            uint64_t due = batch->first_ns + g_batcher.max_delay_ns;
+            if (deadline == 0 || due < deadline) {
+                deadline = due;
+            }
+        }
+    }
+    return deadline;
+}
+
+// 배치 통계 조회 (파이프라인 락 보유 상태에서 호출)
+void batcher_get_stats(BatchStats *stats) {
+    *stats = g_batcher.stats;
+}
+
+// 배치 버퍼 해제
+void batcher_cleanup(void) {
+    for (int i = 0; i < g_batcher.batch_count; i++) {
+        free(g_batcher.batches[i].buf);
+    }
+    memset(&g_batcher, 0, sizeof(g_batcher));
+}
@@ -0,0 +1,169 @@
+#include "../mqtt.h"
+
+// 이벤트 기반 재연결
+// Paho의 connectionLost 콜백에서는 MQTTClient_connect를 부를 수 없으므로
+// 콜백은 끊긴 시각만 남기고 eventfd로 리액터를 깨움. 리액터 스레드가 지수 백오프 +
+// 지터로 timerfd를 걸어 재연결을 시도하고, 세션이 유지됐으면 재구독을 건너뜀
+// 프로세스마다 MQTT 연결이 하나이므로 상태는 전역 하나로 둠
+
+static struct {
+    MQTTClient client;
+    MQTTClient_connectOptions *conn_opts;
+    const TopicList *topics;    // NULL이면 재구독 없음 (Publisher)
+    int qos;
+    int batch_size;
+    int min_delay_ms;
+    int max_delay_ms;
+    char role[32];
+    int event_fd;
+    int timer_fd;
+    int attempt;
+    int pending;                // 재연결 진행 중 (리액터 스레드 전용)
+    uint64_t lost_ns;           // 처음 끊긴 시각 (콜백 스레드가 기록)
+    unsigned int seed;
+} g_reconnect = { .event_fd = -1, .timer_fd = -1 };
+
+// 다음 대기 시간: min * 2^attempt (max에서 멈춤)의 절반 + 그 절반 안의 무작위 값
+// 여러 게이트웨이가 동시에 끊겨도 재연결 시점이 흩어지도록 함
+static long reconnect_next_delay(void) {
+    long base = g_reconnect.min_delay_ms;
+    for (int i = 0; i < g_reconnect.attempt && base < g_reconnect.max_delay_ms; i++) {
+        base *= 2;
+    }
+    if (base > g_reconnect.max_delay_ms) {
+        base = g_reconnect.max_delay_ms;
+    }
+    g_reconnect.attempt++;
+    return base / 2 + (long)(rand_r(&g_reconnect.seed) % (unsigned int)(base / 2 + 1));
+}
+
+// 한 번만 울리는 재시도 타이머 설정
+static void reconnect_arm(long delay_ms) {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = delay_ms / 1000;
+    spec.it_value.tv_nsec = (delay_ms % 1000) * 1000000L;
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1;  // 0이면 타이머가 해제되므로 즉시 만기로
+    }
+    if (timerfd_settime(g_reconnect.timer_fd, 0, &spec, NULL) == -1) {
+        perror("Reconnect: timerfd_settime failed");
+    }
+}
+
+// eventfd 콜백: 연결이 끊겼으면 첫 재시도 예약
+static void on_connection_lost_event(int fd, uint32_t events, void *context) {
+    (void)events;
+    (void)context;
+    reactor_drain_fd(fd);
+    if (g_reconnect.pending) {
+        return;
+    }
+
+    uint64_t expected = 0;
+    __atomic_compare_exchange_n(&g_reconnect.lost_ns, &expected, monotonic_time_ns(), 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    g_reconnect.pending = 1;
+    g_reconnect.attempt = 0;
+    metrics_count(METRIC_CONNECTIONS_LOST);
+
+    long delay_ms = reconnect_next_delay();
+    log_warn("%s: Connection lost, reconnecting in %ld ms", g_reconnect.role, delay_ms);
+    reconnect_arm(delay_ms);
+}
+
+// timerfd 콜백: 재연결 시도, 실패하면 다음 백오프로 다시 예약
+static void on_reconnect_timer(int fd, uint32_t events, void *context) {
+    (void)events;
+    (void)context;
+    reactor_drain_fd(fd);
+    if (!g_reconnect.pending) {
+        return;
+    }
+
+    metrics_count(METRIC_RECONNECT_ATTEMPTS);
+    int rc = MQTTClient_connect(g_reconnect.client, g_reconnect.conn_opts);
+    if (rc != MQTTCLIENT_SUCCESS) {
+        long delay_ms = reconnect_next_delay();
+        log_warn("%s: Reconnect attempt %d failed, return code %d, retrying in %ld ms",
+                 g_reconnect.role, g_reconnect.attempt - 1, rc, delay_ms);
+        reconnect_arm(delay_ms);
+        return;
+    }
+
+    // 지속 세션이 남아 있으면 브로커가 구독과 대기 중인 QoS 1 메시지를 갖고 있음
+    int session_present = !g_reconnect.conn_opts->cleansession && g_reconnect.conn_opts->returned.sessionPresent;
+    if (session_present) {
+        metrics_count(METRIC_SESSIONS_RESUMED);
+        log_info("%s: Session resumed, subscriptions kept by broker", g_reconnect.role);
+    } else if (g_reconnect.topics) {
+        subscribe_to_topics(g_reconnect.client, g_reconnect.topics, g_reconnect.qos, g_reconnect.batch_size);
+    }
+
+    uint64_t lost_ns = __atomic_exchange_n(&g_reconnect.lost_ns, 0, __ATOMIC_ACQ_REL);
+    uint64_t recover_ns = lost_ns ? monotonic_time_ns() - lost_ns : 0;
+    metrics_record(METRIC_STAGE_RECONNECT, recover_ns);
+    log_info("%s: Reconnected after %d attempt(s), recovered in %.1f ms", g_reconnect.role,
+             g_reconnect.attempt, recover_ns / 1000000.0);
+    g_reconnect.pending = 0;
+}
+
+// 재연결 감시 시작 (첫 연결과 구독이 끝난 뒤 호출)
+// conn_opts와 topics는 리액터가 도는 동안 유지되어야 함
+int reconnect_init(Reactor *reactor, const char *role, MQTTClient client,
+                   MQTTClient_connectOptions *conn_opts, const MQTTConfig *config, const TopicList *topics) {
+    g_reconnect.client = client;
+    g_reconnect.conn_opts = conn_opts;
+    g_reconnect.topics = topics;
+    g_reconnect.qos = config->qos;
+    g_reconnect.batch_size = config->subscribe_batch_size;
+    g_reconnect.min_delay_ms = config->reconnect_min_ms > 0 ? config->reconnect_min_ms : RECONNECT_DEFAULT_MIN_MS;
+    g_reconnect.max_delay_ms = config->reconnect_max_ms >= g_reconnect.min_delay_ms ?
+                               config->reconnect_max_ms : g_reconnect.min_delay_ms;
+    snprintf(g_reconnect.role, sizeof(g_reconnect.role), "%s", role);
+    g_reconnect.attempt = 0;
+    g_reconnect.pending = 0;
+    g_reconnect.lost_ns = 0;
+    g_reconnect.seed = (unsigned int)(monotonic_time_ns() ^ ((uint64_t)getpid() << 16));
+
+    g_reconnect.event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    g_reconnect.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_reconnect.event_fd == -1 || g_reconnect.timer_fd == -1) {
+        perror("Reconnect: eventfd/timerfd failed");
+        reconnect_cleanup();
+        return -1;
+    }
+    if (reactor_add_fd(reactor, g_reconnect.event_fd, on_connection_lost_event, NULL) != 0 ||
+        reactor_add_fd(reactor, g_reconnect.timer_fd, on_reconnect_timer, NULL) != 0) {
+        reconnect_cleanup();
+        return -1;
+    }
+    return 0;
+}
+
+// Paho 콜백 스레드에서 호출: 끊긴 시각을 남기고 리액터를 깨움
+void reconnect_connection_lost(void) {
+    if (g_reconnect.event_fd == -1) {
+        return;
+    }
+    uint64_t expected = 0;
+    __atomic_compare_exchange_n(&g_reconnect.lost_ns, &expected, monotonic_time_ns(), 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    uint64_t one = 1;
+    if (write(g_reconnect.event_fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        perror("Reconnect: eventfd write failed");
+    }
+}
+
+// 감시 종료 (reactor_cleanup 이후 호출)
+void reconnect_cleanup(void) {
+    if (g_reconnect.event_fd != -1) {
+        close(g_reconnect.event_fd);
+        g_reconnect.event_fd = -1;
+    }
+    if (g_reconnect.timer_fd != -1) {
+        close(g_reconnect.timer_fd);
+        g_reconnect.timer_fd = -1;
+    }
+    g_reconnect.pending = 0;
+}
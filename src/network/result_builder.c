@@ -0,0 +1,425 @@
+#include "../mqtt.h"
+
+// 디바이스별 상태 토픽 (시작 시 한 번 만들고 이후 읽기 전용)
+// id_offset/id_len은 topic 안의 device_id 단계 위치 (가상 디바이스는 이 자리만 바꿔 씀)
+typedef struct {
+    char target[64];
+    char topic[MAX_TOPIC_LEN];
+    uint16_t id_offset;
+    uint16_t id_len;
+} StatusTopic;
+
+static StatusTopic g_status_topics[MAX_STATUS_TOPICS];
+static int g_status_topic_count = 0;
+static char g_device_id[64] = DEFAULT_DEVICE_ID;
+
+// 초 단위 타임스탬프 문자열 캐시 (스레드별)
+static __thread time_t t_cached_sec = 0;
+static __thread char t_cached_digits[24];
+static __thread int t_cached_len = 0;
+
+// 스레드의 현재 결과 인코딩 (디스패치가 명령마다 정하고 실행기가 작업과 함께 넘김)
+static __thread int t_result_encoding = PAYLOAD_ENCODING_JSON;
+
+static int intern_status_topic(const char *target, const char *topic) {
+    for (int i = 0; i < g_status_topic_count; i++) {
+        if (strcmp(g_status_topics[i].target, target) == 0) {
+            return 0;
+        }
+    }
+    if (g_status_topic_count >= MAX_STATUS_TOPICS) {
+        return -1;
+    }
+    StatusTopic *entry = &g_status_topics[g_status_topic_count++];
+    strncpy(entry->target, target, sizeof(entry->target) - 1);
+    strncpy(entry->topic, topic, sizeof(entry->topic) - 1);
+    ParsedTopic parsed;
+    if (parse_topic_view(entry->topic, &parsed) == 0) {
+        entry->id_offset = parsed.device_id.offset;
+        entry->id_len = parsed.device_id.len;
+    }
+    return 0;
+}
+
+// 상태 토픽 테이블 구성 (스레드 시작 전에 호출)
+// pub_topic 파일의 status/<device_id>/<target>/return 을 그대로 쓰고,
+// 파일에 없는 기본 디바이스는 설정의 device_id로 만듦
+int status_topics_init(const MQTTConfig *config) {
+    static const char *builtin_targets[] = { "led", "buzzer", "s_segment", "photoresistor" };
+
+    g_status_topic_count = 0;
+    if (config->device_id[0] != '\0') {
+        strncpy(g_device_id, config->device_id, sizeof(g_device_id) - 1);
+        g_device_id[sizeof(g_device_id) - 1] = '\0';
+    }
+
+    FILE *file = config->pub_topic_file[0] ? fopen(config->pub_topic_file, "r") : NULL;
+    if (file) {
+        char line[MAX_TOPIC_LEN];
+        while (fgets(line, sizeof(line), file)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0' || line[0] == '#') {
+                continue;
+            }
+            ParsedTopic parsed;
+            if (parse_topic_view(line, &parsed) == 0 && topic_level_is(line, parsed.prefix, "status") &&
+                topic_level_is(line, parsed.device_id, g_device_id)) {
+                char target[64];
+                topic_level_copy(line, parsed.target_device, target, sizeof(target));
+                intern_status_topic(target, line);
+            }
+        }
+        fclose(file);
+    }
+
+    for (size_t i = 0; i < sizeof(builtin_targets) / sizeof(builtin_targets[0]); i++) {
+        char topic[MAX_TOPIC_LEN];
+        snprintf(topic, sizeof(topic), "status/%s/%s/return", g_device_id, builtin_targets[i]);
+        intern_status_topic(builtin_targets[i], topic);
+    }
+
+    printf("Status topics (%d):\n", g_status_topic_count);
+    for (int i = 0; i < g_status_topic_count; i++) {
+        printf("  - %s -> %s\n", g_status_topics[i].target, g_status_topics[i].topic);
+    }
+    return g_status_topic_count;
+}
+
+// 설정된 게이트웨이 디바이스 ID
+const char *status_device_id(void) {
+    return g_device_id;
+}
+
+// 대상 디바이스의 상태 토픽 (미리 만든 문자열, 없으면 NULL)
+const char *status_topic_for(const char *target) {
+    for (int i = 0; i < g_status_topic_count; i++) {
+        if (strcmp(g_status_topics[i].target, target) == 0) {
+            return g_status_topics[i].topic;
+        }
+    }
+    return NULL;
+}
+
+// 다른 디바이스 ID의 상태 토픽 (설정된 토픽에서 device_id 단계만 바꿈)
+// 반환: 토픽 길이, 버퍼가 작으면 -1
+int status_topic_format(const char *device_id, size_t id_len, const char *target, char *buf, size_t size) {
+    int len;
+    for (int i = 0; i < g_status_topic_count; i++) {
+        const StatusTopic *entry = &g_status_topics[i];
+        if (strcmp(entry->target, target) == 0 && entry->id_len > 0) {
+            const char *suffix = entry->topic + entry->id_offset + entry->id_len;
+            len = snprintf(buf, size, "%.*s%.*s%s", entry->id_offset, entry->topic, (int)id_len, device_id, suffix);
+            return (len < 0 || (size_t)len >= size) ? -1 : len;
+        }
+    }
+    len = snprintf(buf, size, "status/%.*s/%s/return", (int)id_len, device_id, target);
+    return (len < 0 || (size_t)len >= size) ? -1 : len;
+}
+
+// timestamp/닫는 괄호용 예약 공간을 뺀 남은 크기
+static size_t rb_room(const ResultBuilder *rb) {
+    return RESULT_BUFFER_SIZE - RESULT_RESERVE - rb->len;
+}
+
+static void rb_put(ResultBuilder *rb, const char *data, size_t len) {
+    memcpy(rb->buf + rb->len, data, len);
+    rb->len += len;
+}
+
+// 정수를 10진 문자열로 변환 (반환: 길이)
+static int format_long(long value, char *out) {
+    char tmp[24];
+    int n = 0;
+    unsigned long v = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    int len = 0;
+    if (value < 0) {
+        out[len++] = '-';
+    }
+    while (n) {
+        out[len++] = tmp[--n];
+    }
+    return len;
+}
+
+// CBOR 항목 머리 (major type + 길이/값)
+static void rb_put_head(ResultBuilder *rb, int major, uint64_t value) {
+    rb->len += cbor_put_head((uint8_t *)rb->buf + rb->len, major, value);
+}
+
+static void rb_put_cbor_int(ResultBuilder *rb, long value) {
+    if (value < 0) {
+        rb_put_head(rb, 1, (uint64_t)(-(value + 1)));
+    } else {
+        rb_put_head(rb, 0, (uint64_t)value);
+    }
+}
+
+// 실수는 JSON과 같이 소수점 둘째 자리로 반올림한 뒤 정수 → float32 → float64 중 짧은 것으로
+static void rb_put_cbor_double(ResultBuilder *rb, double value) {
+    if (!isfinite(value)) {
+        rb_put(rb, "\xf6", 1);
+        return;
+    }
+    double rounded = round(value * 100.0) / 100.0;
+    if (fabs(rounded) < 1e15 && rounded == (double)(long)rounded) {
+        rb_put_cbor_int(rb, (long)rounded);
+        return;
+    }
+    float single = (float)rounded;
+    uint8_t *out = (uint8_t *)rb->buf + rb->len;
+    if (fabs((double)single - rounded) < 0.001) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        out[0] = 0xFA;
+        for (int i = 0; i < 4; i++) {
+            out[1 + i] = (uint8_t)(bits >> (24 - 8 * i));
+        }
+        rb->len += 5;
+        return;
+    }
+    uint64_t bits;
+    memcpy(&bits, &rounded, sizeof(bits));
+    out[0] = 0xFB;
+    for (int i = 0; i < 8; i++) {
+        out[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    rb->len += 9;
+}
+
+// CBOR 텍스트 값 (공간이 부족하면 UTF-8 문자 경계에서 자름)
+static void rb_put_cbor_string(ResultBuilder *rb, const char *value, size_t len) {
+    size_t room = rb_room(rb);
+    size_t head = len < 24 ? 1 : (len < 256 ? 2 : 3);
+    if (head + len > room) {
+        rb->truncated = 1;
+        len = room > 3 ? room - 3 : 0;
+        while (len > 0 && ((unsigned char)value[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+    rb_put_head(rb, 3, len);
+    rb_put(rb, value, len);
+}
+
+// ,"key": 추가 (CBOR면 표에 있는 이름은 정수 키, 나머지는 텍스트 키). 값(min_value 바이트)까지 들어갈 공간이 없으면 0 반환 후 이후 필드 무시
+static int rb_begin_field(ResultBuilder *rb, const char *key, size_t min_value) {
+    size_t key_len = strlen(key);
+    if (rb->truncated || key_len + 4 + min_value > rb_room(rb)) {
+        rb->truncated = 1;
+        return 0;
+    }
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        int id = cbor_key_id(key, key_len);
+        if (id > 0) {
+            rb_put_head(rb, 0, (uint64_t)id);
+        } else {
+            rb_put_head(rb, 3, key_len);
+            rb_put(rb, key, key_len);
+        }
+        rb->fields++;
+        return 1;
+    }
+    if (rb->fields > 0) {
+        rb_put(rb, ",", 1);
+    }
+    rb_put(rb, "\"", 1);
+    rb_put(rb, key, key_len);
+    rb_put(rb, "\":", 2);
+    rb->fields++;
+    return 1;
+}
+
+// JSON 문자열 값 추가 (따옴표/역슬래시/제어문자 이스케이프)
+// 공간이 부족하면 값을 잘라도 닫는 따옴표는 항상 붙임
+static void rb_put_json_string(ResultBuilder *rb, const char *value, size_t value_len) {
+    static const char hex[] = "0123456789abcdef";
+    rb_put(rb, "\"", 1);
+    const char *end = value + value_len;
+    const char *run = value;
+    const char *p;
+    for (p = value; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        char esc[6] = { '\\', (char)c, 0, 0, 0, 0 };
+        size_t esc_len = 2;
+        if (c == '\n') esc[1] = 'n';
+        else if (c == '\r') esc[1] = 'r';
+        else if (c == '\t') esc[1] = 't';
+        else if (c < 0x20) {
+            esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+            esc[4] = hex[c >> 4]; esc[5] = hex[c & 0xF];
+            esc_len = 6;
+        }
+        size_t run_len = (size_t)(p - run);
+        if (run_len + esc_len + 1 > rb_room(rb)) {
+            break;
+        }
+        rb_put(rb, run, run_len);
+        rb_put(rb, esc, esc_len);
+        run = p + 1;
+    }
+    size_t run_len = (size_t)(p - run);
+    if (p < end || run_len + 1 > rb_room(rb)) {
+        rb->truncated = 1;
+        if (run_len + 1 > rb_room(rb)) {
+            run_len = rb_room(rb) - 1;
+        }
+    }
+    rb_put(rb, run, run_len);
+    rb_put(rb, "\"", 1);
+}
+
+// 이 스레드에서 이후 만드는 결과의 인코딩 (PAYLOAD_ENCODING_*)
+void result_set_encoding(int encoding) {
+    t_result_encoding = encoding;
+}
+
+int result_encoding(void) {
+    return t_result_encoding;
+}
+
+// 빈 결과 객체 시작
+void result_init(ResultBuilder *rb) {
+    rb->fields = 0;
+    rb->truncated = 0;
+    rb->encoding = t_result_encoding;
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        // 표시 태그 + 길이 없는 맵 (result_finish에서 필드가 23개 이하면 길이 있는 맵으로 바꿈)
+        memcpy(rb->buf, CBOR_MARKER "\xbf", CBOR_MARKER_LEN + 1);
+        rb->len = CBOR_MARKER_LEN + 1;
+        return;
+    }
+    rb->buf[0] = '{';
+    rb->len = 1;
+}
+
+// 디바이스 결과 시작: {"device":"<label>","command":"<command>"
+void result_begin(ResultBuilder *rb, const char *device_label, const char *command) {
+    result_init(rb);
+    result_add_str(rb, "device", device_label);
+    result_add_str(rb, "command", command);
+}
+
+void result_add_str(ResultBuilder *rb, const char *key, const char *value) {
+    result_add_strn(rb, key, value ? value : "", value ? strlen(value) : 0);
+}
+
+// 널 종료되지 않은 문자열 값 추가 (토픽 단계 뷰 등)
+void result_add_strn(ResultBuilder *rb, const char *key, const char *value, size_t len) {
+    if (!rb_begin_field(rb, key, 2)) {
+        return;
+    }
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        rb_put_cbor_string(rb, value, len);
+    } else {
+        rb_put_json_string(rb, value, len);
+    }
+}
+
+void result_add_int(ResultBuilder *rb, const char *key, long value) {
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        if (rb_begin_field(rb, key, 9)) {
+            rb_put_cbor_int(rb, value);
+        }
+        return;
+    }
+    char digits[24];
+    int len = format_long(value, digits);
+    if (rb_begin_field(rb, key, len)) {
+        rb_put(rb, digits, len);
+    }
+}
+
+// 실수 값 추가 (소수점 둘째 자리, NaN/무한대는 JSON에 없으므로 null)
+void result_add_double(ResultBuilder *rb, const char *key, double value) {
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        if (rb_begin_field(rb, key, 9)) {
+            rb_put_cbor_double(rb, value);
+        }
+        return;
+    }
+    // 소수 둘째 자리까지 반올림한 정수로 바꿔 쓰므로 snprintf("%.2f")보다 훨씬 빠름
+    char digits[32];
+    int len;
+    double scaled = round(value * 100.0);
+    if (isfinite(scaled) && fabs(scaled) < 9.0e15) {
+        long cents = (long)scaled;
+        long whole = cents < 0 ? -cents : cents;
+        len = 0;
+        if (cents < 0) {
+            digits[len++] = '-';
+        }
+        len += format_long(whole / 100, digits + len);
+        digits[len++] = '.';
+        digits[len++] = (char)('0' + whole % 100 / 10);
+        digits[len++] = (char)('0' + whole % 10);
+    } else if (isfinite(value)) {
+        len = snprintf(digits, sizeof(digits), "%.2e", value);
+    } else {
+        len = 4;
+        memcpy(digits, "null", 4);
+    }
+    if (rb_begin_field(rb, key, len)) {
+        rb_put(rb, digits, len);
+    }
+}
+
+// "timestamp" 필드와 닫는 괄호를 붙여 완성 (반환: 널 종료된 JSON, CBOR면 rb->len 바이트)
+// RESULT_RESERVE가 이 부분의 공간을 항상 보장함
+const char *result_finish(ResultBuilder *rb) {
+    time_t now = time(NULL);
+    if (rb->encoding == PAYLOAD_ENCODING_CBOR) {
+        rb_put_head(rb, 0, (uint64_t)cbor_key_id("timestamp", 9));
+        rb_put_cbor_int(rb, (long)now);
+        if (rb->fields + 1 < 24) {
+            rb->buf[CBOR_MARKER_LEN] = (char)(0xA0 | (rb->fields + 1));
+        } else {
+            rb_put(rb, "\xff", 1);
+        }
+        rb->buf[rb->len] = '\0';
+        return rb->buf;
+    }
+    if (now != t_cached_sec || t_cached_len == 0) {
+        t_cached_sec = now;
+        t_cached_len = format_long((long)now, t_cached_digits);
+    }
+    if (rb->fields > 0) {
+        rb_put(rb, ",", 1);
+    }
+    rb_put(rb, "\"timestamp\":", 12);
+    rb_put(rb, t_cached_digits, t_cached_len);
+    rb_put(rb, "}", 1);
+    rb->buf[rb->len] = '\0';
+    return rb->buf;
+}
+
+// 결과를 완성해 대상 디바이스의 상태 토픽으로 발행
+// 실행 중인 명령이 가상 디바이스 것이면 그 디바이스 ID의 상태 토픽으로 보냄
+void result_publish(ResultBuilder *rb, const char *target) {
+    const VirtualDevice *device = device_current();
+    const char *topic = device->physical ? status_topic_for(target) : NULL;
+    char formatted[MAX_TOPIC_LEN];
+    if (!topic) {
+        if (device->physical) {
+            snprintf(formatted, sizeof(formatted), "status/%s/%s/return", g_device_id, target);
+        } else if (status_topic_format(device->id, device->id_len, target, formatted, sizeof(formatted)) < 0) {
+            log_warn("Status topic too long for device '%s'", device->id);
+            return;
+        }
+        topic = formatted;
+    }
+    const char *payload = result_finish(rb);
+    send_result_payload(topic, payload, (int)rb->len);
+}
+
+// 결과를 완성해 지정한 토픽으로 발행
+void result_publish_to(ResultBuilder *rb, const char *topic) {
+    const char *payload = result_finish(rb);
+    send_result_payload(topic, payload, (int)rb->len);
+}
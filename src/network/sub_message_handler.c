@@ -1,63 +1,86 @@
 #include "../mqtt.h"
 
-// 토픽 계층 구조 파싱
-ParsedTopic parse_topic_hierarchy(const char *topic_name) {
-    ParsedTopic result;
-    memset(&result, 0, sizeof(ParsedTopic));
-    
-    if (!topic_name) {
-        result.is_valid = 0;
-        return result;
+// 토픽의 다음 단계 위치 반환 (재진입 가능, 복사/할당 없음)
+// *pos는 0으로 시작, 단계를 돌려주면 1, 더 없으면 0
+// MQTT 규칙대로 빈 단계도 하나의 단계로 셈 ("a//b"는 3단계)
+int topic_next_level(const char *topic, size_t *pos, TopicLevel *level) {
+    if (!topic || !pos || *pos == (size_t)-1) {
+        return 0;
     }
-    
-    // 토픽명을 복사하여 안전하게 파싱
-    int topic_len = strlen(topic_name);
-    char *topic_copy = malloc(topic_len + 1);
-    if (!topic_copy) {
-        result.is_valid = 0;
-        return result;
+
+    const char *start = topic + *pos;
+    const char *slash = strchr(start, '/');
+    size_t len = slash ? (size_t)(slash - start) : strlen(start);
+    if (*pos > UINT16_MAX || len > UINT16_MAX) {
+        *pos = (size_t)-1;
+        return 0;
     }
-    strcpy(topic_copy, topic_name);
-    
-    // 4단계 토픽 파싱 (prefix/device_id/target_device/command)
-    char *prefix = strtok(topic_copy, "/");
-    char *device_id = strtok(NULL, "/");
-    char *target_device = strtok(NULL, "/");
-    char *command = strtok(NULL, "/");
-    
-    if (prefix && device_id && target_device && command) {
-        strncpy(result.prefix, prefix, sizeof(result.prefix) - 1);
-        strncpy(result.device_id, device_id, sizeof(result.device_id) - 1);
-        strncpy(result.target_device, target_device, sizeof(result.target_device) - 1);
-        strncpy(result.command, command, sizeof(result.command) - 1);
-        result.is_valid = 1;
-    } else {
-        result.is_valid = 0;
+
+    level->offset = (uint16_t)*pos;
+    level->len = (uint16_t)len;
+    *pos = slash ? (size_t)(slash - topic) + 1 : (size_t)-1;
+    return 1;
+}
+
+// 토픽 전체를 단계별로 나눔 (반환: 전체 단계 수)
+// 앞의 MAX_TOPIC_LEVELS개 단계만 위치를 저장하고, 나머지는 개수만 셈
+int topic_tokenize(const char *topic, TopicTokens *tokens) {
+    size_t pos = 0;
+    TopicLevel level;
+
+    tokens->topic = topic;
+    tokens->level_count = 0;
+    while (topic_next_level(topic, &pos, &level)) {
+        if (tokens->level_count < MAX_TOPIC_LEVELS) {
+            tokens->levels[tokens->level_count] = level;
+        }
+        tokens->level_count++;
     }
-    
-    free(topic_copy);
-    return result;
+    return tokens->level_count;
 }
 
-// 메시지 페이로드 파싱
-ParsedMessage parse_message_payload(const char *payload, int payload_len) {
-    ParsedMessage result;
-    memset(&result, 0, sizeof(ParsedMessage));
-    
-    if (!payload || payload_len <= 0) {
-        return result;
+// 토픽 계층 구조 파싱 (prefix/device_id/target_device/command)
+// 앞 4단계가 모두 비어 있지 않아야 유효, 5단계 이후는 무시
+int parse_topic_view(const char *topic, ParsedTopic *parsed) {
+    TopicLevel *fields[4] = { &parsed->prefix, &parsed->device_id, &parsed->target_device, &parsed->command };
+    size_t pos = 0;
+
+    memset(parsed, 0, sizeof(ParsedTopic));
+    parsed->topic = topic;
+    for (int i = 0; i < 4; i++) {
+        if (!topic_next_level(topic, &pos, fields[i]) || fields[i]->len == 0) {
+            return -1;
+        }
     }
-    
-    // 페이로드 크기 체크
-    if (payload_len > MAX_PAYLOAD_SIZE) {
-        printf("Warning: Payload too large (%d bytes), skipping parsing\n", payload_len);
-        return result;
+    parsed->is_valid = 1;
+    return 0;
+}
+
+// 토픽 단계가 문자열과 같은지 비교
+int topic_level_is(const char *topic, TopicLevel level, const char *literal) {
+    return strncmp(topic + level.offset, literal, level.len) == 0 && literal[level.len] == '\0';
+}
+
+// 토픽 단계를 널 종료 문자열로 복사 (버퍼보다 길면 잘림, 반환: 복사한 길이)
+size_t topic_level_copy(const char *topic, TopicLevel level, char *buf, size_t size) {
+    if (size == 0) {
+        return 0;
     }
+    size_t len = level.len < size - 1 ? level.len : size - 1;
+    memcpy(buf, topic + level.offset, len);
+    buf[len] = '\0';
+    return len;
+}
+
+// 복잡한 문서용 cJSON 경로 (중첩이 깊어 스트리밍 추출기가 넘긴 경우)
+static ParsedMessage parse_message_payload_cjson(const char *payload, int payload_len) {
+    ParsedMessage result;
+    memset(&result, 0, sizeof(ParsedMessage));
     
     // JSON 파싱을 위해 페이로드 문자열을 널 종료
     char *json_string = malloc(payload_len + 1);
     if (!json_string) {
-        printf("Failed to allocate memory for JSON string\n");
+        log_error("Failed to allocate memory for JSON string");
         return result;
     }
     
@@ -105,55 +128,152 @@ ParsedMessage parse_message_payload(const char *payload, int payload_len) {
     return result;
 }
 
+// 메시지 페이로드 파싱
+// 페이로드를 제자리에서 훑어 message/value/status만 꺼냄 (복사/DOM 없음)
+ParsedMessage parse_message_payload(const char *payload, int payload_len) {
+    ParsedMessage result;
+    memset(&result, 0, sizeof(ParsedMessage));
+    
+    if (!payload || payload_len <= 0) {
+        return result;
+    }
+    
+    // 페이로드 크기 체크
+    if (payload_len > MAX_PAYLOAD_SIZE) {
+        log_warn("Warning: Payload too large (%d bytes), skipping parsing", payload_len);
+        return result;
+    }
+    
+    // gzip 페이로드는 풀어서 다시 해석 (안쪽이 CBOR여도 됨)
+    if (compress_is_marked(payload, payload_len)) {
+        char *inflated = NULL;
+        int inflated_len = compress_inflate(payload, payload_len, &inflated);
+        if (inflated_len < 0) {
+            log_warn("Warning: Invalid gzip payload (%d bytes)", payload_len);
+        } else if (!compress_is_marked(inflated, inflated_len)) {
+            result = parse_message_payload(inflated, inflated_len);
+        }
+        free(inflated);
+        return result;
+    }
+    
+    // CBOR 페이로드는 JSON 텍스트로 바꿔 같은 경로로 해석
+    if (cbor_is_marked(payload, payload_len)) {
+        char *json = NULL;
+        int json_len = cbor_to_json_alloc(payload, payload_len, &json);
+        if (json_len == CBOR_TOO_LARGE) {
+            log_warn("Warning: CBOR payload (%d bytes) exceeds %d bytes as JSON", payload_len, MAX_PAYLOAD_SIZE);
+            metrics_count(METRIC_CBOR_OVERSIZE);
+        } else if (json_len < 0) {
+            log_warn("Warning: Invalid CBOR payload (%d bytes)", payload_len);
+            metrics_count(METRIC_CBOR_INVALID);
+        } else {
+            result = parse_message_payload(json, json_len);
+        }
+        free(json);
+        return result;
+    }
+    
+    JsonField fields[3] = { { .key = "message" }, { .key = "value" }, { .key = "status" } };
+    int found = json_extract_fields(payload, payload_len, fields, 3);
+    if (found == JSON_EXTRACT_COMPLEX) {
+        return parse_message_payload_cjson(payload, payload_len);
+    }
+    if (found == JSON_EXTRACT_INVALID) {
+        // JSON이 아닌 경우 원본 텍스트로 처리
+        int len = payload_len < (int)sizeof(result.message) - 1 ? payload_len : (int)sizeof(result.message) - 1;
+        memcpy(result.message, payload, len);
+        result.message[len] = '\0';
+        result.has_message = 1;
+        return result;
+    }
+    
+    result.is_json = 1;
+    
+    // "message" 필드 확인
+    if (fields[0].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[0], result.message, sizeof(result.message));
+        result.has_message = 1;
+    }
+    
+    // "value" 필드 확인 (숫자는 정수로)
+    int number;
+    if (fields[1].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[1], result.value, sizeof(result.value));
+        result.has_value = 1;
+    } else if (json_field_int(&fields[1], &number) == 0) {
+        snprintf(result.value, sizeof(result.value), "%d", number);
+        result.has_value = 1;
+    }
+    
+    // "status" 필드 확인
+    if (fields[2].type == JSON_FIELD_STRING) {
+        json_field_copy(&fields[2], result.status, sizeof(result.status));
+        result.has_status = 1;
+    }
+    
+    return result;
+}
+
 // 메시지 정보 출력
 void print_message_info(const ParsedTopic *topic_info, const ParsedMessage *msg_info) {
-    printf("\n=== Message received ===\n");
+    log_debug("=== Message received ===");
     
     if (topic_info->is_valid) {
-        printf("Prefix: %s\n", topic_info->prefix);
-        printf("Device ID: %s\n", topic_info->device_id);
-        printf("Target Device: %s\n", topic_info->target_device);
-        printf("Command: %s\n", topic_info->command);
-        printf("Processing: Control '%s' on device '%s' with command '%s' (prefix: %s)\n", 
-               topic_info->target_device, topic_info->device_id, topic_info->command, topic_info->prefix);
+        const char *topic = topic_info->topic;
+        TopicLevel prefix = topic_info->prefix;
+        TopicLevel device_id = topic_info->device_id;
+        TopicLevel target = topic_info->target_device;
+        TopicLevel command = topic_info->command;
+        
+        log_debug("Prefix: %.*s", prefix.len, topic + prefix.offset);
+        log_debug("Device ID: %.*s", device_id.len, topic + device_id.offset);
+        log_debug("Target Device: %.*s", target.len, topic + target.offset);
+        log_debug("Command: %.*s", command.len, topic + command.offset);
+        log_debug("Processing: Control '%.*s' on device '%.*s' with command '%.*s' (prefix: %.*s)", 
+                  target.len, topic + target.offset, device_id.len, topic + device_id.offset,
+                  command.len, topic + command.offset, prefix.len, topic + prefix.offset);
     } else {
-        printf("Warning: Topic does not follow expected format (prefix/device_id/target_device/command)\n");
-        printf("Expected format example: control/raspberry_001/led/on\n");
+        log_warn("Warning: Topic does not follow expected format (prefix/device_id/target_device/command)");
+        log_warn("Expected format example: control/raspberry_001/led/on");
     }
     
-    if (msg_info->is_json) {
-        printf("Payload Type: JSON\n");
+    if (!msg_info) {
+        log_debug("Payload: forwarded without parsing");
+    } else if (msg_info->is_json) {
+        log_debug("Payload Type: JSON");
         if (msg_info->has_message) {
-            printf("Message: %s\n", msg_info->message);
+            log_debug("Message: %s", msg_info->message);
         }
         if (msg_info->has_value) {
-            printf("Value: %s\n", msg_info->value);
+            log_debug("Value: %s", msg_info->value);
         }
         if (msg_info->has_status) {
-            printf("Status: %s\n", msg_info->status);
+            log_debug("Status: %s", msg_info->status);
         }
     } else {
-        printf("Payload Type: Plain Text\n");
+        log_debug("Payload Type: Plain Text");
         if (msg_info->has_message) {
-            printf("Content: %s\n", msg_info->message);
+            log_debug("Content: %s", msg_info->message);
         }
     }
     
-    printf("========================\n");
+    log_debug("========================");
 }
 
 // 메시지 수신 콜백 함수
 int messageArrived(void *context, char *topicName, int topicLen, MQTTClient_message *message) {
     // NULL 체크
     if (!message || !topicName) {
-        printf("Error: NULL message or topic received\n");
+        log_error("Error: NULL message or topic received");
         return 1;
     }
     
-    printf("Topic: %s\n", topicName);
+    log_debug("Topic: %s", topicName);
     
     // 토픽 파싱
-    ParsedTopic topic_info = parse_topic_hierarchy(topicName);
+    ParsedTopic topic_info;
+    parse_topic_view(topicName, &topic_info);
     
     // 메시지 파싱
     ParsedMessage msg_info;
@@ -161,10 +281,10 @@ int messageArrived(void *context, char *topicName, int topicLen, MQTTClient_mess
     
     if (message->payloadlen > 0 && message->payload) {
         msg_info = parse_message_payload((char*)message->payload, message->payloadlen);
-        printf("Raw payload (%d bytes): %.*s\n", 
-               message->payloadlen, message->payloadlen, (char*)message->payload);
+        log_debug("Raw payload (%d bytes): %.*s", 
+                  message->payloadlen, message->payloadlen, (char*)message->payload);
     } else {
-        printf("Empty payload received\n");
+        log_debug("Empty payload received");
     }
     
     // 정보 출력
@@ -172,36 +292,40 @@ int messageArrived(void *context, char *topicName, int topicLen, MQTTClient_mess
     
     // prefix에 따라 동작 분기
     if (topic_info.is_valid) {
-        if (strcmp(topic_info.prefix, "control") == 0) {
-            // 각 제어 기기 파일의 함수를 호출하여 토픽의 4번째 필드(명령)를 출력
-            if (strcmp(topic_info.target_device, "led") == 0) {
-                handle_led(topic_info.command);
-            } else if (strcmp(topic_info.target_device, "buzzer") == 0) {
-                handle_buzzer(topic_info.command);
-            } else if (strcmp(topic_info.target_device, "s_segment") == 0) {
-                handle_s_segment(topic_info.command);
-            } else if (strcmp(topic_info.target_device, "photoresistor") == 0) {
-                handle_photoresistor(topic_info.command);
+        if (topic_level_is(topicName, topic_info.prefix, "control")) {
+            // 레지스트리에서 (디바이스, 명령) 핸들러를 찾아 바로 실행
+            const DispatchEntry *entry = dispatch_lookup(&topic_info);
+            if (entry) {
+                char arg[MAX_STRING_LEN];
+                if ((entry->flags & DISPATCH_ARG_PAYLOAD) && message->payloadlen > 0) {
+                    int len = message->payloadlen < (int)sizeof(arg) - 1 ? message->payloadlen : (int)sizeof(arg) - 1;
+                    memcpy(arg, message->payload, len);
+                    arg[len] = '\0';
+                } else {
+                    topic_level_copy(topicName, topic_info.command, arg, sizeof(arg));
+                }
+                entry->handler(arg);
             } else {
-                printf("Unknown control device: %s\n", topic_info.target_device);
+                log_warn("Unknown control device: %.*s", topic_info.target_device.len,
+                         topicName + topic_info.target_device.offset);
             }
         }
-        else if (strcmp(topic_info.prefix, "status") == 0) {
+        else if (topic_level_is(topicName, topic_info.prefix, "status")) {
             // 향후 publisher 동작 구현 예정
-            printf("Info: 'status' prefix received. (Publisher logic can be implemented here)\n");
+            log_info("Info: 'status' prefix received. (Publisher logic can be implemented here)");
         }
     }
     
     return 1; // 성공적으로 처리됨
 }
 
-// 연결 해제 콜백 함수
+// 연결 해제 콜백 함수 (재연결은 리액터 스레드가 백오프로 처리)
 void connectionLost(void *context, char *cause) {
-    printf("\n!!! Connection lost !!!\n");
+    log_error("!!! Connection lost !!!");
     if (cause) {
-        printf("Cause: %s\n", cause);
+        log_error("Cause: %s", cause);
     }
-    printf("Attempting to reconnect...\n");
+    reconnect_connection_lost();
 }
 
 // 리소스 정리 함수
@@ -4,7 +4,7 @@
 int load_config_from_file(MQTTConfig *config, const char *filename) {
     FILE *file = fopen(filename, "r");
     if (file == NULL) {
-        printf("Error: Cannot open config file '%s'\n", filename);
+        log_error("Error: Cannot open config file '%s'", filename);
         return -1;
     }
     
@@ -13,6 +13,28 @@ int load_config_from_file(MQTTConfig *config, const char *filename) {
     
     // 기본값 설정
     memset(config, 0, sizeof(MQTTConfig));
+    strcpy(config->ipc_transport, "shm");
+    strcpy(config->pub_topic_file, "pub_topic.txt");
+    strcpy(config->device_id, DEFAULT_DEVICE_ID);
+    config->ipc_ring_size = IPC_RING_DEFAULT_SIZE;
+    strcpy(config->process_mode, "fork");
+    config->publish_max_inflight = PUBLISH_DEFAULT_MAX_INFLIGHT;
+    config->publish_queue_size = PUBLISH_DEFAULT_QUEUE_SIZE;
+    config->batch_max_delay_ms = BATCH_DEFAULT_MAX_DELAY_MS;
+    config->batch_max_bytes = BATCH_DEFAULT_MAX_BYTES;
+    config->log_level = LOG_LEVEL_INFO;
+    config->use_tls = 1;
+    config->metrics_interval_ms = METRICS_DEFAULT_INTERVAL_MS;
+    config->subscribe_batch_size = SUBSCRIBE_DEFAULT_BATCH_SIZE;
+    config->clean_session = 1;
+    config->reconnect_min_ms = RECONNECT_DEFAULT_MIN_MS;
+    config->reconnect_max_ms = RECONNECT_DEFAULT_MAX_MS;
+    config->telemetry_sample_ms = TELEMETRY_DEFAULT_SAMPLE_MS;
+    config->telemetry_deadband = TELEMETRY_DEFAULT_DEADBAND;
+    config->telemetry_heartbeat_ms = TELEMETRY_DEFAULT_HEARTBEAT_MS;
+    config->sensor_window_samples = SAMPLE_WINDOW_DEFAULT_CAPACITY;
+    config->compress_min_bytes = COMPRESS_DEFAULT_MIN_BYTES;
+    config->compress_level = COMPRESS_DEFAULT_LEVEL;
     
     while (fgets(line, sizeof(line), file)) {
         // 개행 문자 제거
@@ -59,59 +81,336 @@ int load_config_from_file(MQTTConfig *config, const char *filename) {
         } else if (strcmp(key, "topic_file") == 0) {
             strncpy(config->topic_file, value, MAX_STRING_LEN - 1);
             loaded_count++;
+        } else if (strcmp(key, "pub_topic_file") == 0) {
+            strncpy(config->pub_topic_file, value, MAX_STRING_LEN - 1);
+            loaded_count++;
+        } else if (strcmp(key, "device_id") == 0) {
+            strncpy(config->device_id, value, sizeof(config->device_id) - 1);
+            loaded_count++;
+        } else if (strcmp(key, "tls") == 0) {
+            config->use_tls = atoi(value) != 0;
+            loaded_count++;
         } else if (strcmp(key, "qos") == 0) {
             config->qos = atoi(value);
             loaded_count++;
+        } else if (strcmp(key, "subscribe_batch_size") == 0) {
+            // 브로커가 SUBSCRIBE 하나에 담을 수 있는 필터 수를 제한하면 낮춤 (예: AWS IoT는 8)
+            config->subscribe_batch_size = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "clean_session") == 0) {
+            config->clean_session = atoi(value) != 0;
+            loaded_count++;
+        } else if (strcmp(key, "reconnect_min_ms") == 0) {
+            config->reconnect_min_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "reconnect_max_ms") == 0) {
+            config->reconnect_max_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "telemetry_sample_ms") == 0) {
+            config->telemetry_sample_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "telemetry_deadband") == 0) {
+            config->telemetry_deadband = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "telemetry_heartbeat_ms") == 0) {
+            config->telemetry_heartbeat_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "telemetry_min_publish_ms") == 0) {
+            config->telemetry_min_publish_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "sensor_window_samples") == 0) {
+            config->sensor_window_samples = atoi(value);
+            loaded_count++;
         } else if (strcmp(key, "keep_alive_interval") == 0) {
             config->keep_alive_interval = atoi(value);
             loaded_count++;
         } else if (strcmp(key, "timeout") == 0) {
             config->timeout = atoi(value);
             loaded_count++;
+        } else if (strcmp(key, "ipc_transport") == 0) {
+            strncpy(config->ipc_transport, value, sizeof(config->ipc_transport) - 1);
+            loaded_count++;
+        } else if (strcmp(key, "ipc_ring_size") == 0) {
+            config->ipc_ring_size = atol(value);
+            loaded_count++;
+        } else if (strcmp(key, "process_mode") == 0) {
+            strncpy(config->process_mode, value, sizeof(config->process_mode) - 1);
+            loaded_count++;
+        } else if (strcmp(key, "worker_threads") == 0) {
+            config->worker_threads = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "publish_max_inflight") == 0) {
+            config->publish_max_inflight = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "publish_queue_size") == 0) {
+            config->publish_queue_size = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "batch_max_messages") == 0) {
+            config->batch_max_messages = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "batch_max_delay_ms") == 0) {
+            config->batch_max_delay_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "batch_max_bytes") == 0) {
+            config->batch_max_bytes = atol(value);
+            loaded_count++;
+        } else if (strcmp(key, "batch_topic") == 0) {
+            // 여러 줄 허용 (예: batch_topic=status/+/photoresistor/return)
+            if (config->batch_topic_count < MAX_BATCH_FILTERS && validate_topic_format(value)) {
+                strncpy(config->batch_topics[config->batch_topic_count], value, MAX_TOPIC_LEN - 1);
+                config->batch_topic_count++;
+                loaded_count++;
+            } else {
+                log_warn("Warning: batch_topic '%s' ignored", value);
+            }
+        } else if (strcmp(key, "cbor_topic") == 0) {
+            // 여러 줄 허용 (예: cbor_topic=status/+/photoresistor/return)
+            if (config->cbor_topic_count < MAX_CBOR_FILTERS && validate_topic_format(value)) {
+                strncpy(config->cbor_topics[config->cbor_topic_count], value, MAX_TOPIC_LEN - 1);
+                config->cbor_topic_count++;
+                loaded_count++;
+            } else {
+                log_warn("Warning: cbor_topic '%s' ignored", value);
+            }
+        } else if (strcmp(key, "compress_topic") == 0) {
+            // 여러 줄 허용 (예: compress_topic=status/+/photoresistor/return)
+            if (config->compress_topic_count < MAX_COMPRESS_FILTERS && validate_topic_format(value)) {
+                strncpy(config->compress_topics[config->compress_topic_count], value, MAX_TOPIC_LEN - 1);
+                config->compress_topic_count++;
+                loaded_count++;
+            } else {
+                log_warn("Warning: compress_topic '%s' ignored", value);
+            }
+        } else if (strcmp(key, "compress_min_bytes") == 0) {
+            config->compress_min_bytes = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "compress_level") == 0) {
+            config->compress_level = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "log_level") == 0) {
+            // error, warn, info, debug
+            int level = log_level_from_name(value);
+            if (level >= 0) {
+                config->log_level = level;
+                loaded_count++;
+            } else {
+                log_warn("Warning: log_level '%s' ignored", value);
+            }
+        } else if (strcmp(key, "metrics_interval_ms") == 0) {
+            config->metrics_interval_ms = atoi(value);
+            loaded_count++;
+        } else if (strcmp(key, "metrics_topic") == 0) {
+            strncpy(config->metrics_topic, value, sizeof(config->metrics_topic) - 1);
+            loaded_count++;
+        } else if (strcmp(key, "metrics_file") == 0) {
+            strncpy(config->metrics_file, value, sizeof(config->metrics_file) - 1);
+            loaded_count++;
+        } else if (strcmp(key, "device") == 0) {
+            // 여러 줄 허용, 같은 게이트웨이가 맡는 가상 디바이스 ID (예: device=raspberry_002)
+            if (device_table_add(value, 0) >= 0) {
+                loaded_count++;
+            }
+        } else if (strcmp(key, "device_range") == 0) {
+            // 가상 디바이스 여러 개 (예: device_range=sim_:1000 → sim_0000 ... sim_0999)
+            if (device_table_add_range(value) > 0) {
+                loaded_count++;
+            }
+        } else if (strcmp(key, "priority_rule") == 0) {
+            // 여러 줄 허용 (예: priority_rule=buzzer/off:high)
+            if (priority_add_rule(value) == 0) {
+                loaded_count++;
+            }
         }
     }
     
     fclose(file);
-    printf("Loaded %d configuration parameters from '%s'\n", loaded_count, filename);
+    log_info("Loaded %d configuration parameters from '%s'", loaded_count, filename);
     return loaded_count;
 }
 
-// 토픽 파일에서 토픽 목록 읽어오기
+// 토픽 문자열 저장소 블록 (토픽은 블록 안에 널 종료로 이어 붙이고 블록은 옮기지 않음)
+struct TopicChunk {
+    TopicChunk *next;
+    size_t used;
+    char data[TOPIC_CHUNK_SIZE];
+};
+
+static uint32_t topic_hash(const char *topic, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)topic[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 중복 확인용 해시를 size 칸으로 다시 만듦
+static int topic_list_rehash(TopicList *topic_list, uint32_t size) {
+    uint32_t *index = calloc(size, sizeof(uint32_t));
+    if (!index) {
+        return -1;
+    }
+    for (int i = 0; i < topic_list->count; i++) {
+        const char *topic = topic_list->topics[i];
+        uint32_t slot = topic_hash(topic, strlen(topic)) & (size - 1);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (size - 1);
+        }
+        index[slot] = (uint32_t)i + 1;
+    }
+    free(topic_list->index);
+    topic_list->index = index;
+    topic_list->index_mask = size - 1;
+    return 0;
+}
+
+// 빈 토픽 목록으로 초기화 (메모리는 첫 topic_list_add 때 할당)
+int topic_list_init(TopicList *topic_list) {
+    memset(topic_list, 0, sizeof(TopicList));
+    return 0;
+}
+
+void topic_list_free(TopicList *topic_list) {
+    TopicChunk *chunk = topic_list->chunks;
+    while (chunk) {
+        TopicChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(topic_list->topics);
+    free(topic_list->qos);
+    free(topic_list->index);
+    memset(topic_list, 0, sizeof(TopicList));
+}
+
+// 토픽 추가 (이미 있으면 새로 저장하지 않고 QoS만 갱신)
+// 반환: 토픽 번호, 실패 시 -1
+int topic_list_add(TopicList *topic_list, const char *topic, int qos) {
+    size_t len = strlen(topic);
+    if (len == 0 || len >= MAX_TOPIC_LEN) {
+        return -1;
+    }
+
+    uint32_t hash = topic_hash(topic, len);
+    if (topic_list->index) {
+        uint32_t slot = hash & topic_list->index_mask;
+        while (topic_list->index[slot] != 0) {
+            int i = (int)topic_list->index[slot] - 1;
+            if (strcmp(topic_list->topics[i], topic) == 0) {
+                if (qos >= 0) {
+                    topic_list->qos[i] = qos;
+                }
+                return i;
+            }
+            slot = (slot + 1) & topic_list->index_mask;
+        }
+    }
+
+    if (topic_list->count == topic_list->capacity) {
+        int capacity = topic_list->capacity ? topic_list->capacity * 2 : 16;
+        char **topics = realloc(topic_list->topics, (size_t)capacity * sizeof(char *));
+        if (!topics) {
+            return -1;
+        }
+        topic_list->topics = topics;
+        int *qos_list = realloc(topic_list->qos, (size_t)capacity * sizeof(int));
+        if (!qos_list) {
+            return -1;
+        }
+        topic_list->qos = qos_list;
+        topic_list->capacity = capacity;
+    }
+    // 해시 적재율 1/2 이하 유지
+    if ((uint32_t)(topic_list->count + 1) * 2 > topic_list->index_mask + 1 &&
+        topic_list_rehash(topic_list, (uint32_t)topic_list->capacity * 2) != 0) {
+        return -1;
+    }
+
+    TopicChunk *chunk = topic_list->chunks;
+    if (!chunk || chunk->used + len + 1 > TOPIC_CHUNK_SIZE) {
+        chunk = malloc(sizeof(TopicChunk));
+        if (!chunk) {
+            return -1;
+        }
+        chunk->next = topic_list->chunks;
+        chunk->used = 0;
+        topic_list->chunks = chunk;
+    }
+    char *stored = chunk->data + chunk->used;
+    memcpy(stored, topic, len + 1);
+    chunk->used += len + 1;
+
+    int i = topic_list->count++;
+    topic_list->topics[i] = stored;
+    topic_list->qos[i] = qos;
+
+    uint32_t slot = hash & topic_list->index_mask;
+    while (topic_list->index[slot] != 0) {
+        slot = (slot + 1) & topic_list->index_mask;
+    }
+    topic_list->index[slot] = (uint32_t)i + 1;
+    return i;
+}
+
+// 토픽 파일에서 토픽 목록 읽어오기 (topic_list는 새로 초기화, 다 쓰면 topic_list_free)
+// 한 줄에 토픽 하나, 뒤에 공백과 0~2를 붙이면 그 토픽만 다른 QoS로 구독 (예: "control/+/led/+ 1")
 int load_topics_from_file(TopicList *topic_list, const char *filename) {
+    topic_list_init(topic_list);
+
     FILE *file = fopen(filename, "r");
     if (file == NULL) {
-        printf("Error: Cannot open topic file '%s'\n", filename);
+        log_error("Error: Cannot open topic file '%s'", filename);
         return -1;
     }
     
-    topic_list->count = 0;
-    char line[MAX_TOPIC_LEN];
+    char line[MAX_TOPIC_LEN + 16];
     
-    while (fgets(line, sizeof(line), file) && topic_list->count < MAX_TOPICS) {
+    while (fgets(line, sizeof(line), file)) {
+        // 버퍼보다 긴 줄은 나머지를 버리고 건너뛰기 (잘린 토픽을 구독하지 않도록)
+        size_t len = strcspn(line, "\n");
+        if (line[len] != '\n' && !feof(file)) {
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n') {
+            }
+            log_warn("Warning: Topic line too long, skipped: %.32s...", line);
+            continue;
+        }
         // 개행 문자 제거
-        line[strcspn(line, "\n")] = '\0';
+        line[len] = '\0';
         
         // 빈 줄이나 #으로 시작하는 주석 줄 건너뛰기
-        if (strlen(line) == 0 || line[0] == '#') {
+        if (len == 0 || line[0] == '#') {
             continue;
         }
         
+        // 줄 끝의 QoS 지정
+        int qos = -1;
+        if (len > 2 && line[len - 1] >= '0' && line[len - 1] <= '2' &&
+            (line[len - 2] == ' ' || line[len - 2] == '\t')) {
+            qos = line[len - 1] - '0';
+            len -= 2;
+            while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t')) {
+                len--;
+            }
+            line[len] = '\0';
+        }
+        
         // 토픽 유효성 검사
         if (!validate_topic_format(line)) {
-            printf("Warning: Invalid topic format skipped: %s\n", line);
+            log_warn("Warning: Invalid topic format skipped: %s", line);
             continue;
         }
         
-        // 토픽 복사
-        strncpy(topic_list->topics[topic_list->count], line, MAX_TOPIC_LEN - 1);
-        topic_list->topics[topic_list->count][MAX_TOPIC_LEN - 1] = '\0';
-        topic_list->count++;
+        if (topic_list_add(topic_list, line, qos) < 0) {
+            log_error("Error: Out of memory while loading topics");
+            break;
+        }
         
-        printf("Loaded topic: %s\n", line);
+        log_debug("Loaded topic: %s", line);
     }
     
     fclose(file);
-    printf("Total %d topics loaded from file\n", topic_list->count);
+    log_info("Total %d topics loaded from file", topic_list->count);
     return topic_list->count;
 }
 
@@ -165,33 +464,115 @@ int validate_topic_format(const char *topic) {
     return 1; // 유효한 토픽
 }
 
+// 토픽이 MQTT 토픽 필터(+, # 와일드카드)와 일치하는지 검사
+int topic_matches_filter(const char *filter, const char *topic) {
+    while (*filter && *topic) {
+        if (*filter == '#') {
+            return 1;
+        }
+        if (*filter == '+') {
+            // 한 레벨 전체와 일치
+            while (*topic && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+        if (*filter != *topic) {
+            return 0;
+        }
+        filter++;
+        topic++;
+    }
+    // "a/#" 는 "a" 와도 일치
+    if (*topic == '\0' && (strcmp(filter, "/#") == 0 || strcmp(filter, "#") == 0)) {
+        return 1;
+    }
+    return *filter == '\0' && *topic == '\0';
+}
+
 // 여러 토픽 구독 함수
-int subscribe_to_topics(MQTTClient client, TopicList *topic_list, int qos) {
+// batch_size개씩 MQTTClient_subscribeMany로 묶어 SUBSCRIBE 한 번(SUBACK 한 번)에 보냄
+// 토픽별 QoS가 없으면 qos 사용, 반환: 브로커가 수락한 토픽 수
+int subscribe_to_topics(MQTTClient client, const TopicList *topic_list, int qos, int batch_size) {
     int success_count = 0;
+    int request_count = 0;
+    uint64_t start_ns = monotonic_time_ns();
     
-    for (int i = 0; i < topic_list->count; i++) {
-        int rc = MQTTClient_subscribe(client, topic_list->topics[i], qos);
+    if (topic_list->count == 0) {
+        return 0;
+    }
+    if (batch_size <= 0) {
+        batch_size = SUBSCRIBE_DEFAULT_BATCH_SIZE;
+    }
+    if (batch_size > topic_list->count) {
+        batch_size = topic_list->count;
+    }
+    
+    // subscribeMany가 요청 QoS 자리에 허용된 QoS를 돌려주므로 복사본을 넘김
+    int *granted = malloc((size_t)batch_size * sizeof(int));
+    if (!granted) {
+        log_error("Failed to allocate subscription buffer");
+        return 0;
+    }
+    
+    for (int start = 0; start < topic_list->count; start += batch_size) {
+        int n = topic_list->count - start < batch_size ? topic_list->count - start : batch_size;
+        for (int i = 0; i < n; i++) {
+            granted[i] = topic_list->qos[start + i] >= 0 ? topic_list->qos[start + i] : qos;
+        }
+        
+        int rc = MQTTClient_subscribeMany(client, n, topic_list->topics + start, granted);
+        request_count++;
         if (rc != MQTTCLIENT_SUCCESS) {
-            printf("Failed to subscribe to topic '%s', return code %d\n", 
-                   topic_list->topics[i], rc);
-        } else {
-            printf("Successfully subscribed to topic: %s\n", topic_list->topics[i]);
-            success_count++;
+            log_error("Failed to subscribe to %d topics starting at '%s', return code %d",
+                      n, topic_list->topics[start], rc);
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            if (granted[i] == MQTT_BAD_SUBSCRIBE) {
+                log_error("Broker rejected subscription to topic '%s'", topic_list->topics[start + i]);
+            } else {
+                log_debug("Subscribed to topic: %s (QoS %d)", topic_list->topics[start + i], granted[i]);
+                success_count++;
+            }
         }
     }
+    free(granted);
     
+    log_info("Subscribed to %d of %d topics in %d request(s), %.1f ms", success_count, topic_list->count,
+             request_count, (double)(monotonic_time_ns() - start_ns) / 1e6);
     return success_count;
 }
 
 // 설정 정보 출력
 void print_config(const MQTTConfig *config) {
     printf("\n=== MQTT Configuration ===\n");
-    printf("Endpoint: %s:%d\n", config->endpoint, config->port);
+    printf("Endpoint: %s:%d%s\n", config->endpoint, config->port, config->use_tls ? "" : " (TLS disabled)");
     printf("Client ID: %s\n", config->client_id);
     printf("Topic File: %s\n", config->topic_file);
-    printf("QoS: %d\n", config->qos);
+    printf("Device ID: %s (status topics: %s)\n", config->device_id, config->pub_topic_file);
+    printf("QoS: %d (subscribe batch %d)\n", config->qos, config->subscribe_batch_size);
     printf("Keep Alive: %d seconds\n", config->keep_alive_interval);
+    printf("Session: %s, reconnect backoff %d..%d ms\n", config->clean_session ? "clean" : "persistent",
+           config->reconnect_min_ms, config->reconnect_max_ms);
+    printf("Telemetry: sample %d ms, deadband %d, heartbeat %d ms, min publish %d ms\n",
+           config->telemetry_sample_ms, config->telemetry_deadband, config->telemetry_heartbeat_ms,
+           config->telemetry_min_publish_ms);
+    printf("Sensor Window: %d samples per sensor\n", config->sensor_window_samples);
     printf("Timeout: %d ms\n", config->timeout);
+    printf("Process Mode: %s\n", config->process_mode);
+    printf("Workers: %d%s\n", config->worker_threads, config->worker_threads > 0 ? "" : " (one per CPU)");
+    printf("Publish Window: %d in-flight, queue %d\n", config->publish_max_inflight, config->publish_queue_size);
+    printf("Batching: %d topic filter(s), %d messages / %d ms / %ld bytes\n", config->batch_topic_count,
+           config->batch_max_messages, config->batch_max_delay_ms, config->batch_max_bytes);
+    printf("CBOR Results: %d topic filter(s) (plus any command sent as CBOR)\n", config->cbor_topic_count);
+    printf("Compression: %d topic filter(s), gzip level %d for %d bytes and up\n", config->compress_topic_count,
+           config->compress_level, config->compress_min_bytes);
+    printf("IPC Transport: %s (ring %ld bytes)\n", config->ipc_transport, config->ipc_ring_size);
+    printf("Log Level: %d (compiled up to %d)\n", config->log_level, LOG_COMPILE_LEVEL);
+    printf("Metrics: every %d ms to %s%s%s\n", config->metrics_interval_ms,
+           config->metrics_topic[0] ? config->metrics_topic : "metrics/<client_id>",
+           config->metrics_file[0] ? ", file " : "", config->metrics_file);
+    print_priority_rules();
     printf("Certificates:\n");
     printf("  - Root CA: %s\n", config->root_ca_file);
     printf("  - Client Cert: %s\n", config->cert_file);
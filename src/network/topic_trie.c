@@ -0,0 +1,374 @@
+#include "../mqtt.h"
+
+// MQTT 토픽 필터 트라이 (+, # 와일드카드)
+// 필터를 단계별 노드로 저장하고, 들어온 토픽을 한 번 훑으며 일치하는 필터의 처리기를 찾음
+// 일반 단계의 자식은 (부모 노드, 단계 문자열) 키 하나의 해시 테이블에 모아 두어
+// 필터가 수만 개여도 단계마다 상수 시간에 내려감. + 와 # 자식은 노드에 직접 둠
+
+#define TRIE_INITIAL_NODES 64
+#define TRIE_INITIAL_EDGES 64       // 2의 거듭제곱
+#define TRIE_INITIAL_LEVELS 1024
+
+typedef struct {
+    int32_t plus;               // '+' 자식 (0이면 없음, 루트는 자식이 될 수 없으므로 0을 빈 값으로 사용)
+    int32_t hash;               // '#' 자식
+    int32_t route;              // 이 노드에서 끝나는 필터의 routes 인덱스 (-1이면 없음)
+} TrieNode;
+
+typedef struct {
+    uint64_t key_hash;
+    int32_t parent;
+    int32_t child;              // 0이면 빈 칸
+    uint32_t level_offset;      // levels 저장소 안의 위치
+    uint32_t level_len;
+} TrieEdge;
+
+struct TopicTrie {
+    TrieNode *nodes;
+    int node_count;
+    int node_capacity;
+
+    TrieEdge *edges;            // 선형 탐사 해시 테이블
+    uint32_t edge_mask;
+    int edge_count;
+
+    char *levels;               // 단계 문자열 저장소 (간선이 오프셋으로 가리킴)
+    size_t levels_used;
+    size_t levels_capacity;
+
+    TopicRoute *routes;
+    int route_count;            // 사용한 칸 수 (제거된 칸 포함)
+    int live_routes;
+    int route_capacity;
+};
+
+// 매칭 중 결과 수집 상태
+typedef struct {
+    const TopicTrie *trie;
+    const TopicRoute **routes;
+    int max_routes;
+    int matched;
+} TrieMatch;
+
+static uint64_t trie_edge_hash(int32_t parent, const char *level, size_t len) {
+    uint64_t h = 14695981039346656037ULL ^ ((uint64_t)(uint32_t)parent * 0x9E3779B97F4A7C15ULL);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)level[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 29;
+    return h;
+}
+
+static int32_t trie_new_node(TopicTrie *trie) {
+    if (trie->node_count == trie->node_capacity) {
+        int capacity = trie->node_capacity * 2;
+        TrieNode *nodes = realloc(trie->nodes, (size_t)capacity * sizeof(TrieNode));
+        if (!nodes) {
+            return -1;
+        }
+        trie->nodes = nodes;
+        trie->node_capacity = capacity;
+    }
+    TrieNode *node = &trie->nodes[trie->node_count];
+    node->plus = 0;
+    node->hash = 0;
+    node->route = -1;
+    return trie->node_count++;
+}
+
+// 간선 테이블 두 배로 늘려 다시 배치
+static int trie_grow_edges(TopicTrie *trie) {
+    uint32_t capacity = (trie->edge_mask + 1) * 2;
+    TrieEdge *edges = calloc(capacity, sizeof(TrieEdge));
+    if (!edges) {
+        return -1;
+    }
+    for (uint32_t i = 0; i <= trie->edge_mask; i++) {
+        TrieEdge *edge = &trie->edges[i];
+        if (edge->child == 0) {
+            continue;
+        }
+        uint32_t slot = (uint32_t)edge->key_hash & (capacity - 1);
+        while (edges[slot].child != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        edges[slot] = *edge;
+    }
+    free(trie->edges);
+    trie->edges = edges;
+    trie->edge_mask = capacity - 1;
+    return 0;
+}
+
+// 일반 단계 자식 조회 (없으면 0)
+static int32_t trie_find_child(const TopicTrie *trie, int32_t parent, const char *level, size_t len) {
+    uint64_t key_hash = trie_edge_hash(parent, level, len);
+    uint32_t slot = (uint32_t)key_hash & trie->edge_mask;
+    for (;;) {
+        const TrieEdge *edge = &trie->edges[slot];
+        if (edge->child == 0) {
+            return 0;
+        }
+        if (edge->key_hash == key_hash && edge->parent == parent && edge->level_len == len &&
+            memcmp(trie->levels + edge->level_offset, level, len) == 0) {
+            return edge->child;
+        }
+        slot = (slot + 1) & trie->edge_mask;
+    }
+}
+
+// 일반 단계 자식 조회, 없으면 만듦 (실패 시 -1)
+static int32_t trie_add_child(TopicTrie *trie, int32_t parent, const char *level, size_t len) {
+    int32_t child = trie_find_child(trie, parent, level, len);
+    if (child != 0) {
+        return child;
+    }
+
+    // 적재율 1/2 이하 유지
+    if ((uint32_t)(trie->edge_count + 1) * 2 > trie->edge_mask + 1 && trie_grow_edges(trie) != 0) {
+        return -1;
+    }
+    if (trie->levels_used + len > trie->levels_capacity) {
+        size_t capacity = trie->levels_capacity * 2;
+        while (capacity < trie->levels_used + len) {
+            capacity *= 2;
+        }
+        char *levels = realloc(trie->levels, capacity);
+        if (!levels) {
+            return -1;
+        }
+        trie->levels = levels;
+        trie->levels_capacity = capacity;
+    }
+    child = trie_new_node(trie);
+    if (child < 0) {
+        return -1;
+    }
+
+    uint64_t key_hash = trie_edge_hash(parent, level, len);
+    uint32_t slot = (uint32_t)key_hash & trie->edge_mask;
+    while (trie->edges[slot].child != 0) {
+        slot = (slot + 1) & trie->edge_mask;
+    }
+    TrieEdge *edge = &trie->edges[slot];
+    edge->key_hash = key_hash;
+    edge->parent = parent;
+    edge->child = child;
+    edge->level_offset = (uint32_t)trie->levels_used;
+    edge->level_len = (uint32_t)len;
+    memcpy(trie->levels + trie->levels_used, level, len);
+    trie->levels_used += len;
+    trie->edge_count++;
+    return child;
+}
+
+// 필터 유효성 검사: 와일드카드는 한 단계 전체여야 하고 #는 마지막 단계에만
+static int trie_valid_filter(const char *filter) {
+    if (!validate_topic_format(filter)) {
+        return 0;
+    }
+    const char *level = filter;
+    for (;;) {
+        const char *end = strchrnul(level, '/');
+        size_t len = (size_t)(end - level);
+        if (memchr(level, '+', len) || memchr(level, '#', len)) {
+            if (len != 1) {
+                return 0;
+            }
+            if (*level == '#' && *end != '\0') {
+                return 0;
+            }
+        }
+        if (*end == '\0') {
+            return 1;
+        }
+        level = end + 1;
+    }
+}
+
+// 필터의 마지막 노드 찾기 (create가 0이면 만들지 않고, 없으면 0 반환 / 실패 시 -1)
+static int32_t trie_walk(TopicTrie *trie, const char *filter, int create) {
+    int32_t node = 0;
+    const char *level = filter;
+    for (;;) {
+        const char *end = strchrnul(level, '/');
+        size_t len = (size_t)(end - level);
+        int32_t next;
+
+        if (len == 1 && (*level == '+' || *level == '#')) {
+            int32_t *slot = *level == '+' ? &trie->nodes[node].plus : &trie->nodes[node].hash;
+            next = *slot;
+            if (next == 0 && create) {
+                next = trie_new_node(trie);
+                if (next < 0) {
+                    return -1;
+                }
+                // trie_new_node가 nodes를 옮겼을 수 있으므로 다시 가리킴
+                slot = *level == '+' ? &trie->nodes[node].plus : &trie->nodes[node].hash;
+                *slot = next;
+            }
+        } else {
+            next = create ? trie_add_child(trie, node, level, len) : trie_find_child(trie, node, level, len);
+        }
+        if (next <= 0) {
+            return next;
+        }
+        node = next;
+
+        if (*end == '\0') {
+            return node;
+        }
+        level = end + 1;
+    }
+}
+
+// 트라이 생성 (빈 루트 노드 하나)
+TopicTrie *topic_trie_create(void) {
+    TopicTrie *trie = calloc(1, sizeof(TopicTrie));
+    if (!trie) {
+        return NULL;
+    }
+    trie->node_capacity = TRIE_INITIAL_NODES;
+    trie->nodes = malloc((size_t)trie->node_capacity * sizeof(TrieNode));
+    trie->edges = calloc(TRIE_INITIAL_EDGES, sizeof(TrieEdge));
+    trie->edge_mask = TRIE_INITIAL_EDGES - 1;
+    trie->levels_capacity = TRIE_INITIAL_LEVELS;
+    trie->levels = malloc(trie->levels_capacity);
+    if (!trie->nodes || !trie->edges || !trie->levels || trie_new_node(trie) != 0) {
+        topic_trie_destroy(trie);
+        return NULL;
+    }
+    return trie;
+}
+
+void topic_trie_destroy(TopicTrie *trie) {
+    if (!trie) {
+        return;
+    }
+    for (int i = 0; i < trie->route_count; i++) {
+        free(trie->routes[i].filter);
+    }
+    free(trie->routes);
+    free(trie->levels);
+    free(trie->edges);
+    free(trie->nodes);
+    free(trie);
+}
+
+// 필터에 처리기 연결 (같은 필터가 이미 있으면 처리기만 바꿈)
+// 반환: 0 성공, -1 잘못된 필터 또는 메모리 부족
+int topic_trie_insert(TopicTrie *trie, const char *filter, topic_route_t handler, void *context) {
+    if (!trie || !filter || !handler || !trie_valid_filter(filter)) {
+        return -1;
+    }
+
+    int32_t node = trie_walk(trie, filter, 1);
+    if (node <= 0) {
+        return -1;
+    }
+    if (trie->nodes[node].route >= 0) {
+        TopicRoute *route = &trie->routes[trie->nodes[node].route];
+        route->handler = handler;
+        route->context = context;
+        return 0;
+    }
+
+    if (trie->route_count == trie->route_capacity) {
+        int capacity = trie->route_capacity ? trie->route_capacity * 2 : 16;
+        TopicRoute *routes = realloc(trie->routes, (size_t)capacity * sizeof(TopicRoute));
+        if (!routes) {
+            return -1;
+        }
+        trie->routes = routes;
+        trie->route_capacity = capacity;
+    }
+    char *copy = strdup(filter);
+    if (!copy) {
+        return -1;
+    }
+    TopicRoute *route = &trie->routes[trie->route_count];
+    route->filter = copy;
+    route->handler = handler;
+    route->context = context;
+    trie->nodes[node].route = trie->route_count++;
+    trie->live_routes++;
+    return 0;
+}
+
+// 필터 연결 해제 (노드는 남겨 두고 처리기만 지움)
+// 반환: 0 성공, -1 등록되지 않은 필터
+int topic_trie_remove(TopicTrie *trie, const char *filter) {
+    if (!trie || !filter || !trie_valid_filter(filter)) {
+        return -1;
+    }
+    int32_t node = trie_walk(trie, filter, 0);
+    if (node <= 0 || trie->nodes[node].route < 0) {
+        return -1;
+    }
+    TopicRoute *route = &trie->routes[trie->nodes[node].route];
+    free(route->filter);
+    route->filter = NULL;
+    route->handler = NULL;
+    route->context = NULL;
+    trie->nodes[node].route = -1;
+    trie->live_routes--;
+    return 0;
+}
+
+// 등록된 필터 수
+int topic_trie_count(const TopicTrie *trie) {
+    return trie ? trie->live_routes : 0;
+}
+
+static void trie_collect(TrieMatch *match, int32_t node) {
+    int32_t index = match->trie->nodes[node].route;
+    if (index < 0) {
+        return;
+    }
+    if (match->matched < match->max_routes) {
+        match->routes[match->matched] = &match->trie->routes[index];
+    }
+    match->matched++;
+}
+
+// level은 남은 토픽의 현재 단계 시작 (NULL이면 토픽을 다 씀)
+// 재귀 깊이는 필터 단계 수를 넘지 않음 (자식이 없으면 더 내려가지 않음)
+static void trie_match_node(TrieMatch *match, int32_t node, const char *level, int wildcards_allowed) {
+    const TrieNode *n = &match->trie->nodes[node];
+
+    if (!level) {
+        trie_collect(match, node);
+        // "a/#"는 부모 단계 "a"와도 일치
+        if (n->hash && wildcards_allowed) {
+            trie_collect(match, n->hash);
+        }
+        return;
+    }
+
+    if (n->hash && wildcards_allowed) {
+        trie_collect(match, n->hash);
+    }
+
+    const char *end = strchrnul(level, '/');
+    const char *next = *end ? end + 1 : NULL;
+    int32_t child = trie_find_child(match->trie, node, level, (size_t)(end - level));
+    if (child) {
+        trie_match_node(match, child, next, 1);
+    }
+    if (n->plus && wildcards_allowed) {
+        trie_match_node(match, n->plus, next, 1);
+    }
+}
+
+// 토픽과 일치하는 필터의 처리기 찾기
+// 최대 max_routes개를 routes에 담고 전체 일치 수를 반환 (routes는 다음 insert 전까지 유효)
+// '$'로 시작하는 토픽은 첫 단계가 와일드카드인 필터와 일치하지 않음 (MQTT 규칙)
+int topic_trie_match(const TopicTrie *trie, const char *topic, const TopicRoute **routes, int max_routes) {
+    if (!trie || !topic) {
+        return 0;
+    }
+    TrieMatch match = { trie, routes, routes ? max_routes : 0, 0 };
+    trie_match_node(&match, 0, topic, topic[0] != '$');
+    return match.matched;
+}